@@ -33,6 +33,7 @@ useModeDefault      = "Trigger"
 frequencyDefault    = "25600 Hz"
 readModeDefault     = "synchroner Lesemodus"
 gRangeDefault       = "8 g"
+unitDefault         = "Counts"
 
 ### TRIGGER CONFIG
 triggerModeDefault  = "relativ"
@@ -84,14 +85,15 @@ odrDict = {
 }
 
 resolutionDict = {
-#   "8-Bit"  : " -res 8",                                           # 8-Bit Resolution not implemented. In case it is needed later, i left it in.
+    "8-Bit"  : " -res 8",                                           # only high bytes are read and sent, values are 256 times smaller
     "16-Bit" : " -res 16",
 }
 
 readModeDict = {
     "synchroner Lesemodus"                      : " -read sync0",
-#   "Synchronous Read (Hardware Interrupt)"     : " -read sync1",   # Not Implemented. In case it is needed later i left it in.
+    "synchroner Lesemodus (Interrupt)"          : " -read sync1",
     "asynchroner Lesemodus"                     : " -read async",
+    "Puffer-Lesemodus"                          : " -read buffer",
 }
 
 gRangeDict = {
@@ -101,6 +103,13 @@ gRangeDict = {
     "16 g"  : " -g 16",
 }
 
+# samples + normalized data are sent as float32 in physical units, thresholds stay in counts
+unitDict = {
+    "Counts"    : "",
+    "g"         : " -unitstream g -unittrig g",
+    "m/s²"      : " -unitstream ms2 -unittrig ms2",
+}
+
 triggerModeDict = {
     "relativ"   : " -trig offset",
     "fest"      : " -trig fixed",
@@ -137,6 +146,7 @@ ODR_INDEX       = 1
 RES_INDEX       = 2
 READ_MODE_INDEX = 3
 GRANGE_INDEX    = 4
+UNIT_INDEX      = 5
 
 # Trigger Config
 TRIG_MODE_INDEX     = 0
@@ -183,7 +193,11 @@ def kx132(initConfig, triggerConfig, outputPathStr, outputNameStr, raspberryPi_I
 
         # need to specify return type of c-function to pointer
         tcp.tcp_single_read.restype         = ndpointer(dtype=ctypes.c_int16, shape=(3,))
+        tcp.tcp_single_read8.restype        = ndpointer(dtype=ctypes.c_int8, shape=(3,))
+        tcp.tcp_single_read_float.restype   = ndpointer(dtype=ctypes.c_float, shape=(3,))
+        tcp.tcp_read_uint8.restype          = ndpointer(dtype=ctypes.c_uint8, shape=(1,))
         tcp.tcp_read_uint32.restype         = ndpointer(dtype=ctypes.c_uint32, shape=(1,))
+        tcp.tcp_read_uint64.restype         = ndpointer(dtype=ctypes.c_uint64, shape=(1,))
 
         # start tcp connection
         tcp.tcp_init(bytes(raspberryPi_IP, 'utf-8'))
@@ -235,8 +249,9 @@ def getInitFlags(initConfig):
     reso            = resolutionDict        [initConfig[RES_INDEX]]
     read            = readModeDict          [initConfig[READ_MODE_INDEX]]
     g               = gRangeDict            [initConfig[GRANGE_INDEX]]
+    unit            = unitDict              [initConfig[UNIT_INDEX]]
 
-    initString = mode + odr + reso + read + g
+    initString = mode + odr + reso + read + g + unit
 
     return initString
 
@@ -328,8 +343,24 @@ def tcp_read_data(modeConfig, outputPath, outputName):
     modeStr    = main.switchModeVar.get()
     odrStr     = main.switchODRVar.get()
     gRangeStr  = main.gRangeVar.get()
+    resStr     = main.switchResolutionVar.get()
+    unitStr    = main.unitVar.get()
+
+    # samples are sent with 8 or 16 bits per axis, normalized data of trigger blocks always as int16 in the same scale
+    # in physical units both are sent as float32
+    if(unitStr != 'Counts'):
+        sampleRead      = tcp.tcp_single_read_float
+        normalizedRead  = tcp.tcp_single_read_float
+    elif(resStr == '8-Bit'):
+        sampleRead      = tcp.tcp_single_read8
+        normalizedRead  = tcp.tcp_single_read
+    else:
+        sampleRead      = tcp.tcp_single_read
+        normalizedRead  = tcp.tcp_single_read
 
     indexStr   = "index"
+    sensorStr  = "sensor"
+    timeStr    = "t [s]"
     xStr       = "x"
     yStr       = "y"
     zStr       = "z"
@@ -348,17 +379,27 @@ def tcp_read_data(modeConfig, outputPath, outputName):
             file.write(f'Modus:             {modeStr}\n')
             file.write(f'Frequenz:          {odrStr}\n')
             file.write(f'Empfindlichkeit:   {gRangeStr}\n')
+            file.write(f'Auflösung:         {resStr}\n')
+            file.write(f'Einheit:           {unitStr}\n')
             file.write('\n')
-            file.write(f'{indexStr:>6},{xStr:>6},{yStr:>6},{zStr:>6}\n')
+            file.write(f'{indexStr:>6},{sensorStr:>6},{timeStr:>12},{xStr:>6},{yStr:>6},{zStr:>6}\n')
 
-            count = 1
+            count       = 1
+            firstStamp  = 0
 
             while(runThreads):
-                arrayOut = tcp.tcp_single_read()
+                sensorId    = int(tcp.tcp_read_uint8()[0])
+                arrayOut    = sampleRead()
+                stamp       = int(tcp.tcp_read_uint64()[0])
                 # print(f'{arrayOut}     #{count}')
 
+                # time relative to first sample, based on timestamps of RaspberryPi (same clock for all sensors)
+                if(count == 1):
+                    firstStamp = stamp
+
                 if(count != 1):
-                    file.write(f'{count:>6},{arrayOut[X_INDEX]:>6},{arrayOut[Y_INDEX]:>6},{arrayOut[Z_INDEX]:>6}\n')
+                    sampleTime = (stamp - firstStamp) / 1e9
+                    file.write(f'{count:>6},{sensorId:>6},{sampleTime:>12.6f},{arrayOut[X_INDEX]:>6},{arrayOut[Y_INDEX]:>6},{arrayOut[Z_INDEX]:>6}\n')
 
                 count += 1
 
@@ -376,7 +417,8 @@ def tcp_read_data(modeConfig, outputPath, outputName):
 
                 normalizedData = []
 
-                arrayOut = tcp.tcp_single_read()
+                sensorId = int(tcp.tcp_read_uint8()[0])
+                arrayOut = normalizedRead()
 
                 if(runThreads):
                     triggerCount += 1
@@ -402,6 +444,10 @@ def tcp_read_data(modeConfig, outputPath, outputName):
                 triggerIndex = tcp.tcp_read_uint32()
                 triggerIndex = int(triggerIndex[0])
 
+                # measured output data rate in mHz, 0 while the measurement is still settling
+                sampleRate = tcp.tcp_read_uint32()
+                sampleRate = int(sampleRate[0]) / 1000
+
 
                 timestamp       = time.time()
                 dateTimeStr     = str(datetime.fromtimestamp(timestamp))
@@ -424,9 +470,12 @@ def tcp_read_data(modeConfig, outputPath, outputName):
                     file.write(f'\n')
                     file.write(dateTimeStr)
                     file.write('\n')
+                    file.write(f'Sensor:                    {sensorId}\n')
                     file.write(f'Modus:                     {modeStr}\n')
                     file.write(f'Frequenz:                  {odrStr}\n')
                     file.write(f'Empfindlichkeit:           {gRangeStr}\n')
+                    file.write(f'Auflösung:                 {resStr}\n')
+                    file.write(f'Einheit:                   {unitStr}\n')
                     file.write('\n')
                     file.write(f'Trigger-Modus:             {trigModeStr}\n')
                     file.write(f'Flankenerkennung:          {edgeDetectStr}\n')
@@ -446,21 +495,33 @@ def tcp_read_data(modeConfig, outputPath, outputName):
                     file.write('\n')
                     file.write(f'Anzahl Samples:    {bufferSize}\n')
                     file.write(f'Trigger bei Index: {triggerIndex}\n')
+                    file.write(f'Gemessene Frequenz (Hz): {sampleRate:.3f}\n')
                     file.write('\n')
                     file.write('\n')
-                    file.write(f'{indexStr:>6},{xStr:>6},{yStr:>6},{zStr:>6}\n')
+                    file.write(f'{indexStr:>6},{timeStr:>12},{xStr:>6},{yStr:>6},{zStr:>6}\n')
+
+                    blockData   = []
+                    stamps      = []
 
                     for i in range (bufferSize):
                         
-                        arrayOut = tcp.tcp_single_read()
+                        tcp.tcp_read_uint8()
+                        arrayOut = sampleRead()
+
+                        blockData.append((arrayOut[X_INDEX], arrayOut[Y_INDEX], arrayOut[Z_INDEX]))
+                        stamps.append(int(tcp.tcp_read_uint64()[0]))
+
+                    # time relative to trigger sample, negative before trigger
+                    triggerStamp = stamps[triggerIndex - 1]
+
+                    for i in range (bufferSize):
 
-                        xData = arrayOut[X_INDEX]
-                        yData = arrayOut[Y_INDEX]
-                        zData = arrayOut[Z_INDEX]
+                        xData, yData, zData = blockData[i]
+                        sampleTime          = (stamps[i] - triggerStamp) / 1e9
 
                         # print(f'#{i:>5}#   {xData:>6},{yData:>6},{zData:>6}')
 
-                        file.write(f'{(i+1):>6},{xData:>6},{yData:>6},{zData:>6}\n')
+                        file.write(f'{(i+1):>6},{sampleTime:>12.6f},{xData:>6},{yData:>6},{zData:>6}\n')
 
                     file.write(f'\n')
                     file.write(f'END_OF_BLOCK_{triggerCount}\n')
@@ -542,18 +603,21 @@ class mainWindow:
         self.switchResolutionVar        = tk.StringVar()
         self.switchReadModeVar          = tk.StringVar()
         self.gRangeVar                  = tk.StringVar()
+        self.unitVar                    = tk.StringVar()
 
         self.switchModeVar.set          (useModeDefault)
         self.switchODRVar.set           (frequencyDefault)
         self.switchResolutionVar.set    ('16-Bit')
         self.switchReadModeVar.set      (readModeDefault)
         self.gRangeVar.set              (gRangeDefault)
+        self.unitVar.set                (unitDefault)
 
         self.switchModeChoices          = list(modeDict.keys())
         self.switchODRChoices           = list(odrDict.keys())
         self.switchResolutionChoices    = list(resolutionDict.keys())
         self.switchReadModeChoices      = list(readModeDict.keys())
         self.gRangeChoices              = list(gRangeDict.keys())
+        self.unitChoices                = list(unitDict.keys())
 
         ##--------------------
         ## TRIGGER CONFIG
@@ -611,12 +675,14 @@ class mainWindow:
         self.ResLabel                   = tk.Label(self.InitFrame, text='Auflösung',                padx=10)
         self.ReadLabel                  = tk.Label(self.InitFrame, text='Lese-Modus',               padx=10)
         self.GLabel                     = tk.Label(self.InitFrame, text='Empfindlichkeit',          padx=10)
+        self.UnitLabel                  = tk.Label(self.InitFrame, text='Einheit',                  padx=10)
         
         self.ModeOpt                    = tk.OptionMenu(self.InitFrame, self.switchModeVar,         *self.switchModeChoices)
         self.OdrOpt                     = tk.OptionMenu(self.InitFrame, self.switchODRVar,          *self.switchODRChoices)
         self.ResOpt                     = tk.OptionMenu(self.InitFrame, self.switchResolutionVar,   *self.switchResolutionChoices)
         self.ReadOpt                    = tk.OptionMenu(self.InitFrame, self.switchReadModeVar,     *self.switchReadModeChoices)
         self.GOpt                       = tk.OptionMenu(self.InitFrame, self.gRangeVar,             *self.gRangeChoices)
+        self.UnitOpt                    = tk.OptionMenu(self.InitFrame, self.unitVar,               *self.unitChoices)
 
         self.InitHeader.grid            (row=0, column=0)
 
@@ -625,12 +691,14 @@ class mainWindow:
         self.ResLabel.grid              (row=1, column=2)   
         self.ReadLabel.grid             (row=1, column=3)  
         self.GLabel.grid                (row=1, column=4)
+        self.UnitLabel.grid             (row=1, column=5)
 
         self.ModeOpt.grid               (row=2, column=0, padx=15)    
         self.OdrOpt.grid                (row=2, column=1, padx=15)     
         self.ResOpt.grid                (row=2, column=2, padx=15)     
         self.ReadOpt.grid               (row=2, column=3, padx=15)    
         self.GOpt.grid                  (row=2, column=4, padx=15)
+        self.UnitOpt.grid               (row=2, column=5, padx=15)
 
 
         ##-----------------------------------------------------------
@@ -877,6 +945,7 @@ class mainWindow:
         self.initConfigList.append(self.switchResolutionVar.get())
         self.initConfigList.append(self.switchReadModeVar.get())
         self.initConfigList.append(self.gRangeVar.get())
+        self.initConfigList.append(self.unitVar.get())
 
     def getTrigConfig(self):
         self.trigConfigList = []
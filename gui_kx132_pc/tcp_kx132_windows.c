@@ -11,7 +11,11 @@
 
 SOCKET      clientSocket;
 int16_t     tcpData [3];
+int8_t      tcpData8 [3];
+float       tcpDataFloat [3];
+uint8_t     tcp_uint8 [1];
 uint32_t    tcp_uint32 [1];
+uint64_t    tcp_uint64 [1];
 
 
 int tcp_init(char* TCP_IP){
@@ -89,8 +93,36 @@ int16_t* tcp_single_read(void){
 }
 
 
+// 8-Bit resolution only sends the high bytes
+int8_t* tcp_single_read8(void){
+    recv(clientSocket, (char*)tcpData8, 3 * sizeof(int8_t), 0);
+    return tcpData8;
+}
+
+
+// samples in g or m/s² (-unitstream / -unittrig)
+float* tcp_single_read_float(void){
+    recv(clientSocket, (char*)tcpDataFloat, 3 * sizeof(float), 0);
+    return tcpDataFloat;
+}
+
+
+// id of sensor, precedes every sample and every trigger block
+uint8_t* tcp_read_uint8(void){
+    recv(clientSocket, (char*)tcp_uint8, sizeof(uint8_t), 0);
+    return tcp_uint8;
+}
+
+
 uint32_t* tcp_read_uint32(void){
     recv(clientSocket, (char*)tcp_uint32, sizeof(uint32_t), 0);
     return tcp_uint32;
 }
 
+
+// timestamp of sample in nanoseconds (CLOCK_MONOTONIC of RaspberryPi), follows every tcp_single_read()
+uint64_t* tcp_read_uint64(void){
+    recv(clientSocket, (char*)tcp_uint64, sizeof(uint64_t), 0);
+    return tcp_uint64;
+}
+
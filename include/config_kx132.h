@@ -20,9 +20,19 @@
 
 ///\cond
 #include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
 ///\endcond
 
 #include <trigger.h>
+#include <gpio_event.h>
+#include <spi_wrapper.h>
+#include <sim_kx132.h>
+#include <rt_thread.h>
+#include <timestamp.h>
+#include <spsc_queue.h>
+#include <ringbuffer.h>
+#include <macros_kx132.h>
 
 
 #define RESO_8_BIT              8
@@ -33,6 +43,8 @@
 #define G_RANGE_HW_8            0x10
 #define G_RANGE_HW_16           0x18
 
+#define STANDARD_GRAVITY        9.80665    ///< m/s² per g
+
 #define BUFFER_SIZE_128_KB      131072     // 2^17
 #define BUFFER_SIZE_256_KB      262144     // 2^18
 #define BUFFER_SIZE_512_KB      524288     // 2^19
@@ -40,6 +52,37 @@
 #define BUFFER_SIZE_2048_KB     2097152    // 2^21
 #define BUFFER_SIZE_4096_KB     4194304    // 2^22
 #define BUFFER_SIZE_8192_KB     8388608    // 2^23
+#define BUFFER_SIZE_MAX         1073741824 ///< 2^30, largest history file ringbuffer
+
+#define HISTORY_PATH_LEN        256
+
+#define PACK_SIZE_MAX_MB        1024       ///< largest compressed history ring
+
+#define KX132_BUF_MAX_SAMPLES   86         ///< capacity of KX132 sample buffer in 16-Bit mode
+#define KX132_BUF_MAX_SAMPLES_8BIT  171    ///< capacity of KX132 sample buffer in 8-Bit mode
+#define KX132_BUF_MAX_BYTES     (KX132_BUF_MAX_SAMPLES * NUMBER_OF_CHANNELS)   ///< raw bytes of a full sample buffer, enough for both resolutions
+#define DEFAULT_BUF_WATERMARK   43         ///< sample threshold of KX132 sample buffer, half of its capacity
+#define RAW_BLOCK_ALIGN         64         ///< raw samples of a block start on a cache line
+
+#define KX132_MAX_SENSORS       4          ///< max number of sensors read at the same time (all chip-selects of two buses)
+
+#define ADP_RMS_AVERAGE_MIN     2          ///< samples averaged by RMS engine of Advanced Data Path
+#define ADP_RMS_AVERAGE_MAX     256
+
+#define WAKE_MG_PER_COUNT       3.9        ///< resolution of wake-up / back-to-sleep thresholds
+#define WAKE_THRESHOLD_MAX      2047       ///< thresholds are 11 Bit counts
+#define WAKE_ODR_MAX            7          ///< OWUF / OBTS 0.781 Hz * 2^n, 7 = 100 Hz
+#define DEFAULT_WAKE_COUNT      1          ///< samples of engine above threshold before waking up
+#define DEFAULT_SLEEP_COUNT     100        ///< samples of engine below threshold before going back to sleep
+#define DEFAULT_ADP_RMS_AVERAGE 16
+
+#define DEFAULT_WAIT_SPIN_US    50         ///< min time sync0 / async start polling before the next sample is due
+#define WAIT_SPIN_MAX_US        10000
+
+#define PIPELINE_BLOCK_SLOTS    1024       ///< blocks queued between acquisition and processing thread, power of two
+#define PIPELINE_BLOCK_NS       2000000    ///< single sample reads are collected in one block at most this long before it is queued
+#define PIPELINE_EVENT_SLOTS    2          ///< trigger events queued for sending, the next one is filled while one is sent
+#define PIPELINE_POLL_NS        500000     ///< processing / sending thread checks its empty queue this often
 
 
 //-------------------------------------------------------------------
@@ -67,7 +110,7 @@ typedef enum{
 } outputDataRate_hw_t;
 
 
-///< enum for hardware config of resolution (not implemented)
+///< enum for hardware config of resolution, 8-Bit only reads and sends the high bytes
 typedef enum{
     resolution_8bit         = RESO_8_BIT,
     resolution_16bit        = RESO_16_BIT,
@@ -77,8 +120,9 @@ typedef enum{
 ///< enum for hardware config of read mode (async/sync)
 typedef enum{
     synchronous_read_0   = 0,                       ///< No Hardware Interrupt. Syncing through SPI. Uses DataReady-Bit in INS2_REG.
-//  synchronous_read_1   = 1,                       ///< Hardware Interrupt. Syncing through INT1-PIN of KX132. //! Not implemented.
+    synchronous_read_1   = 1,                       ///< Hardware Interrupt. Syncing through INT1-PIN of KX132.
     asynchronous_read    = 2,                       ///< Asynchronous Read of Raw Data.
+    buffer_read          = 3,                       ///< Sample Buffer of KX132 is enabled and drained in bursts through BUF_READ.
 } readMode_hw_t;
 
 
@@ -91,6 +135,82 @@ typedef enum{
 } gRange_hw_t;
 
 
+///< enum for hardware config of Advanced Data Path output, read instead of the normal output registers
+typedef enum{
+    adp_output_off          = 0,                    ///< ADP disabled, raw samples are read
+    adp_output_filter       = 1,                    ///< samples after filter-1 / filter-2
+    adp_output_rms          = 2,                    ///< RMS of filtered samples
+} adpOutput_hw_t;
+
+
+/// struct holding coefficients of the 2nd order IIR filter-1 of Advanced Data Path (values from Kionix ADP calculator)
+typedef struct{
+    bool                    enabled;                ///< false bypasses filter-1
+    uint8_t                 a1;                     ///< ADP_F1_1A (7 Bit)
+    uint32_t                ba;                     ///< ADP_F1_BA (23 Bit)
+    uint32_t                ca;                     ///< ADP_F1_CA (23 Bit)
+    uint8_t                 inputShift;             ///< ADP_F1_ISH (5 Bit)
+    bool                    outputShift;            ///< ADP_F1_OSH (1 Bit)
+} adp_filter1_t;
+
+
+/// struct holding coefficients of the 1st order filter-2 of Advanced Data Path (values from Kionix ADP calculator)
+typedef struct{
+    bool                    enabled;                ///< false bypasses filter-2
+    uint8_t                 a1;                     ///< ADP_F2_1A (7 Bit)
+    uint16_t                ba;                     ///< ADP_F2_BA (15 Bit)
+    uint8_t                 inputShift;             ///< ADP_F2_ISH (5 Bit)
+    uint8_t                 outputShift;            ///< ADP_F2_OSH (5 Bit)
+} adp_filter2_t;
+
+
+/// struct holding configuration of the Advanced Data Path (on-chip filter chain + RMS engine)
+typedef struct{
+    adpOutput_hw_t          output;                 ///< source of samples for streaming / triggering
+    outputDataRate_hw_t     outputDataRate;         ///< OADP, limited to the output data rate, lower rates only in buffer_read
+    uint16_t                rmsAverage;             ///< samples averaged for RMS (ADP_RMS_AVERAGE_MIN - ADP_RMS_AVERAGE_MAX, power of two)
+    adp_filter1_t           filter1;
+    adp_filter2_t           filter2;
+} adp_config_t;
+
+
+/// struct holding configuration of the wake-up / back-to-sleep engine, used as pre-trigger so the host idles while the sensor is quiet
+typedef struct{
+    bool                    enabled;                ///< only trigger mode with buffer_read, sample buffer holds the pre-trigger history
+    uint16_t                wakeThreshold;          ///< WUFTH, counts of WAKE_MG_PER_COUNT relative to last sample of engine
+    uint16_t                sleepThreshold;         ///< BTSTH, counts of WAKE_MG_PER_COUNT relative to last sample of engine
+    uint8_t                 wakeCount;              ///< WUFC, samples of engine above wake threshold before waking up
+    uint8_t                 sleepCount;             ///< BTSC, samples of engine below sleep threshold before going back to sleep
+    uint8_t                 outputDataRate;         ///< OWUF / OBTS (0 - WAKE_ODR_MAX)
+} wake_config_t;
+
+
+/// struct holding configuration of waiting for the next sample, only sync0 / async poll for Data-Ready
+typedef struct{
+    bool                    hybrid;                 ///< sleep until shortly before the next sample is due, busy polling otherwise
+    uint32_t                spinUs;                 ///< min time polled before the sample is due, grows if the sample was already waiting
+} wait_config_t;
+
+
+///< enum for software config of the unit of samples sent
+typedef enum{
+    unit_counts             = 0,                    ///< raw counts, scale depends on g-range and resolution
+    unit_g                  = 1,                    ///< float
+    unit_ms2                = 2,                    ///< float, m/s²
+} outputUnit_t;
+
+
+/// struct holding the units of the outputs and the thresholds given in physical units
+typedef struct{
+    outputUnit_t            stream;                 ///< unit of streamed samples
+    outputUnit_t            trigger;                ///< unit of samples + normalized data of trigger blocks
+    float                   streamScale;            ///< unit per 16-Bit count, set after parsing ("-g" may come later)
+    float                   triggerScale;           ///< unit per 16-Bit count, set after parsing
+    float                   offsetThresholdG    [NUMBER_OF_AXES];   ///< offset thresholds given in g or m/s², NAN if given in counts
+    float                   fixedThresholdG     [NUMBER_OF_AXES];   ///< fixed thresholds given in g or m/s², NAN if given in counts
+} unit_config_t;
+
+
 ///< enum for software config of use mode (streaming/trigger)
 typedef enum{
     streaming_mode          = 0,
@@ -101,11 +221,26 @@ typedef enum{
 /// struct holding configuration used for initializing KX132 and software configuration during runtime
 typedef struct{
     outputDataRate_hw_t     outputDataRate_hw;      ///< frequency-setting for KX132 (Range: 0x0 - 0xF)
-    resolution_hw_t         resolution_hw;          ///< resolution of KX132 output (8-Bit/16-Bit) //! Not implemented.
+    resolution_hw_t         resolution_hw;          ///< resolution of KX132 output (8-Bit/16-Bit)
     readMode_hw_t           readMode_hw;            ///< depending on config turns "Data Ready Engine" on or off
     gRange_hw_t             gRange_hw;              ///< sensitivity of KX132 (higher g >> lower sensitivity)
     useMode_t               useMode;                ///< streaming / trigger
     uint32_t                bufferSize;             ///< buffersize for allocating memory of ringbuffer
+    rb_layout_t             bufferLayout;           ///< storage of the axes in the ringbuffer, one array per axis, interleaved blocks or mirrored arrays
+    char                    historyPath[HISTORY_PATH_LEN];  ///< ringbuffer kept in this memory-mapped file instead of RAM, empty for none
+    float                   historyMinutes;         ///< pre-trigger history sizing the ringbuffer, 0 keeps bufferSize
+    bool                    envelope;               ///< min / max / mean / RMS of 16, 256 and 4096 samples kept beside the ringbuffer
+    uint32_t                packSize;               ///< bytes of compressed history kept beside the ringbuffer, power of two, 0 for none
+    uint8_t                 bufferWatermark;        ///< sample threshold of KX132 sample buffer, only used for buffer_read (Range: 1 - KX132_BUF_MAX_SAMPLES(_8BIT))
+    gpio_config_t           int1Config;             ///< GPIO connected to INT1, used by sync1 and optionally by buffer_read
+    spi_config_t            spiConfig;              ///< SPI backend, device and clock
+    sim_kx132_config_t      simConfig;              ///< signal and time scale of simulated KX132, only used for spi_backend_sim
+    rt_config_t             rtConfig;               ///< scheduling, CPU and memory locking of acquisition thread
+    adp_config_t            adpConfig;              ///< on-chip filtering / RMS, data source of streaming and triggering
+    wake_config_t           wakeConfig;             ///< hardware pre-trigger, host idles until motion is detected
+    bool                    bufferTrigger;          ///< sample buffer in trigger mode keeps the pre-trigger history on the sensor, only buffer_read
+    wait_config_t           waitConfig;             ///< sleeping / spinning between polls of sync0 / async
+    unit_config_t           unitConfig;             ///< counts or physical units per output, thresholds in physical units
 } main_config_t;
 
 
@@ -117,6 +252,112 @@ typedef struct{
 } kx132_config_t;
 
 
+/// struct holding one block of raw samples, SPI frames are received straight into it
+typedef struct{
+    uint8_t                 headroom    [RAW_BLOCK_ALIGN - 1];
+    uint8_t                 frame;                                  ///< address byte of SPI frame, read bytes follow in data
+    uint8_t                 data        [KX132_BUF_MAX_BYTES];      ///< raw samples, bytesPerSample each
+} __attribute__((aligned(RAW_BLOCK_ALIGN))) kx132_raw_block_t;
+
+
+/// struct holding one block of samples queued by the acquisition thread for the processing thread
+typedef struct{
+    kx132_raw_block_t       rawBlock;
+    uint64_t                timestamps  [KX132_BUF_MAX_SAMPLES_8BIT];
+    uint16_t                numberOfSamples;
+    double                  sampleRateHz;                           ///< measured output data rate, 0 until the timestamp estimator is locked
+    bool                    restart;                                ///< thresholds were normalized again before this block, a running capture is discarded
+} kx132_block_t;
+
+
+///< enum for events queued for the sending thread
+typedef enum{
+    kx132_event_trigger     = 0,    ///< window of a trigger event in the ringbuffers
+    kx132_event_envelope    = 1,    ///< envelopes requested by client
+} kx132_event_type_t;
+
+
+/// struct holding one trigger event queued for the sending thread, the window stays in the ringbuffers until the event is sent
+typedef struct{
+    kx132_event_type_t      type;
+    uint32_t                envelopeSeconds;                        ///< history requested by client, only kx132_event_envelope
+    ringbuffer_xyz_t*       xyzRingbuffer;                          ///< ringbuffer of the axes holding the window
+    ringbuffer_ts_t*        timestampRingbuffer;                    ///< ringbuffer of timestamps pushed in step
+    rb_view_t               view;                                   ///< window, released by the sending thread
+    rb_pack_t*              pack;                                   ///< compressed ring holding the older part of the window, NULL without "-pack"
+    rb_pack_view_t          packView;                               ///< older part of the window, released by the sending thread, only used with pack
+    trigger_info_t          triggerInfo;                            ///< copy, runtime config may change the original while sending
+    int16_t                 normalizedData  [NUMBER_OF_AXES];
+} kx132_event_t;
+
+
+/// struct holding counters of samples read, discarded and lost since start of reading loop
+typedef struct{
+    uint64_t                samplesRead;            ///< samples returned by kx132_read_raw_samples()
+    uint64_t                duplicatesDiscarded;    ///< async reads without a new sample counted by the sample buffer
+    uint64_t                samplesLost;            ///< samples produced by KX132 but never read
+    uint64_t                lossEvents;             ///< reads with samples lost right before them
+    uint64_t                longestGapNs;           ///< longest time between two consecutive samples read
+    uint64_t                wakeUps;                ///< times the wake-up engine ended an idle period
+    uint64_t                idleNs;                 ///< time spent waiting for wake-up
+    uint64_t                pollsWasted;            ///< sync0 / async reads without a new sample
+    uint64_t                sleepNs;                ///< time slept by hybrid wait before polling
+    uint64_t                samplesDropped;         ///< samples read while the queue to the processing thread was full
+    uint64_t                eventsDropped;          ///< trigger events discarded while all event slots were being sent
+    uint64_t                guardStalls;            ///< times trigger evaluation waited for the sending thread to release a window
+    uint64_t                guardStallNs;           ///< time trigger evaluation waited for released windows
+    uint64_t                longestGuardStallNs;    ///< longest of these waits
+    uint32_t                maxBlocksQueued;        ///< most blocks waiting for the processing thread at once
+} sample_stats_t;
+
+
+/// struct holding config and reading state of one KX132, every sensor is read by its own thread
+typedef struct{
+    uint8_t                 id;                     ///< index of sensor, sent with every sample / trigger buffer
+    kx132_config_t*         config;
+    spi_device_t            spiDevice;              ///< bus and chip-select of sensor
+    gpio_event_t            int1Event;              ///< GPIO connected to INT1 of sensor
+    rt_jitter_t             jitter;                 ///< loop period of reading thread
+    ts_estimator_t          timestampEstimator;     ///< tracks real output data rate, timestamps every sample read
+
+    sample_stats_t          sampleStats;            ///< read / duplicate / lost samples, queried at runtime
+    pthread_mutex_t         sampleStatsMutex;
+    bool                    sampleStatsStarted;     ///< false until first read after reset, time before reset is no gap
+    bool                    bufferOverflow;         ///< sample buffer was full at last read, older samples overwritten
+
+    uint8_t                 bufferWatermark;        ///< needed for draining the sample buffer
+    uint16_t                bufferCapacity;         ///< samples fitting into sample buffer at configured resolution
+    uint8_t                 bytesPerSample;         ///< raw bytes of one sample, NUMBER_OF_CHANNELS or NUMBER_OF_CHANNELS_8BIT
+    double                  samplePeriodUs;         ///< time between two samples based on output data rate
+    bool                    int1Enabled;            ///< reading thread waits on INT1 instead of polling
+    uint32_t                int1TimeoutUs;          ///< timeout for waiting on INT1, recovers from missed edges
+    outputDataRate_hw_t     outputDataRate;         ///< output data rate of samples read (OADP, if Advanced Data Path is enabled)
+    kx132_reg_t             outputRegister;         ///< first output register read by sync0 / sync1 / async (XOUT_L or XADP_L)
+    bool                    adpUpdate;              ///< Advanced Data Path was changed at runtime, applied by reading thread
+    bool                    eventInt1;              ///< INT1 signals wake-up / full trigger buffer instead of watermark
+    bool                    bufferTrigger;          ///< sample buffer is armed in trigger mode, the sensor freezes it on a trigger event
+    uint64_t                idleSinceNs;            ///< start of current idle period of wake-up engine
+    uint64_t                waitSpinNs;             ///< polling starts this long before the next sample is due, adapted by hybrid wait
+    uint32_t                waitPolls;              ///< reads without a new sample since the last one
+
+    spsc_queue_t            blockQueue;             ///< kx132_block_t from acquisition thread to processing thread
+    spsc_queue_t            eventQueue;             ///< kx132_event_t from trigger evaluation to sending thread
+    atomic_bool             capturing;              ///< trigger evaluation collects samples after a trigger, wake-up engine stays awake
+    atomic_uint_fast32_t    envelopeRequest;        ///< seconds of envelopes requested by client, 0 if none, queued by trigger evaluation
+    rb_pyramid_t*           pyramid;                ///< envelopes of trigger mode, NULL without "-envelope"
+
+    spi_batch_t             sync0Batch;             ///< INS2 + output registers in one transaction
+    spi_batch_t             sync1Batch;             ///< output registers + INT_REL in one transaction
+    spi_batch_t             bufferBatch;            ///< BUF_READ + INT_REL in one transaction
+    spi_batch_t             asyncBatch;             ///< BUF_STATUS + output registers in one transaction
+    uint8_t                 batchStatus;            ///< INS2 / INT_REL read through batch
+    uint8_t                 batchRelease;           ///< INT_REL read after INS2 through batch, value unused
+    uint16_t                asyncLevelBytes;        ///< sample level seen by the last async read, the sample buffer only counts samples
+    uint8_t                 batchBufferStatus [2];  ///< BUF_STATUS1 + BUF_STATUS2 read through batch
+    uint8_t                 batchRawData    [NUMBER_OF_CHANNELS];   ///< output registers read through batch
+} kx132_sensor_t;
+
+
 
 //-------------------------------------------------------------------
 //--- Function Declarations  ----------------------------------------
@@ -125,11 +366,17 @@ typedef struct{
 /**
  * @brief Initialiazes all settings corresponding to user input or default values. 
  * 
+ *  Every "-sensor <bus>.<cs>" starts the flags of another sensor. Flags before the first
+ *  "-sensor" apply to all sensors, flags after it only to that sensor. Without "-sensor"
+ *  one sensor on bus 0, chip-select 0 is used.
+ * 
  * @param argc              console input argument count passed from main()
  * @param argv              console input arguments passed from main()
- * @param kx132_config      pointer to struct containg all configuration settings
+ * @param kx132_config      pointer to array of structs containg all configuration settings, one per sensor
+ * @param maxSensors        number of structs in kx132_config
+ * @return uint8_t          number of configured sensors
  */
-void kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config);
+uint8_t kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config, uint8_t maxSensors);
 
 
 /**
@@ -152,13 +399,51 @@ void processInitFlags(  uint16_t            argc,
  * @brief Parser for tcp user input during runtime.
  * 
  * @param data              pointer to string containing user input
- * @param triggerConfig     pointer to struct containing trigger setting for changing
- * @param triggerData       pointer to struct containing trigger data for changing
- * @param outputDataRate    info about hardware frequency of sensor for calculating needed samples
+ * @param sensor            pointer to sensor whose trigger settings and statistics are changed
  * @return true             if an "exit"-message was sent, will terminate program
  * @return false            if no "exit"-message was sent
  */
-bool processRuntimeFlags(char *data, trigger_config_t *triggerConfig, trigger_data_t *triggerData, outputDataRate_hw_t outputDataRate);
+bool processRuntimeFlags(char *data, kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Returns the output data rate of KX132 in Hz.
+ * 
+ * @param outputDataRate    hardware setting of output data rate
+ * @return double           frequency in Hz
+ */
+double getOutputDataRateHz(outputDataRate_hw_t outputDataRate);
+
+
+/**
+ * @brief Returns the output data rate of the samples read by the host.
+ * 
+ * @param mainConfig        pointer to struct containing output data rate and Advanced Data Path config
+ * @return outputDataRate_hw_t  OADP if Advanced Data Path is enabled, else output data rate
+ */
+outputDataRate_hw_t getSampleOutputDataRate(main_config_t *mainConfig);
+
+
+/**
+ * @brief Returns the scale factor from 16-Bit counts to a unit.
+ * 
+ *  Factors are precomputed per g-range, 8-Bit counts (high bytes) are 256 times larger.
+ * 
+ * @param gRange            hardware setting of g-range
+ * @param unit              unit of output
+ * @return float            unit per count, 1 for unit_counts
+ */
+float getUnitPerCount(gRange_hw_t gRange, outputUnit_t unit);
+
+
+/**
+ * @brief Sets the measured output data rate and recalculates samples before + after trigger with it.
+ * 
+ * @param triggerInfo       pointer to struct containing the time related trigger settings
+ * @param sampleRateHz      measured output data rate, 0 to use the hardware frequency again
+ * @param outputDataRate    hardware frequency of sensor
+ */
+void setTriggerSampleRate(trigger_info_t *triggerInfo, double sampleRateHz, outputDataRate_hw_t outputDataRate);
 
 
 /**
@@ -177,10 +462,9 @@ void setOffsetThresholds(trigger_data_t* triggerData);
  * 
  *  Reads n (Default=5000) samples and creates an average.
  * 
- * @param readMode          readMode Flag to read through sync0/async
- * @param triggerData       pointer to struct containing the normalized data
+ * @param sensor            pointer to sensor, its readMode and triggerData are used
  */
-void normalizeThresholds(readMode_hw_t readMode ,trigger_data_t* triggerData);
+void normalizeThresholds(kx132_sensor_t *sensor);
 
 
 
@@ -23,52 +23,202 @@
 /**
  * @brief Initializes KX132 accelerometer with set parameters  
  * 
+ *  Registers the sensor for kx132_runtime_config().
+ * 
+ * @param sensor        pointer to sensor with id, config and initialized spiDevice
  * @return true         if successful
  * @return false        if error
  */
-bool kx132_init(kx132_config_t* config);
+bool kx132_init(kx132_sensor_t* sensor);
 
 
 /**
  * @brief Software Resets the KX132.
  * 
+ * @param sensor        pointer to sensor
+ */
+void kx132_software_reset(kx132_sensor_t* sensor);
+
+
+/**
+ * @brief Picks the fastest reliable SPI clock of the sensor, called before kx132_init().
+ * 
+ *  Sweeps the SPI clock from fast to slow, every clock has to pass repeated WHO_AM_I / MAN_ID reads
+ *  and write-readbacks. The clock one step slower than the fastest passing one is kept as safety margin.
+ *  Prints the resulting transfer time of one sample.
+ * 
+ * @param sensor        pointer to sensor with initialized spiDevice
+ * @return true         if a reliable clock was found
+ * @return false        if the sensor did not respond correctly at any clock
  */
-void kx132_software_reset(void);
+bool kx132_spi_calibrate(kx132_sensor_t* sensor);
 
 
 /**
  * @brief Reads the 6 Normal Axis Output Register of KX132 in async-mode 
  * 
  * @attention           Asynchronous reading is discouraged as it leads to a lot of duplicates in data.
+ *                      The sample buffer only counts samples, reads with an unchanged sample level are discarded as duplicates.
  * 
+ * @param sensor        pointer to sensor
  * @param xyzRawData    pointer to buffer where raw data should be saved
+ * @return true         if the sample buffer counted a new sample since the last read
+ * @return false        if duplicate
  */
-void kx132_async_read_raw_data(uint8_t* xyzRawData);
+bool kx132_async_read_raw_data(kx132_sensor_t* sensor, uint8_t* xyzRawData);
 
 
 /**
  * @brief  Reads the 6 Normal Axis Output Register of KX132 in software-sync-mode 
  * 
+ * @param sensor        pointer to sensor
  * @param xyzRawData    pointer to buffer where raw data should be saved
  * @return true         if data was ready and could be read
  * @return false        if data was not ready
  */
-bool kx_132_sync0_read_raw_data(uint8_t* xyzRawData);
+bool kx_132_sync0_read_raw_data(kx132_sensor_t* sensor, uint8_t* xyzRawData);
+
+
+/**
+ * @brief Reads the 6 Normal Axis Output Register of KX132 after Data-Ready was signaled on INT1.
+ * 
+ *  Thread blocks on an edge of the GPIO connected to INT1 instead of polling INS2.
+ * 
+ * @param sensor        pointer to sensor
+ * @param xyzRawData    pointer to buffer where raw data should be saved
+ * @return true         if data was ready and could be read
+ * @return false        if no edge occured until timeout
+ */
+bool kx132_sync1_read_raw_data(kx132_sensor_t* sensor, uint8_t* xyzRawData);
+
+
+/**
+ * @brief Drains the sample buffer of KX132 through BUF_READ in one burst.
+ * 
+ * @note Sample buffer needs to be enabled through readMode buffer_read in kx132_init().
+ * 
+ * @param sensor        pointer to sensor
+ * @param rawBlock      pointer to block where raw data is received, no copy involved
+ * @return uint16_t     number of samples read, 0 if the sample threshold was not reached yet
+ */
+uint16_t kx132_buffer_read_raw_data(kx132_sensor_t* sensor, kx132_raw_block_t* rawBlock);
+
+
+/**
+ * @brief Drains the sample buffer of KX132 after it was frozen by a trigger event and arms it again.
+ * 
+ *  Sleeps until the buffer should be full, if the trigger event already occurred. Otherwise waits on INT1
+ *  or sleeps one poll interval.
+ * 
+ * @note Sample buffer needs to be armed by kx132_buffer_trigger_mode().
+ * 
+ * @param sensor        pointer to sensor
+ * @param rawBlock      pointer to block where raw data is received, no copy involved
+ * @return uint16_t     number of samples read (whole buffer), 0 if no trigger event filled the buffer yet
+ */
+uint16_t kx132_buffer_trigger_read_raw_data(kx132_sensor_t* sensor, kx132_raw_block_t* rawBlock);
+
+
+/**
+ * @brief Reads all new samples of KX132 depending on readMode.
+ * 
+ *  sync0 / sync1 / async read at most one sample, buffer_read drains a whole block of samples.
+ *  Samples are stored consecutively in rawBlock->data, bytesPerSample bytes each (high bytes only in 8-Bit resolution).
+ * 
+ * @param sensor        pointer to sensor
+ * @param readMode      readMode Flag to read through sync0/sync1/async/buffer
+ * @param rawBlock      pointer to block where raw data should be saved, reused for every read
+ * @param timestamps    pointer to buffer where timestamp of every sample (ns, CLOCK_MONOTONIC) should be saved (at least KX132_BUF_MAX_SAMPLES_8BIT), may be NULL
+ * @return uint16_t     number of samples read, 0 if no new data was ready
+ */
+uint16_t kx132_read_raw_samples(kx132_sensor_t* sensor, readMode_hw_t readMode, kx132_raw_block_t* rawBlock, uint64_t* timestamps);
+
+
+/**
+ * @brief Converts one raw sample read by kx132_read_raw_samples() to signed 16-Bit values.
+ * 
+ *  8-Bit samples are scaled like 16-Bit samples with empty low bytes.
+ * 
+ * @param sensor        pointer to sensor, its resolution is used
+ * @param xyzRawData    pointer to raw sample (bytesPerSample bytes)
+ * @param xyzFormatted  pointer to array where signed 16-Bit values should be saved
+ */
+void kx132_convert_raw_sample(kx132_sensor_t* sensor, uint8_t* xyzRawData, int16_t* xyzFormatted);
+
+
+/**
+ * @brief Scales blocks of counts of all axes to physical units.
+ * 
+ * @param sensor            pointer to sensor, its resolution is used
+ * @param xyzCounts         pointer to array holding arrays of int16_t counts (int8_t in 8-Bit resolution)
+ * @param numberOfSamples   number of samples per axis
+ * @param scale             unit per 16-Bit count, from unit_config_t
+ * @param xyzUnit           pointer to array holding arrays where float values should be saved
+ */
+void kx132_convert_to_unit(kx132_sensor_t* sensor, void** xyzCounts, uint32_t numberOfSamples, float scale, float** xyzUnit);
+
+
+/**
+ * @brief Copies counters of read, duplicate and lost samples.
+ * 
+ * @param sensor        pointer to sensor
+ * @param sampleStats   pointer to struct where counters should be saved
+ */
+void kx132_get_sample_stats(kx132_sensor_t* sensor, sample_stats_t *sampleStats);
+
+
+/**
+ * @brief Resets counters of read, duplicate and lost samples.
+ * 
+ * @param sensor        pointer to sensor
+ */
+void kx132_reset_sample_stats(kx132_sensor_t* sensor);
+
+
+/**
+ * @brief Prints loop period jitter, measured output data rate and sample counters of one sensor.
+ * 
+ * @param sensor        pointer to sensor
+ */
+void kx132_print_stats(kx132_sensor_t* sensor);
+
+
+/**
+ * @brief Makes kx132_main_loop() and kx132_runtime_config() of all sensors return, like "exit" of the client.
+ * 
+ */
+void kx132_stop(void);
 
 
 /**
  * @brief Processes user input from tcp and changes trigger settings durting runtime.
  * 
- * @param kx_config pointer to struct containing needed triggerConfig- and triggerData-struct
+ *  Input is applied to all sensors registered by kx132_init(), "sensor <n> ..." only to sensor n.
+ * 
+ * @param arg       unused
  */
-void *kx132_runtime_config(void *kx_config);
+void *kx132_runtime_config(void *arg);
 
 
 /**
- * @brief Calls either kx132_streaming_mode() or kx132_trigger_mode() for reading data from KX132.
+ * @brief Reads blocks of samples from KX132 and queues them for kx132_consumer_loop(), never waits for it.
+ * 
+ *  Every sensor is read by its own thread, sensors on the same bus take turns through its lock.
+ *  Only SPI, wake-up engine and Advanced Data Path are handled here, a full queue drops samples and counts them.
+ * 
+ * @param kx_sensor pointer to sensor containing all relevant settings
+ */
+void *kx132_main_loop(void *kx_sensor);
+
+
+/**
+ * @brief Calls either kx132_streaming_mode(), kx132_trigger_mode() or kx132_buffer_trigger_mode() for processing the queued blocks.
+ * 
+ *  Runs in its own thread next to kx132_main_loop() until it closes the queue, then prints the statistics.
+ *  Trigger mode sends its events from a third thread.
  * 
- * @param kx_config pointer to main config-struct containing all relevant settings
+ * @param kx_sensor pointer to sensor containing all relevant settings
  */
-void *kx132_main_loop(void *kx_config);
+void *kx132_consumer_loop(void *kx_sensor);
 
 #endif //DRV_KX132_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file gpio_event.h
+ * @author awa
+ * @date 17-10-2026
+ *
+ * @brief Header for gpio_event.c
+ *
+ *  function declarations and typedefs needed for waiting on edges of the INT1-PIN of KX132.
+ *
+ */
+
+#ifndef GPIO_EVENT_H
+#define GPIO_EVENT_H
+
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+///\endcond
+
+
+#define GPIO_CHIP_PATH_LEN      32
+#define DEFAULT_GPIO_CHIP_PATH  "/dev/gpiochip0"
+#define DEFAULT_GPIO_INT1_LINE  25                  ///< BCM-GPIO connected to INT1-PIN of KX132
+
+
+///< enum for source of INT1 edge events
+typedef enum{
+    gpio_source_none        = 0,                    ///< INT1 is not used
+    gpio_source_cdev        = 1,                    ///< Linux GPIO character device (/dev/gpiochipN)
+    gpio_source_sim         = 2,                    ///< simulated edges, for running without hardware
+} gpio_source_t;
+
+
+/// struct holding configuration of the GPIO connected to INT1
+typedef struct{
+    gpio_source_t           source;                         ///< cdev / sim / none
+    char                    chipPath[GPIO_CHIP_PATH_LEN];   ///< path of GPIO character device
+    uint32_t                line;                           ///< line offset of GPIO on chip
+} gpio_config_t;
+
+
+typedef struct gpio_event_s gpio_event_t;
+
+
+/// struct holding the functions of an event source, so sources can be swapped
+typedef struct{
+    bool    (*init)         (gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs);
+    int32_t (*wait)         (gpio_event_t *event, uint32_t timeoutUs);
+    void    (*deinit)       (gpio_event_t *event);
+} gpio_event_source_t;
+
+
+/// struct holding the INT1-PIN of one sensor, zero-initialized before gpio_event_init()
+struct gpio_event_s{
+    const gpio_event_source_t*  source;             ///< set through gpio_event_set_source() or gpio_event_init()
+    void*                       context;            ///< passed to the source, e.g. the simulated KX132
+    int                         lineFd;             ///< fd of requested line (cdev)
+    uint64_t                    simPeriodNs;        ///< period of simulated edges
+    struct timespec             simNextEdge;        ///< absolute time of next simulated edge
+};
+
+
+/**
+ * @brief Requests rising edge events of the configured GPIO line.
+ *
+ * @param event             pointer to event struct of the sensor
+ * @param gpioConfig        pointer to struct containing source, chip and line
+ * @param eventPeriodNs     expected time between two edges, only used by simulated source
+ * @return true             if success
+ * @return false            if error or source is gpio_source_none
+ */
+bool gpio_event_init(gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs);
+
+
+/**
+ * @brief Blocks until a rising edge occurs on INT1 or timeout expires.
+ *
+ * @param event             pointer to event struct of the sensor
+ * @param timeoutUs         maximum time to wait in microseconds
+ * @return int32_t          number of edges consumed, 0 on timeout, -1 on error
+ */
+int32_t gpio_event_wait(gpio_event_t *event, uint32_t timeoutUs);
+
+
+/**
+ * @brief Releases the GPIO line.
+ *
+ * @param event             pointer to event struct of the sensor
+ */
+void gpio_event_deinit(gpio_event_t *event);
+
+
+/**
+ * @brief Replaces the event source used by gpio_event_wait().
+ *
+ * @note Must be called before gpio_event_init().
+ *
+ * @param event             pointer to event struct of the sensor
+ * @param eventSource       pointer to struct containing the functions of the new source
+ * @param context           passed to the functions of the source through event->context
+ */
+void gpio_event_set_source(gpio_event_t *event, const gpio_event_source_t *eventSource, void *context);
+
+
+#endif //GPIO_EVENT_H
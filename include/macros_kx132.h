@@ -18,6 +18,7 @@
 #define Z_INDEX             2
 #define NUMBER_OF_AXES      3
 #define NUMBER_OF_CHANNELS  6
+#define NUMBER_OF_CHANNELS_8BIT 3   ///< 8-Bit resolution only uses the high bytes
 
 
 #define X_LOW_CHANNEL       0
@@ -15,10 +15,33 @@
 ///\cond
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/types.h>
 ///\endcond
 
 #include <trigger.h>
 
+
+#define RB_CACHE_LINE       64      ///< every axis of an interleaved block fills one cache line
+#define RB_MAX_VIEWS        4       ///< windows of a multi-axis ringbuffer handed out at the same time, power of two
+
+#define RB_FILE_MAGIC       0x4B583133  ///< "KX13", first bytes of a history file
+#define RB_FILE_VERSION     1
+#define RB_FILE_SYNC_SAMPLES 65536      ///< samples written back to a history file at once
+#define RB_FILE_REBOOT_NS   1000000000  ///< realtime offsets further apart than this belong to another boot
+
+#define RB_PYRAMID_LEVELS   3       ///< envelopes of 16, 256 and 4096 samples
+#define RB_PYRAMID_SHIFT    4       ///< every level combines 2^RB_PYRAMID_SHIFT envelopes of the level below
+#define RB_PYRAMID_ENTRIES  32768   ///< envelopes kept per level, power of two
+
+#define RB_PACK_BLOCK_SAMPLES   128     ///< samples of a compressed block, power of two
+#define RB_PACK_BLOCK_SHIFT     7       ///< log2(RB_PACK_BLOCK_SAMPLES)
+#define RB_PACK_BLOCK_BYTES     64      ///< average compressed block the block table is sized for, smaller blocks give up history early
+#define RB_PACK_SLACK_BYTES     8       ///< left free behind every block, the decoder reads 8 bytes from where a value starts
+#define RB_PACK_MAX_BYTES       (NUMBER_OF_AXES * (3 + (17 * (RB_PACK_BLOCK_SAMPLES - 1) + 7) / 8) + 13 + (64 * (RB_PACK_BLOCK_SAMPLES - 1) + 7) / 8)  ///< block of worst case deltas / timestamps
+
 /// struct for ringbuffer
 typedef struct{
     int16_t* buffer;    ///< buffer containing actual data
@@ -28,6 +51,141 @@ typedef struct{
 } ringbuffer_t;
 
 
+///< enum for storage layout of ringbuffer_xyz_t
+typedef enum{
+    rb_layout_soa           = 0,    ///< one array per axis
+    rb_layout_interleaved   = 1,    ///< blocks of one cache line per axis: X X .. X, Y Y .. Y, Z Z .. Z, next block
+    rb_layout_mirrored      = 2,    ///< one array per axis, its pages mapped twice back to back, any window of up to size samples is contiguous
+} rb_layout_t;
+
+
+/// struct for ringbuffer of all 3 axes with one shared write index, 16-Bit or 8-Bit values
+typedef struct{
+    uint8_t*    buffer;         ///< NUMBER_OF_AXES * size * valueSize bytes, aligned to RB_CACHE_LINE
+    uint32_t    size;           ///< samples per axis
+    uint32_t    index;          ///< current index for writing, same for all axes
+    uint32_t    modulo;         ///< modulo-value for wrapping
+    uint8_t     valueSize;      ///< sizeof(int16_t), sizeof(int8_t) in 8-Bit resolution
+    rb_layout_t layout;
+    uint32_t    blockSamples;   ///< samples per interleaved block, RB_CACHE_LINE / valueSize
+    uint32_t    blockShift;     ///< log2(blockSamples)
+
+    uint32_t                viewFirst[RB_MAX_VIEWS];    ///< index (not wrapped) of first sample of every view, only written by writer
+    uint32_t                viewsTaken;                 ///< views handed out, only written by writer
+    atomic_uint_fast32_t    viewsReleased;              ///< views given back, only written by reader
+} ringbuffer_xyz_t;
+
+
+/// window of a multi-axis ringbuffer read in place, its samples are not overwritten until it is released
+typedef struct{
+    uint32_t    localIndex;         ///< local index of first sample
+    uint32_t    numberOfSamples;    ///< samples in window, at most size of ringbuffer
+} rb_view_t;
+
+
+/// contiguous part of a view, pointers into the ringbuffers
+typedef struct{
+    void*       xyz[NUMBER_OF_AXES];    ///< int16_t (int8_t in 8-Bit resolution) values of every axis
+    uint64_t*   timestamps;             ///< timestamps of the samples
+    uint32_t    numberOfSamples;        ///< samples in span
+} rb_span_t;
+
+
+/// header in the first page of a history file, only advanced after the samples it covers are on disk
+typedef struct{
+    uint32_t    magic;              ///< RB_FILE_MAGIC
+    uint32_t    version;            ///< RB_FILE_VERSION
+    uint32_t    size;               ///< samples per axis
+    uint32_t    valueSize;          ///< sizeof(int16_t), sizeof(int8_t) in 8-Bit resolution
+    uint32_t    layout;             ///< rb_layout_t of the axes
+    uint32_t    index;              ///< samples pushed (not wrapped), all samples before are on disk
+    uint32_t    reserved;           ///< 0, aligns realtimeOffsetNs
+    int64_t     realtimeOffsetNs;   ///< CLOCK_REALTIME - CLOCK_MONOTONIC of the run that wrote index, moves restored timestamps onto the clock of this boot
+    uint32_t    checksum;           ///< FNV-1a of all fields before, a torn header is not used
+} rb_file_header_t;
+
+
+/// struct for a multi-axis ringbuffer and its timestamps kept in a memory-mapped file
+typedef struct{
+    int                 fd;
+    rb_file_header_t*   header;             ///< first page of file
+    uint8_t*            xyzBuffer;          ///< buffer for rb_multi_init(), same layout as rb_multi_alloc()
+    uint64_t*           timestampBuffer;    ///< buffer for rb_ts_init()
+    uint32_t            size;               ///< samples per axis
+    uint8_t             valueSize;          ///< sizeof(int16_t) or sizeof(int8_t)
+    rb_layout_t         layout;             ///< storage layout of the axes
+    off_t               axesOffset;         ///< offset of X in file, Y and Z follow
+    off_t               timestampOffset;    ///< offset of timestamps in file
+    uint32_t            written;            ///< index (not wrapped) up to which writing back was started
+    uint32_t            durable;            ///< index (not wrapped) up to which samples are on disk
+} rb_file_t;
+
+
+/// envelope of 16, 256 or 4096 samples of all axes, values in counts of the ringbuffer
+typedef struct{
+    uint64_t    timestamp;                  ///< timestamp of first sample
+    int16_t     min     [NUMBER_OF_AXES];
+    int16_t     max     [NUMBER_OF_AXES];
+    int16_t     mean    [NUMBER_OF_AXES];
+    uint16_t    rms     [NUMBER_OF_AXES];
+} rb_envelope_t;
+
+
+/// one level of an envelope pyramid, the envelope being accumulated and a ring of the completed ones
+typedef struct{
+    rb_envelope_t*  entries;                        ///< RB_PYRAMID_ENTRIES envelopes
+    uint32_t        index;                          ///< envelopes completed (not wrapped)
+    uint32_t        count;                          ///< samples (first level) or envelopes of the level below accumulated
+    uint64_t        timestamp;                      ///< timestamp of first sample accumulated
+    int16_t         min         [NUMBER_OF_AXES];
+    int16_t         max         [NUMBER_OF_AXES];
+    int64_t         sum         [NUMBER_OF_AXES];
+    uint64_t        sumSquares  [NUMBER_OF_AXES];
+} rb_pyramid_level_t;
+
+
+/// decimated min / max / mean / RMS of a multi-axis ringbuffer, hours of envelopes in a few MB
+typedef struct{
+    rb_pyramid_level_t  level[RB_PYRAMID_LEVELS];
+    pthread_mutex_t     lock;           ///< pushing and reading run in different threads
+} rb_pyramid_t;
+
+
+/// ring of compressed blocks of a multi-axis ringbuffer and its timestamps, several times the history per MB
+typedef struct{
+    uint8_t*    buffer;             ///< compressed blocks, size bytes, a block never wraps
+    uint32_t    size;               ///< bytes, power of two
+    uint32_t    head;               ///< bytes written (not wrapped)
+    uint32_t*   blockOffsets;       ///< head (not wrapped) before every block, blockCount entries
+    uint32_t    blockCount;         ///< entries of blockOffsets, power of two
+    uint32_t    blocksWritten;      ///< blocks packed since init
+    uint32_t    oldestBlock;        ///< oldest block not overwritten
+    uint32_t    firstSample;        ///< index (not wrapped) of first sample of block 0 in the ringbuffer
+    uint8_t     valueSize;          ///< sizeof(int16_t), sizeof(int8_t) in 8-Bit resolution
+
+    uint32_t                viewBlock[RB_MAX_VIEWS];    ///< first block of every view, only written by writer
+    uint32_t                viewHead[RB_MAX_VIEWS];     ///< head (not wrapped) before first block of every view, only written by writer
+    uint32_t                viewsTaken;                 ///< views handed out, only written by writer
+    atomic_uint_fast32_t    viewsReleased;              ///< views given back, only written by reader
+} rb_pack_t;
+
+
+/// older part of a window held by a compressed ring, its blocks are not overwritten until it is released
+typedef struct{
+    uint32_t    firstSample;        ///< index (not wrapped) of first sample in the ringbuffer it was packed from
+    uint32_t    numberOfSamples;    ///< samples decoded from compressed ring, 0 if the window is held by the ringbuffer only
+} rb_pack_view_t;
+
+
+/// struct for ringbuffer of timestamps, kept in step with the ringbuffers of the axes
+typedef struct{
+    uint64_t* buffer;   ///< buffer containing timestamps in nanoseconds (CLOCK_MONOTONIC)
+    uint32_t size;      ///< size of buffer
+    uint32_t index;     ///< current index for writing
+    uint32_t modulo;    ///< modulo-value for wrapping
+} ringbuffer_ts_t;
+
+
 /**
  * @brief Initializes passed ringbuffer.
  * 
@@ -93,4 +251,378 @@ uint32_t rb_push(ringbuffer_t* rb, int16_t data);
 void rb_read_chunk(ringbuffer_t *rb, int16_t *buffer, trigger_info_t *triggerInfo);
 
 
+/**
+ * @brief Returns the address space taken by the buffer of a multi-axis ringbuffer.
+ * 
+ * @note A mirrored buffer takes twice its memory in address space, every page is mapped twice.
+ * 
+ * @param size          samples per axis
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ * @return size_t       size of buffer in bytes
+ */
+size_t rb_multi_bytes(uint32_t size, uint8_t valueSize, rb_layout_t layout);
+
+
+/**
+ * @brief Allocates the buffer of a multi-axis ringbuffer, aligned to RB_CACHE_LINE.
+ * 
+ *  A mirrored buffer is a memfd mapped twice per axis, so size * valueSize has to be a multiple of the page size.
+ * 
+ * @param size          samples per axis
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ * @return void*        pointer to buffer of rb_multi_bytes() bytes, NULL if error
+ */
+void *rb_multi_alloc(uint32_t size, uint8_t valueSize, rb_layout_t layout);
+
+
+/**
+ * @brief Frees a buffer returned by rb_multi_alloc().
+ * 
+ * @param buffer        pointer to buffer
+ * @param size          samples per axis, same as passed to rb_multi_alloc()
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ */
+void rb_multi_free(void *buffer, uint32_t size, uint8_t valueSize, rb_layout_t layout);
+
+
+/**
+ * @brief Initializes passed multi-axis ringbuffer.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param buffer        pointer to buffer returned by rb_multi_alloc()
+ * @param size          samples per axis, power of two and at least one interleaved block
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ * @return true         if succes
+ * @return false        if error
+ */
+bool rb_multi_init(ringbuffer_xyz_t *rb, void *buffer, uint32_t size, uint8_t valueSize, rb_layout_t layout);
+
+
+/**
+ * @brief Pushes a block of samples of all axes, one index update for the whole block.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param xyzData           pointer to 3 arrays of int16_t (int8_t in 8-Bit resolution) values
+ * @param numberOfSamples   number of samples per axis
+ * @return                  local index of first sample, same as rb_push()
+ */
+uint32_t rb_push_block(ringbuffer_xyz_t *rb, void **xyzData, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Converts a block of raw samples straight into the ringbuffer, split once at most where it wraps.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param xyzRawData        pointer to raw samples, NUMBER_OF_CHANNELS (NUMBER_OF_CHANNELS_8BIT) bytes each
+ * @param numberOfSamples   number of samples in block
+ * @return                  local index of first sample, same as rb_push()
+ */
+uint32_t rb_push_raw_block(ringbuffer_xyz_t *rb, const uint8_t *xyzRawData, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Returns where the values of samples from localIndex on are stored contiguously, no copy involved.
+ * 
+ *  Used for going through pushed samples, e.g. for trigger detection. Call again with the next local index
+ *  until all samples are covered, SoA only splits at the end of the buffer, interleaved at the end of every block,
+ *  mirrored never splits up to size samples.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param localIndex        local index of first sample
+ * @param numberOfSamples   samples wanted
+ * @param xyzSpan           pointer to array where a pointer to the int16_t (int8_t in 8-Bit resolution) values of every axis is saved
+ * @return uint32_t         samples in span, at most numberOfSamples
+ */
+uint32_t rb_get_span(ringbuffer_xyz_t *rb, uint32_t localIndex, uint32_t numberOfSamples, void **xyzSpan);
+
+
+/**
+ * @brief Reads chunk of all axes from ringbuffer, same borders as rb_read_chunk(). Copies contiguous spans at once.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param xyzBuffer     pointer to 3 buffers of int16_t (int8_t in 8-Bit resolution) where read data should be saved
+ * @param triggerInfo   struct containing needed information about triggerIndex, numberOfSamples to be read and samplesBeforeTrig
+ */
+void rb_read_block(ringbuffer_xyz_t *rb, void **xyzBuffer, trigger_info_t *triggerInfo);
+
+
+/**
+ * @brief Initializes passed ringbuffer of timestamps.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param buffer        pointer to buffer to hold the timestamps
+ * @param size          size of buffer, same as size of ringbuffers of the axes
+ * @return true         if succes
+ * @return false        if error
+ */
+bool rb_ts_init(ringbuffer_ts_t *rb, uint64_t *buffer, uint32_t size);
+
+
+/**
+ * @brief Pushes one timestamp onto ringbuffer.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param timestamp     timestamp of sample in nanoseconds
+ * @return              local index, same as rb_push() of the sample
+ */
+uint32_t rb_ts_push(ringbuffer_ts_t *rb, uint64_t timestamp);
+
+
+/**
+ * @brief Pushes the timestamps of a block of samples onto ringbuffer.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param timestamps        pointer to timestamps in nanoseconds
+ * @param numberOfSamples   number of timestamps
+ * @return                  local index of first timestamp, same as rb_push_raw_block()
+ */
+uint32_t rb_ts_push_block(ringbuffer_ts_t *rb, const uint64_t *timestamps, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Hands out a window of the ringbuffer to be read in place by another thread, same borders as rb_read_block().
+ * 
+ *  Writer side only. Samples of the window are guarded until rb_view_release(), see rb_push_free().
+ *  A ringbuffer of timestamps pushed in step is covered by the same guard.
+ *  A window reaching further back than the ringbuffer starts at its oldest sample, samplesBeforeTrig and numberOfSamples are reduced then.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param triggerInfo   pointer to trigger index and samples before / after trigger, adapted to the window taken
+ * @param view          pointer to view to be filled
+ * @return true         if success
+ * @return false        if RB_MAX_VIEWS views are not released yet
+ */
+bool rb_view_take(ringbuffer_xyz_t *rb, trigger_info_t *triggerInfo, rb_view_t *view);
+
+
+/**
+ * @brief Gives the oldest view back, its samples may be overwritten from now on. Reader side only.
+ * 
+ * @param rb            pointer to ringbuffer
+ */
+void rb_view_release(ringbuffer_xyz_t *rb);
+
+
+/**
+ * @brief Checks whether a push would overwrite a sample of a view not released yet. Writer side only.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param numberOfSamples   number of samples to be pushed
+ * @return true             if samples can be pushed
+ * @return false            if the writer has to wait for rb_view_release()
+ */
+bool rb_push_free(ringbuffer_xyz_t *rb, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Returns the contiguous part of a view starting offset samples into it, no copy involved.
+ * 
+ *  Spans split where the ringbuffer of the axes (see rb_get_span()) or the ringbuffer of timestamps wraps.
+ * 
+ * @param rb            pointer to ringbuffer of the axes
+ * @param rbTs          pointer to ringbuffer of timestamps, pushed in step
+ * @param view          pointer to view
+ * @param offset        samples of the view already covered
+ * @param span          pointer to span to be filled
+ * @return uint32_t     samples in span, 0 at the end of the view
+ */
+uint32_t rb_view_span(ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, uint32_t offset, rb_span_t *span);
+
+
+/**
+ * @brief Opens or creates a history file and maps the buffers of the axes and timestamps from it.
+ * 
+ *  The file is a header page, the axes and the timestamps. The mappings are not locked into RAM, the page cache
+ *  holds the recent samples only. A file of other size, resolution or layout is started again.
+ * 
+ * @param file          pointer to history file
+ * @param path          path of file, e.g. on SD card or USB SSD
+ * @param size          samples per axis, power of two
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ * @return true         if success
+ * @return false        if file could not be created or mapped
+ */
+bool rb_file_open(rb_file_t *file, const char *path, uint32_t size, uint8_t valueSize, rb_layout_t layout);
+
+
+/**
+ * @brief Continues the ringbuffers after the samples recovered from the history file.
+ * 
+ *  Recovered timestamps are moved onto CLOCK_MONOTONIC of this boot, windows and packed blocks see one clock.
+ * 
+ * @note Up to 2 * RB_FILE_SYNC_SAMPLES of the oldest samples may already be replaced by samples written after the header.
+ * 
+ * @param file          pointer to history file
+ * @param rb            pointer to ringbuffer of the axes, initialized with file->xyzBuffer
+ * @param rbTs          pointer to ringbuffer of timestamps, initialized with file->timestampBuffer
+ * @return uint32_t     samples recovered
+ */
+uint32_t rb_file_restore(rb_file_t *file, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs);
+
+
+/**
+ * @brief Writes pushed samples back to the file behind the writer, called after every push.
+ * 
+ *  Every RB_FILE_SYNC_SAMPLES samples writing back is started, the samples started before are waited for
+ *  and the header is advanced to them. Only the writer waits, and only if the disk is slower than the samples.
+ * 
+ * @param file          pointer to history file
+ * @param rb            pointer to ringbuffer of the axes
+ */
+void rb_file_sync(rb_file_t *file, ringbuffer_xyz_t *rb);
+
+
+/**
+ * @brief Writes all samples and the header to disk and unmaps the file.
+ * 
+ * @param file          pointer to history file
+ * @param rb            pointer to ringbuffer of the axes
+ */
+void rb_file_close(rb_file_t *file, ringbuffer_xyz_t *rb);
+
+
+/**
+ * @brief Allocates the levels of an envelope pyramid and starts it empty.
+ * 
+ * @param pyramid       pointer to pyramid
+ * @return true         if success
+ * @return false        if memory could not be allocated
+ */
+bool rb_pyramid_init(rb_pyramid_t *pyramid);
+
+
+/**
+ * @brief Frees the levels of an envelope pyramid.
+ * 
+ * @param pyramid       pointer to pyramid
+ */
+void rb_pyramid_free(rb_pyramid_t *pyramid);
+
+
+/**
+ * @brief Adds the samples pushed last to the envelopes of all levels, called after every push.
+ * 
+ *  Samples are read back from the ringbuffer while they are still in cache. An envelope of a level is
+ *  completed every 16 samples / envelopes, then it is added to the level above.
+ * 
+ * @param pyramid           pointer to pyramid
+ * @param rb                pointer to ringbuffer of the axes
+ * @param rbTs              pointer to ringbuffer of timestamps pushed in step
+ * @param numberOfSamples   samples pushed last
+ */
+void rb_pyramid_push(rb_pyramid_t *pyramid, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Returns the finest level of a pyramid that covers a number of samples, the coarsest if none does.
+ * 
+ * @param numberOfSamples   samples of history
+ * @return uint8_t          level, 0 for envelopes of 16 samples
+ */
+uint8_t rb_pyramid_level(uint64_t numberOfSamples);
+
+
+/**
+ * @brief Copies the newest envelopes of a level, oldest first.
+ * 
+ * @param pyramid           pointer to pyramid
+ * @param level             level, 0 for envelopes of 16 samples
+ * @param numberOfEntries   envelopes requested
+ * @param envelopes         pointer to array of at least numberOfEntries envelopes
+ * @return uint32_t         envelopes copied, fewer if the level holds fewer
+ */
+uint32_t rb_pyramid_read(rb_pyramid_t *pyramid, uint8_t level, uint32_t numberOfEntries, rb_envelope_t *envelopes);
+
+
+/**
+ * @brief Allocates a compressed ring and starts it empty.
+ * 
+ * @param pack          pointer to compressed ring
+ * @param size          bytes, power of two
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t), same as the ringbuffer packed from
+ * @param firstSample   index (not wrapped) of the ringbuffer packing starts at, rounded up to a block
+ * @return true         if success
+ * @return false        if memory could not be allocated
+ */
+bool rb_pack_init(rb_pack_t *pack, uint32_t size, uint8_t valueSize, uint32_t firstSample);
+
+
+/**
+ * @brief Frees a compressed ring.
+ * 
+ * @param pack          pointer to compressed ring
+ */
+void rb_pack_free(rb_pack_t *pack);
+
+
+/**
+ * @brief Checks, if the blocks completed in the ringbuffer can be packed without overwriting a view still being read.
+ * 
+ * @param pack          pointer to compressed ring
+ * @param rb            pointer to ringbuffer of the axes packed from
+ * @return true         if rb_pack_push() may be called
+ * @return false        if a view would be overwritten, the writer has to wait for rb_pack_release()
+ */
+bool rb_pack_push_free(rb_pack_t *pack, ringbuffer_xyz_t *rb);
+
+
+/**
+ * @brief Packs every block of RB_PACK_BLOCK_SAMPLES samples completed in the ringbuffers since the last call.
+ * 
+ *  Every axis is stored as its first value and the zig-zag deltas bit-packed at the width of the largest one,
+ *  timestamps as the deviations from a straight line through the first and last one. Called after every push.
+ * 
+ * @param pack          pointer to compressed ring
+ * @param rb            pointer to ringbuffer of the axes
+ * @param rbTs          pointer to ringbuffer of timestamps pushed in step
+ * @return uint32_t     blocks packed
+ */
+uint32_t rb_pack_push(rb_pack_t *pack, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs);
+
+
+/**
+ * @brief Takes a window before and after a trigger, the older samples from the compressed ring, the newest from the ringbuffer.
+ * 
+ *  The window starts at the oldest block still packed at most, or at the oldest sample of the ringbuffer if packing fell
+ *  behind it. samplesBeforeTrig and numberOfSamples are reduced then.
+ *  Neither part is overwritten until rb_view_release() and rb_pack_release() are called.
+ * 
+ * @param pack          pointer to compressed ring
+ * @param rb            pointer to ringbuffer of the axes
+ * @param triggerInfo   pointer to trigger index and samples before / after trigger, adapted to the window taken
+ * @param view          pointer to view of the newest samples not packed yet
+ * @param packView      pointer to view of the packed samples
+ * @return true         if success
+ * @return false        if RB_MAX_VIEWS views of one of the rings are still taken
+ */
+bool rb_pack_take(rb_pack_t *pack, ringbuffer_xyz_t *rb, trigger_info_t *triggerInfo, rb_view_t *view, rb_pack_view_t *packView);
+
+
+/**
+ * @brief Gives the oldest view back, called by the reader after the packed part of a window was read.
+ * 
+ * @param pack          pointer to compressed ring
+ */
+void rb_pack_release(rb_pack_t *pack);
+
+
+/**
+ * @brief Decodes samples of a view, only the blocks holding them are decoded.
+ * 
+ * @param pack              pointer to compressed ring
+ * @param packView          pointer to view
+ * @param offset            first sample decoded, relative to first sample of view
+ * @param numberOfSamples   samples decoded
+ * @param xyz               pointer to 3 arrays of at least numberOfSamples values of valueSize
+ * @param timestamps        pointer to array of at least numberOfSamples timestamps
+ * @return uint32_t         samples decoded, fewer at the end of the view
+ */
+uint32_t rb_pack_read(rb_pack_t *pack, rb_pack_view_t *packView, uint32_t offset, uint32_t numberOfSamples, void **xyz, uint64_t *timestamps);
+
+
 #endif // RINGBUFFER_H_
@@ -0,0 +1,130 @@
+/**
+ * @file rt_thread.h
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Header for rt_thread.c
+ * 
+ *  function declarations and typedefs needed for running the acquisition thread in real-time
+ *  and for measuring the jitter of its loop period.
+ * 
+ */
+
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+///\endcond
+
+
+#define RT_PRIORITY_OFF         0                   ///< thread is created with default scheduling
+#define RT_PRIORITY_MAX         99
+#define RT_CPU_ANY              -1                  ///< thread is not pinned
+#define RT_CPU_MAX              1023                ///< CPU_SETSIZE - 1
+#define RT_JITTER_HIST_US       10000               ///< loop periods are counted in 1 us bins up to this value
+
+
+/// struct holding configuration of the real-time acquisition thread
+typedef struct{
+    uint8_t                 priority;               ///< SCHED_FIFO priority (1 - 99), RT_PRIORITY_OFF for SCHED_OTHER
+    int16_t                 cpu;                    ///< CPU the thread is pinned to, RT_CPU_ANY for no affinity
+    bool                    lockMemory;             ///< lock all current and future pages with mlockall()
+} rt_config_t;
+
+
+///< enum for outcome of rt_thread_create()
+typedef enum{
+    rt_thread_failed        = 0,    ///< no thread was created, handle is not valid
+    rt_thread_configured    = 1,    ///< thread runs with configured priority and CPU
+    rt_thread_fallback      = 2,    ///< real-time scheduling was refused, thread runs with default attributes
+} rt_thread_result_t;
+
+
+/// struct holding loop period statistics of one acquisition thread
+typedef struct{
+    uint64_t                count;                              ///< number of recorded periods
+    uint64_t                sumNs;
+    uint64_t                minNs;
+    uint64_t                maxNs;
+    uint32_t                histogram   [RT_JITTER_HIST_US + 1];///< 1 us bins, last bin counts everything longer
+    struct timespec         lastLoop;
+    bool                    running;                            ///< false until first call of rt_jitter_record()
+    long                    minorFaults;                        ///< page faults of process at reset
+    long                    majorFaults;
+} rt_jitter_t;
+
+
+/**
+ * @brief Creates a thread with SCHED_FIFO priority and CPU affinity as configured.
+ * 
+ * @note Falls back to default attributes, if the process is not allowed to use real-time scheduling.
+ * 
+ * @param thread        pointer to thread handle
+ * @param rtConfig      pointer to struct containing priority and CPU
+ * @param routine       thread function
+ * @param arg           argument of thread function
+ * @return rt_thread_result_t  rt_thread_configured, rt_thread_fallback or rt_thread_failed, thread must not be joined then
+ */
+rt_thread_result_t rt_thread_create(pthread_t *thread, rt_config_t *rtConfig, void *(*routine)(void*), void *arg);
+
+
+/**
+ * @brief Locks all current and future pages of the process in RAM.
+ * 
+ * @note Stacks of threads created afterwards are locked and faulted in at creation.
+ * 
+ * @return true         if success
+ * @return false        if error (e.g. RLIMIT_MEMLOCK too low)
+ */
+bool rt_lock_memory(void);
+
+
+/**
+ * @brief Touches every page of a buffer, so no page fault happens in the reading loop.
+ * 
+ * @param buffer        pointer to buffer
+ * @param len           size of buffer in bytes
+ */
+void rt_prefault(void *buffer, size_t len);
+
+
+/**
+ * @brief Resets jitter statistics, next call of rt_jitter_record() starts measuring.
+ * 
+ * @param jitter        pointer to loop period statistics
+ */
+void rt_jitter_reset(rt_jitter_t *jitter);
+
+
+/**
+ * @brief Records the time since the last call as one loop period.
+ * 
+ * @note Called once per iteration of the reading loop.
+ * 
+ * @param jitter        pointer to loop period statistics
+ */
+void rt_jitter_record(rt_jitter_t *jitter);
+
+
+/**
+ * @brief Pauses measuring, next call of rt_jitter_record() starts a new period without recording the pause.
+ * 
+ * @param jitter        pointer to loop period statistics
+ */
+void rt_jitter_pause(rt_jitter_t *jitter);
+
+
+/**
+ * @brief Prints min / mean / max and percentiles of the loop period and page faults since reset.
+ * 
+ * @param jitter        pointer to loop period statistics
+ */
+void rt_jitter_print(rt_jitter_t *jitter);
+
+
+#endif //RT_THREAD_H
\ No newline at end of file
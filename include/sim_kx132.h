@@ -0,0 +1,158 @@
+/**
+ * @file sim_kx132.h
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Header for sim_kx132.c
+ * 
+ *  function declarations and typedefs needed for the simulated KX132 behind spi_backend_sim.
+ *  Every simulated sensor is an instance of sim_kx132_t, so several can run side by side.
+ * 
+ */
+
+#ifndef SIM_KX132_H
+#define SIM_KX132_H
+
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+///\endcond
+
+#include <regs_kx132.h>
+#include <macros_kx132.h>
+#include <gpio_event.h>
+
+
+#define SIM_PATH_LEN                    64
+#define SIM_NUMBER_OF_REGS              0x80
+#define SIM_BUF_SAMPLES_8BIT            171     ///< capacity of sample buffer, 8-Bit resolution
+
+#define DEFAULT_SIM_AMPLITUDE_G         0.5     ///< amplitude of sine / impulse
+#define DEFAULT_SIM_FREQUENCY_HZ        100.0   ///< frequency of sine / ringing of impulse
+#define DEFAULT_SIM_NOISE_G             0.008   ///< background noise (peak), added to every signal
+#define DEFAULT_SIM_IMPULSE_PERIOD_S    1.0     ///< time between two impulses
+#define DEFAULT_SIM_TIME_SCALE          1.0     ///< real time
+#define DEFAULT_SIM_MAX_SPI_CLOCK_HZ    10000000    ///< max SPI clock of KX132 datasheet
+
+
+///< enum for signal produced by the simulated KX132
+typedef enum{
+    sim_signal_none         = 0,                ///< 1 g on Z-Axis + background noise
+    sim_signal_sine         = 1,                ///< sine with amplitudeG and frequencyHz
+    sim_signal_noise        = 2,                ///< gaussian noise with standard deviation amplitudeG
+    sim_signal_impulse      = 3,                ///< decaying sine every impulsePeriodS
+    sim_signal_file         = 4,                ///< recorded waveform, replayed in a loop
+} sim_signal_t;
+
+
+/// struct holding configuration of the simulated KX132
+typedef struct{
+    sim_signal_t            signal;
+    double                  amplitudeG;                     ///< amplitude of sine / impulse, standard deviation of noise
+    double                  frequencyHz;                    ///< frequency of sine / ringing of impulse
+    double                  noiseG;                         ///< background noise (peak), added to every signal
+    double                  impulsePeriodS;                 ///< time between two impulses
+    double                  timeScale;                      ///< 1.0 = real time, 10.0 = sensor runs 10 times faster
+    uint32_t                maxSpiClockHz;                  ///< faster SPI clocks corrupt read bytes, more often the faster they are
+    char                    waveformPath[SIM_PATH_LEN];     ///< text file, one sample per line, last three of up to five numbers are x, y, z in counts
+} sim_kx132_config_t;
+
+
+/// struct holding the state of one simulated KX132
+typedef struct{
+    sim_kx132_config_t      config;
+    uint8_t                 regs            [SIM_NUMBER_OF_REGS];
+    struct timespec         startTime;                      ///< time when PC1 was set / ODR was changed
+    uint64_t                samplesProduced;                ///< samples produced since startTime
+    double                  signalTime;                     ///< sensor time of next sample in seconds
+    uint64_t                signalSample;                   ///< number of next sample since power up
+    uint32_t                noiseState;                     ///< state of xorshift generator for noise
+    uint8_t                 manIdIndex;                     ///< MAN_ID returns the next char of "Kion" on every read
+    int16_t                 buffer          [SIM_BUF_SAMPLES_8BIT][NUMBER_OF_AXES];
+    uint16_t                bufferHead;                     ///< index of oldest sample
+    uint16_t                bufferCount;                    ///< samples in buffer, incl. the one being read
+    uint8_t                 bufferByte;                     ///< bytes of oldest sample already read through BUF_READ
+    bool                    bufferTriggered;                ///< trigger event occurred in trigger mode, cleared by BUF_CLEAR
+    bool                    int1Latched;                    ///< latched INT1 is high until INT_REL is read
+    int32_t                 int1Edges;                      ///< rising edges on INT1 not yet consumed by wait
+    double                  adpLowPass      [NUMBER_OF_AXES];   ///< state of simulated filter-1
+    double                  adpMean         [NUMBER_OF_AXES];   ///< slow mean removed by simulated filter-2
+    double                  adpMeanSquare   [NUMBER_OF_AXES];   ///< state of simulated RMS engine
+    uint32_t                adpDecimation;                  ///< samples since last ADP output
+    int16_t                 wakeReference   [NUMBER_OF_AXES];   ///< last sample of wake-up engine, thresholds are relative to it
+    bool                    wakeReferenceValid;             ///< false until the engine saw its first sample
+    uint32_t                wakeDecimation;                 ///< samples since last sample of wake-up engine
+    uint8_t                 wakeCounter;                    ///< debounce counter of wake-up / back-to-sleep
+    int16_t*                waveform;                       ///< recorded waveform, x, y, z interleaved
+    uint32_t                waveformLength;                 ///< number of samples in recorded waveform
+} sim_kx132_t;
+
+
+extern const gpio_event_source_t sim_kx132_int1_source;     ///< INT1-PIN of the simulated KX132, context is the sim_kx132_t
+
+
+/**
+ * @brief Sets signal and time scale of the simulated KX132 and loads the recorded waveform.
+ * 
+ * @note Must be called before sim_kx132_init().
+ * 
+ * @param sim           pointer to simulated KX132 (zero-initialized)
+ * @param simConfig     pointer to struct containing signal and time scale
+ * @return true         if success
+ * @return false        if waveform could not be loaded
+ */
+bool sim_kx132_configure(sim_kx132_t *sim, sim_kx132_config_t *simConfig);
+
+
+/**
+ * @brief Powers up the simulated KX132 with default register values.
+ * 
+ * @param sim           pointer to simulated KX132
+ * @return true         if success
+ * @return false        if error
+ */
+bool sim_kx132_init(sim_kx132_t *sim);
+
+
+/**
+ * @brief Powers down the simulated KX132 and frees the recorded waveform.
+ * 
+ * @param sim           pointer to simulated KX132
+ */
+void sim_kx132_deinit(sim_kx132_t *sim);
+
+
+/**
+ * @brief Starts a new SPI transaction (chip-select asserted).
+ * 
+ *  Samples which became due since the last transaction are generated here, so reading behaves
+ *  like the real sensor running at the configured output data rate. Output registers don't change
+ *  during a transaction, like on the real sensor during a burst read.
+ * 
+ * @param sim           pointer to simulated KX132
+ */
+void sim_kx132_begin_transfer(sim_kx132_t *sim);
+
+
+/**
+ * @brief Reads one register of the simulated KX132.
+ * 
+ * @param sim           pointer to simulated KX132
+ * @param reg           source register
+ * @return uint8_t      register value
+ */
+uint8_t sim_kx132_read(sim_kx132_t *sim, kx132_reg_t reg);
+
+
+/**
+ * @brief Writes one register of the simulated KX132.
+ * 
+ * @param sim           pointer to simulated KX132
+ * @param reg           destination register
+ * @param data          byte for writing to register
+ */
+void sim_kx132_write(sim_kx132_t *sim, kx132_reg_t reg, uint8_t data);
+
+
+#endif //SIM_KX132_H
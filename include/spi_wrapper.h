@@ -15,43 +15,146 @@
 ///\cond
 #include <stdint.h>
 #include <stdbool.h>
+#include <pthread.h>
 ///\endcond
 
 #include <regs_kx132.h>
 
 
+#define SPI_DEVICE_PATH_LEN         32
+#define DEFAULT_SPIDEV_PATH         "/dev/spidev0.0"
+#define SPIDEV_PATH_FORMAT          "/dev/spidev%u.%u"  ///< bus, chip select
+#define SPI_MAX_BUSES               8               ///< bus numbers 0 - 7
+#define SPI_MAX_CHIP_SELECTS        2               ///< CS0 / CS1
+#define DEFAULT_SPI_CLOCK_HZ        10000000        ///< 400 MHz core_freq / divider 40
+
+#define SPI_BATCH_MAX_SEGMENTS      4               ///< max number of register accesses in one batch
+#define SPI_BATCH_MAX_BYTES         640             ///< max number of bytes (incl. address bytes) in one batch
+
+
+///< enum for SPI transport backend
+typedef enum{
+    spi_backend_bcm2835     = 0,                    ///< libbcm2835, direct register access on RaspberryPi
+    spi_backend_spidev      = 1,                    ///< Linux spidev through SPI_IOC_MESSAGE
+    spi_backend_sim         = 2,                    ///< in-process simulated KX132, no hardware needed
+} spi_backend_type_t;
+
+
+/// struct holding configuration of SPI-connection
+typedef struct{
+    spi_backend_type_t      backend;                            ///< bcm2835 / spidev / sim
+    char                    devicePath[SPI_DEVICE_PATH_LEN];    ///< path of spidev device, only used for spidev
+    uint32_t                clockHz;                            ///< SPI clock in Hz
+    bool                    autoClock;                          ///< clock is calibrated at startup, clockHz is used until then
+    uint8_t                 bus;                                ///< SPI bus, devices on the same bus are accessed one after another
+    uint8_t                 chipSelect;                         ///< chip select (CS0 / CS1)
+} spi_config_t;
+
+
+/// struct holding one segment of a batched transfer, every segment gets its own chip-select cycle
+typedef struct{
+    uint8_t*                buffer;                 ///< address byte + data, received bytes overwrite sent bytes
+    uint32_t                len;                    ///< number of bytes incl. address byte
+} spi_segment_t;
+
+
+typedef struct spi_device_s spi_device_t;
+
+
+/// struct holding the functions of a SPI transport backend
+typedef struct{
+    const char*             name;
+    bool                    (*init)             (spi_device_t *device);
+    void                    (*deinit)           (spi_device_t *device);
+    void                    (*transfer)         (spi_device_t *device, uint8_t *buffer, uint32_t len);                      ///< full duplex, received bytes overwrite sent bytes
+    void                    (*transfer_batch)   (spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments);  ///< executes all segments as one transaction
+    uint32_t                (*set_clock)        (spi_device_t *device, uint32_t clockHz);                                   ///< returns the clock actually used
+} spi_backend_t;
+
+
+/// struct holding one SPI bus, shared by all devices with the same bus number
+typedef struct{
+    pthread_mutex_t         lock;                   ///< held during every transaction, priority inheritance for real-time threads
+    uint8_t                 devices;                ///< number of initialized devices on bus
+} spi_bus_t;
+
+
+/// struct holding one device (sensor) on a SPI bus
+struct spi_device_s{
+    const spi_backend_t*    backend;                ///< selected in spi_init()
+    spi_config_t            config;                 ///< copy of config passed to spi_init()
+    spi_bus_t*              bus;
+    int                     fd;                     ///< spidev: file descriptor of device
+    uint32_t                clockDivider;           ///< bcm2835: divider of core clock
+    void*                   context;                ///< sim: simulated KX132 (sim_kx132_t), set before spi_init()
+};
+
+
+/// struct holding queued register accesses, executed together through spi_batch_execute()
+typedef struct{
+    spi_segment_t           segments        [SPI_BATCH_MAX_SEGMENTS];
+    uint8_t*                destinations    [SPI_BATCH_MAX_SEGMENTS];   ///< where read bytes are copied to, NULL for writes, inside the segment for frames
+    uint8_t                 commands        [SPI_BATCH_MAX_SEGMENTS][2];///< address byte (+ data byte of writes), restored after every execution
+    uint8_t                 frames          [SPI_BATCH_MAX_BYTES];      ///< storage for all segments
+    uint16_t                bytesUsed;
+    uint8_t                 numberOfSegments;
+} spi_batch_t;
+
+
+extern const spi_backend_t spi_backend_bcm2835_ops;     ///< spi_bcm2835.c
+extern const spi_backend_t spi_backend_spidev_ops;      ///< spi_spidev.c
+extern const spi_backend_t spi_backend_sim_ops;         ///< spi_sim.c
+
+
 /**
- * @brief Initiliazes the SPI-connection.
- *  
+ * @brief Initiliazes the SPI-connection to one device through configured backend.
+ * 
+ * @param device    pointer to device struct, context has to be set before for spi_backend_sim
+ * @param spiConfig pointer to struct containing backend, bus, chip select, device and clock
  * @return true     if success
  * @return false    if error
  */
-bool spi_init(void);
+bool spi_init(spi_device_t *device, spi_config_t *spiConfig);
 
 
 /**
- * @brief Closes the SPI-connection.
+ * @brief Closes the SPI-connection to one device.
  * 
+ * @param device    pointer to device
  */
-void spi_deinit(void);
+void spi_deinit(spi_device_t *device);
+
+
+/**
+ * @brief Changes the SPI clock of one device.
+ * 
+ *  The backend rounds to the next clock it supports, which is not faster than requested.
+ * 
+ * @param device    pointer to device
+ * @param clockHz   requested clock in Hz
+ * @return uint32_t clock actually used, also saved in device->config.clockHz
+ */
+uint32_t spi_set_clock(spi_device_t *device, uint32_t clockHz);
 
 
 /**
  * @brief Writes a single byte over SPI to a register.
  * 
+ * @param device    pointer to device
  * @param reg       destination register
  * @param data      byte for writing to register
  */
-void spi_write(kx132_reg_t reg, uint8_t data);
+void spi_write(spi_device_t *device, kx132_reg_t reg, uint8_t data);
 
 
 /**
  * @brief Reads a single byte over SPI from a register.
  * 
+ * @param device    pointer to device
  * @param reg       source register
- * @param data      pointer to buffer where read byte should be saved 
+ * @param data      pointer to buffer where read byte should be saved
  */
-void spi_read(kx132_reg_t reg, uint8_t* data);
+void spi_read(spi_device_t *device, kx132_reg_t reg, uint8_t* data);
 
 
 /**
@@ -59,11 +162,86 @@ void spi_read(kx132_reg_t reg, uint8_t* data);
  * 
  * @note Used for reading the Axis-Data-Outputs of the KX132.
  * 
+ * @param device    pointer to device
  * @param reg       first source register
  * @param data      pointer to buffer where read bytes should be saved
  * @param len       number of register to read
  */
-void spi_read_burst(kx132_reg_t reg, uint8_t* data, uint16_t len);
+void spi_read_burst(spi_device_t *device, kx132_reg_t reg, uint8_t* data, uint16_t len);
+
+
+/**
+ * @brief Reads n bytes over SPI through auto-increment straight into the caller's frame, nothing is copied.
+ * 
+ * @note Used for draining the sample buffer. frame[0] holds the address byte during the transfer,
+ *       read bytes are received in frame[1] - frame[len].
+ * 
+ * @param device    pointer to device
+ * @param reg       first source register
+ * @param frame     pointer to frame of len + 1 bytes
+ * @param len       number of register to read
+ */
+void spi_read_frame(spi_device_t *device, kx132_reg_t reg, uint8_t* frame, uint16_t len);
+
+
+/**
+ * @brief Removes all queued register accesses from a batch.
+ * 
+ * @param batch     pointer to batch
+ */
+void spi_batch_clear(spi_batch_t *batch);
+
+
+/**
+ * @brief Queues a read of n bytes through auto-increment, starting at provided register.
+ * 
+ * @param batch     pointer to batch
+ * @param reg       first source register
+ * @param data      pointer to buffer where read bytes should be saved after spi_batch_execute()
+ * @param len       number of register to read
+ * @return true     if queued
+ * @return false    if batch is full
+ */
+bool spi_batch_read(spi_batch_t *batch, kx132_reg_t reg, uint8_t* data, uint16_t len);
+
+
+/**
+ * @brief Queues a read of n bytes through auto-increment straight into the caller's frame, see spi_read_frame().
+ * 
+ *  The frame does not use storage of the batch and is not copied after spi_batch_execute().
+ * 
+ * @param batch     pointer to batch
+ * @param reg       first source register
+ * @param frame     pointer to frame of len + 1 bytes, read bytes are received in frame[1] - frame[len]
+ * @param len       number of register to read
+ * @return true     if queued
+ * @return false    if batch is full
+ */
+bool spi_batch_read_frame(spi_batch_t *batch, kx132_reg_t reg, uint8_t* frame, uint16_t len);
+
+
+/**
+ * @brief Queues a write of a single byte to a register.
+ * 
+ * @param batch     pointer to batch
+ * @param reg       destination register
+ * @param data      byte for writing to register
+ * @return true     if queued
+ * @return false    if batch is full
+ */
+bool spi_batch_write(spi_batch_t *batch, kx132_reg_t reg, uint8_t data);
+
+
+/**
+ * @brief Executes all queued register accesses as one multi-segment transaction.
+ * 
+ * @note spidev: one SPI_IOC_MESSAGE(n) ioctl. bcm2835: one transfer sequence without returning in between.
+ *       Queued accesses stay in the batch, so the same batch can be executed repeatedly.
+ * 
+ * @param device    pointer to device
+ * @param batch     pointer to batch
+ */
+void spi_batch_execute(spi_device_t *device, spi_batch_t *batch);
 
 
 #endif //SPI_WRAPPER
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file spsc_queue.h
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Header for spsc_queue.c
+ * 
+ *  function declarations and typedefs of a lock-free single-producer / single-consumer queue,
+ *  used for handing sample blocks from the acquisition thread to the threads processing them.
+ * 
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+///\endcond
+
+
+#define SPSC_CACHE_LINE         64                  ///< producer and consumer index live on separate cache lines
+
+
+/// struct holding a queue of fixed-size slots, written in place by one thread and read in place by another
+typedef struct{
+    uint8_t*                slots;                              ///< capacity * slotSize bytes
+    size_t                  slotSize;                           ///< rounded up to a multiple of SPSC_CACHE_LINE
+    uint32_t                capacity;                           ///< number of slots, power of two
+    uint32_t                modulo;                             ///< modulo-value for wrapping
+
+    _Alignas(SPSC_CACHE_LINE)
+    atomic_uint_fast32_t    head;                               ///< slots committed by producer, only written by producer
+    uint32_t                tailCache;                          ///< last tail seen by producer
+    atomic_bool             closed;                             ///< producer is done, consumer drains the remaining slots
+
+    _Alignas(SPSC_CACHE_LINE)
+    atomic_uint_fast32_t    tail;                               ///< slots released by consumer, only written by consumer
+    uint32_t                headCache;                          ///< last head seen by consumer
+} spsc_queue_t;
+
+
+/**
+ * @brief Allocates the slots of a queue and faults them in.
+ * 
+ * @param queue         pointer to queue
+ * @param capacity      number of slots, has to be power of two
+ * @param slotSize      size of one slot in bytes
+ * @return true         if success
+ * @return false        if capacity is not power of two or slots could not be allocated
+ */
+bool spsc_init(spsc_queue_t *queue, uint32_t capacity, size_t slotSize);
+
+
+/**
+ * @brief Frees the slots of a queue.
+ * 
+ * @param queue         pointer to queue
+ */
+void spsc_free(spsc_queue_t *queue);
+
+
+/**
+ * @brief Returns slot number index, regardless of its state. Used for setting up slots before the queue is used.
+ * 
+ * @param queue         pointer to queue
+ * @param index         number of slot (0 - capacity-1)
+ * @return void*        pointer to slot
+ */
+void *spsc_slot(spsc_queue_t *queue, uint32_t index);
+
+
+/**
+ * @brief Returns the next free slot to the producer, never blocks.
+ * 
+ * @param queue         pointer to queue
+ * @return void*        pointer to slot to be filled, NULL if the queue is full
+ */
+void *spsc_write_slot(spsc_queue_t *queue);
+
+
+/**
+ * @brief Hands the slot returned by spsc_write_slot() to the consumer.
+ * 
+ * @param queue         pointer to queue
+ */
+void spsc_commit_write(spsc_queue_t *queue);
+
+
+/**
+ * @brief Returns the oldest committed slot to the consumer, never blocks.
+ * 
+ * @param queue         pointer to queue
+ * @return void*        pointer to slot, NULL if the queue is empty
+ */
+void *spsc_read_slot(spsc_queue_t *queue);
+
+
+/**
+ * @brief Hands the slot returned by spsc_read_slot() back to the producer.
+ * 
+ * @param queue         pointer to queue
+ */
+void spsc_commit_read(spsc_queue_t *queue);
+
+
+/**
+ * @brief Waits until a slot is committed or the queue is closed and empty.
+ * 
+ *  Consumer side only, sleeps pollNs between checks, the producer never has to wake anyone.
+ * 
+ * @param queue         pointer to queue
+ * @param pollNs        time between two checks in nanoseconds
+ * @return void*        pointer to slot, NULL if the queue is closed and drained
+ */
+void *spsc_wait_slot(spsc_queue_t *queue, uint64_t pollNs);
+
+
+/**
+ * @brief Returns the number of committed slots not yet released by the consumer.
+ * 
+ * @param queue         pointer to queue
+ * @return uint32_t     number of slots in use
+ */
+uint32_t spsc_count(spsc_queue_t *queue);
+
+
+/**
+ * @brief Marks the queue as closed, called by the producer after its last commit.
+ * 
+ * @param queue         pointer to queue
+ */
+void spsc_close(spsc_queue_t *queue);
+
+
+#endif //SPSC_QUEUE_H
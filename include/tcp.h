@@ -12,6 +12,7 @@
 #ifndef TCP_H
 #define TCP_H
 
+#define TCP_ENVELOPE_FLAG   0x80    ///< set in sensor id of envelope packets, first byte of trigger packets is the plain sensor id
 
 
 /**
@@ -35,26 +36,128 @@ void tcp_server_close(void);
 
 
 /**
- * @brief Sends an array of formatted axes-data over TCP to client.
+ * @brief Sends sensor id and an array of formatted axes-data over TCP to client.
  * 
- * @note used for streaming mode
+ * @note used for streaming mode, safe to call from the threads of several sensors
  * @attention Originally this was sending the whole array directly. This however often lead to shifting of data inside the array. Sending the data seperately prevents this.
  * 
+ * @param sensorId          id of sensor the sample was read from
  * @param xyzFormatted      pointer to array holding signed 16-Bit axis values
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
  */
-void tcp_send(int16_t* xyzFormatted);
+void tcp_send(uint8_t sensorId, int16_t* xyzFormatted, uint64_t timestamp);
 
 
 /**
- * @brief Sends normalized axis data, size of read samples, trigger index and array of formatted axes-data over TCP to client.
+ * @brief Sends sensor id, normalized axis data, size of read samples, trigger index, output data rate and array of formatted axes-data over TCP to client.
  * 
- * @note used for trigger mode
+ * @note used for trigger mode, the buffer of one sensor is not interleaved with data of other sensors
  * 
+ * @param sensorId          id of sensor the buffer was read from
  * @param xyzFormatted      pointer to array holding arrays of signed 16-Bit axis values
- * @param triggerInfo       pointer to struct holding info about number of samples and trigger index
+ * @param timestamps        pointer to array holding timestamp of every sample in nanoseconds
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
  * @param normalizedData    pointer to array hlding normalized axes data
  */
-void tcp_send_trig_buffer(int16_t **xyzFormatted, trigger_info_t *triggerInfo, int16_t *normalizedData);
+void tcp_send_trig_buffer(uint8_t sensorId, int16_t **xyzFormatted, uint64_t *timestamps, trigger_info_t *triggerInfo, int16_t *normalizedData);
+
+
+/**
+ * @brief Sends sensor id, 8-Bit axes-data and timestamp of one sample over TCP to client.
+ * 
+ * @note used in 8-Bit resolution, 12 instead of 15 bytes per sample
+ * 
+ * @param sensorId          id of sensor the sample was read from
+ * @param xyzCompact        pointer to array holding signed 8-Bit axis values (high bytes)
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
+ */
+void tcp_send_8(uint8_t sensorId, int8_t* xyzCompact, uint64_t timestamp);
+
+
+/**
+ * @brief Same as tcp_send_trig_buffer() for 8-Bit resolution, normalized data is sent in 8-Bit scale.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param xyzCompact        pointer to array holding arrays of signed 8-Bit axis values
+ * @param timestamps        pointer to array holding timestamp of every sample in nanoseconds
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
+ * @param normalizedData    pointer to array holding normalized axes data (16-Bit scale)
+ */
+void tcp_send_trig_buffer_8(uint8_t sensorId, int8_t **xyzCompact, uint64_t *timestamps, trigger_info_t *triggerInfo, int16_t *normalizedData);
+
+
+/**
+ * @brief Sends sensor id, axes-data in physical units and timestamp of one sample over TCP to client.
+ * 
+ * @note used, if the stream is configured in g or m/s², 3 float32 instead of 3 int16_t per sample
+ * 
+ * @param sensorId          id of sensor the sample was read from
+ * @param xyzUnit           pointer to array holding float axis values
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
+ */
+void tcp_send_float(uint8_t sensorId, float* xyzUnit, uint64_t timestamp);
+
+
+/**
+ * @brief Same as tcp_send_trig_buffer() in physical units, normalized data and samples are sent as float32.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param xyzUnit           pointer to array holding arrays of float axis values
+ * @param timestamps        pointer to array holding timestamp of every sample in nanoseconds
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
+ * @param normalizedData    pointer to array holding normalized axes data in the unit of the samples
+ */
+void tcp_send_trig_buffer_float(uint8_t sensorId, float **xyzUnit, uint64_t *timestamps, trigger_info_t *triggerInfo, float *normalizedData);
+
+
+/**
+ * @brief Same as tcp_send_trig_buffer() / tcp_send_trig_buffer_8(), samples are sent straight from a view of the ringbuffers.
+ * 
+ *  Older samples held by a compressed ring are decoded block by block and sent first.
+ * 
+ * @note no copy of the window is made, the views have to stay taken until the function returns
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param rb                pointer to ringbuffer of the axes, 16-Bit or 8-Bit values
+ * @param rbTs              pointer to ringbuffer of timestamps
+ * @param view              pointer to view of window
+ * @param pack              pointer to compressed ring, NULL if the window is held by the ringbuffers only
+ * @param packView          pointer to view of older part of window in compressed ring, only used with pack
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
+ * @param normalizedData    pointer to array holding normalized axes data (16-Bit scale)
+ */
+void tcp_send_trig_view(uint8_t sensorId, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, rb_pack_t *pack, rb_pack_view_t *packView, trigger_info_t *triggerInfo, int16_t *normalizedData);
+
+
+/**
+ * @brief Same as tcp_send_trig_buffer_float(), the window is converted from a view of the ringbuffers while it is sent.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param rb                pointer to ringbuffer of the axes, 16-Bit or 8-Bit values
+ * @param rbTs              pointer to ringbuffer of timestamps
+ * @param view              pointer to view of window
+ * @param pack              pointer to compressed ring, NULL if the window is held by the ringbuffers only
+ * @param packView          pointer to view of older part of window in compressed ring, only used with pack
+ * @param scale             unit per count in 16-Bit scale
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
+ * @param normalizedData    pointer to array holding normalized axes data in the unit of the samples
+ */
+void tcp_send_trig_view_float(uint8_t sensorId, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, rb_pack_t *pack, rb_pack_view_t *packView, float scale, trigger_info_t *triggerInfo, float *normalizedData);
+
+
+/**
+ * @brief Sends envelopes of the history requested by the client.
+ * 
+ *  sensor id | TCP_ENVELOPE_FLAG (uint8), level (uint8), samples per envelope (uint32), number of envelopes (uint32),
+ *  unit per count (float, 1 for counts), then every envelope as rb_envelope_t (32 bytes), oldest first.
+ * 
+ * @param sensorId          id of sensor the envelopes were taken from
+ * @param level             level of pyramid, 0 for envelopes of 16 samples
+ * @param envelopes         pointer to array of envelopes
+ * @param numberOfEntries   number of envelopes
+ * @param scale             unit per count of the values
+ */
+void tcp_send_envelopes(uint8_t sensorId, uint8_t level, rb_envelope_t *envelopes, uint32_t numberOfEntries, float scale);
 
 
 /**
@@ -0,0 +1,123 @@
+/**
+ * @file timestamp.h
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Header for timestamp.c
+ * 
+ *  function declarations and typedefs needed for timestamping samples and estimating the
+ *  real output data rate of the KX132.
+ * 
+ */
+
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+///\endcond
+
+
+#define DEFAULT_TS_BANDWIDTH_HZ     0.5     ///< bandwidth of drift-tracking loop, lower is smoother but locks slower
+#define TS_RESYNC_PERIODS           256     ///< estimate is re-anchored, if a read is off by more than this many periods
+#define TS_LOCK_UPDATES             64      ///< estimate counts as locked after this many updates without re-anchoring
+
+
+/// struct holding the state of the drift-tracking estimator (second order delay-locked loop)
+typedef struct{
+    double                  nominalPeriodNs;        ///< sample period based on configured output data rate
+    double                  periodNs;               ///< estimated sample period
+    double                  lastSampleNs;           ///< estimated CLOCK_MONOTONIC time of newest sample
+    double                  bandwidthHz;            ///< bandwidth of loop filter
+    uint64_t                samples;                ///< samples timestamped since start
+    uint32_t                updates;                ///< updates since start / last re-anchoring
+    uint32_t                resyncs;                ///< number of times the estimate was re-anchored
+    bool                    started;                ///< false until first update
+} ts_estimator_t;
+
+
+/**
+ * @brief Returns the current time of CLOCK_MONOTONIC.
+ * 
+ * @return uint64_t         time in nanoseconds
+ */
+uint64_t ts_now_ns(void);
+
+
+/**
+ * @brief Initializes the estimator with the configured output data rate.
+ * 
+ * @param estimator         pointer to estimator
+ * @param nominalRateHz     configured output data rate
+ * @param bandwidthHz       bandwidth of loop filter
+ */
+void ts_init(ts_estimator_t *estimator, double nominalRateHz, double bandwidthHz);
+
+
+/**
+ * @brief Re-anchors the estimate at the next update, keeps the estimated period.
+ * 
+ *  Used after the reading loop paused on purpose, the next block is not counted as lost samples.
+ * 
+ * @param estimator         pointer to estimator
+ */
+void ts_restart(ts_estimator_t *estimator);
+
+
+/**
+ * @brief Updates the estimate with a block of samples and reconstructs a timestamp for every sample.
+ * 
+ *  The newest sample of the block is assumed to be produced shortly before readTimeNs.
+ *  Jitter of readTimeNs is filtered, samples inside the block are spaced by the estimated period.
+ * 
+ * @param estimator         pointer to estimator
+ * @param readTimeNs        CLOCK_MONOTONIC time when the block was read
+ * @param numberOfSamples   number of samples in block
+ * @param missingSamples    samples lost right before the block, timeline advances without timestamping them
+ * @param timestamps        pointer to array where timestamps should be saved (numberOfSamples), may be NULL
+ */
+void ts_update(ts_estimator_t *estimator, uint64_t readTimeNs, uint16_t numberOfSamples, uint32_t missingSamples, uint64_t *timestamps);
+
+
+/**
+ * @brief Estimates how many samples were produced but not read before a block.
+ * 
+ *  Compares the time since the newest timestamped sample with the estimated period.
+ * 
+ * @param estimator         pointer to estimator
+ * @param readTimeNs        CLOCK_MONOTONIC time when the block was read
+ * @param numberOfSamples   number of samples in block
+ * @return uint32_t         number of missing samples, 0 before the first update
+ */
+uint32_t ts_missing_samples(ts_estimator_t *estimator, uint64_t readTimeNs, uint16_t numberOfSamples);
+
+
+/**
+ * @brief Returns the estimated output data rate.
+ * 
+ * @param estimator         pointer to estimator
+ * @return double           output data rate in Hz
+ */
+double ts_rate_hz(ts_estimator_t *estimator);
+
+
+/**
+ * @brief Checks if the estimate has settled.
+ * 
+ * @param estimator         pointer to estimator
+ * @return true             if locked
+ * @return false            if still settling
+ */
+bool ts_locked(ts_estimator_t *estimator);
+
+
+/**
+ * @brief Prints estimated and nominal output data rate.
+ * 
+ * @param estimator         pointer to estimator
+ */
+void ts_print(ts_estimator_t *estimator);
+
+
+#endif //TIMESTAMP_H
\ No newline at end of file
@@ -12,6 +12,21 @@
 #ifndef HELPER_H
 #define HELPER_H
 
+///\cond
+#include <stdint.h>
+#include <stdbool.h>
+///\endcond
+
+
+/// implementations of the block decoder and unit conversion, convertRawBlock() etc. use the fastest one supported
+typedef enum{
+    decode_scalar       = 0,            ///< portable loop, also decodes the samples left over by the SIMD kernels
+    decode_neon         = 1,            ///< ARM NEON (vld3)
+    decode_ssse3        = 2,            ///< x86 SSSE3 (pshufb)
+    decode_avx2         = 3,            ///< x86 AVX2, two SSSE3 shuffles per instruction
+    NUMBER_OF_DECODE_IMPLS
+} decode_impl_t;
+
 
 /**
  * @brief Converts low + high 8-Bit values to one signed 16-Bit value
@@ -32,5 +47,141 @@ int16_t convertRaw(uint8_t lowVal, uint8_t highVal);
 void convertRawArray(uint8_t* xyzRawData, int16_t* data);
 
 
+/**
+ * @brief Converts an array consisting of 8-Bit raw data (high bytes only) to array of signed 16-Bit values
+ * 
+ *  Values are shifted to the same scale as 16-Bit samples, so thresholds don't depend on resolution.
+ * 
+ * @param xyzRawData    pointer to array holding raw data (high)
+ * @param data          pointer to array where signed 16-Bit values should be saved
+ */
+void convertRawArray8(uint8_t* xyzRawData, int16_t* data);
+
+
+/**
+ * @brief Converts a block of raw samples (low + high) to one array of signed 16-Bit values per axis.
+ * 
+ * @param xyzRawData        pointer to raw samples, NUMBER_OF_CHANNELS bytes each
+ * @param numberOfSamples   number of samples in block
+ * @param xData             pointer to array where X values should be saved (numberOfSamples)
+ * @param yData             pointer to array where Y values should be saved (numberOfSamples)
+ * @param zData             pointer to array where Z values should be saved (numberOfSamples)
+ */
+void convertRawBlock(const uint8_t* xyzRawData, uint32_t numberOfSamples, int16_t* xData, int16_t* yData, int16_t* zData);
+
+
+/**
+ * @brief Splits a block of 8-Bit raw samples (high bytes only) into one array per axis.
+ * 
+ *  Values keep the 8-Bit scale, as stored by a ringbuffer_xyz_t of 8-Bit values.
+ * 
+ * @param xyzRawData        pointer to raw samples, NUMBER_OF_CHANNELS_8BIT bytes each
+ * @param numberOfSamples   number of samples in block
+ * @param xData             pointer to array where X values should be saved (numberOfSamples)
+ * @param yData             pointer to array where Y values should be saved (numberOfSamples)
+ * @param zData             pointer to array where Z values should be saved (numberOfSamples)
+ */
+void convertRawBlock8(const uint8_t* xyzRawData, uint32_t numberOfSamples, int8_t* xData, int8_t* yData, int8_t* zData);
+
+
+/**
+ * @brief Same as convertRawBlock(), but with a given implementation (falls back to scalar, if not supported).
+ * 
+ * @param impl              implementation of the decoder
+ * @param xyzRawData        pointer to raw samples, NUMBER_OF_CHANNELS bytes each
+ * @param numberOfSamples   number of samples in block
+ * @param xData             pointer to array where X values should be saved (numberOfSamples)
+ * @param yData             pointer to array where Y values should be saved (numberOfSamples)
+ * @param zData             pointer to array where Z values should be saved (numberOfSamples)
+ */
+void convertRawBlockImpl(decode_impl_t impl, const uint8_t* xyzRawData, uint32_t numberOfSamples, int16_t* xData, int16_t* yData, int16_t* zData);
+
+
+/**
+ * @brief Same as convertRawBlock8(), but with a given implementation (falls back to scalar, if not supported).
+ * 
+ * @param impl              implementation of the decoder
+ * @param xyzRawData        pointer to raw samples, NUMBER_OF_CHANNELS_8BIT bytes each
+ * @param numberOfSamples   number of samples in block
+ * @param xData             pointer to array where X values should be saved (numberOfSamples)
+ * @param yData             pointer to array where Y values should be saved (numberOfSamples)
+ * @param zData             pointer to array where Z values should be saved (numberOfSamples)
+ */
+void convertRawBlock8Impl(decode_impl_t impl, const uint8_t* xyzRawData, uint32_t numberOfSamples, int8_t* xData, int8_t* yData, int8_t* zData);
+
+
+/**
+ * @brief Scales a block of 16-Bit counts to physical units.
+ * 
+ * @param counts            pointer to counts
+ * @param numberOfValues    number of counts
+ * @param scale             unit per count (e.g. g per count of the configured g-range)
+ * @param values            pointer to array where scaled values should be saved (numberOfValues)
+ */
+void convertCountsToUnit(const int16_t* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales a block of 8-Bit counts (high bytes) to physical units.
+ * 
+ * @param counts            pointer to counts
+ * @param numberOfValues    number of counts
+ * @param scale             unit per 8-Bit count, 256 times the scale of 16-Bit counts
+ * @param values            pointer to array where scaled values should be saved (numberOfValues)
+ */
+void convertCounts8ToUnit(const int8_t* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Same as convertCountsToUnit(), but with a given implementation (falls back to scalar, if not supported).
+ * 
+ * @param impl              implementation of the conversion
+ * @param counts            pointer to counts
+ * @param numberOfValues    number of counts
+ * @param scale             unit per count
+ * @param values            pointer to array where scaled values should be saved (numberOfValues)
+ */
+void convertCountsToUnitImpl(decode_impl_t impl, const int16_t* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Same as convertCounts8ToUnit(), but with a given implementation (falls back to scalar, if not supported).
+ * 
+ * @param impl              implementation of the conversion
+ * @param counts            pointer to counts
+ * @param numberOfValues    number of counts
+ * @param scale             unit per 8-Bit count
+ * @param values            pointer to array where scaled values should be saved (numberOfValues)
+ */
+void convertCounts8ToUnitImpl(decode_impl_t impl, const int8_t* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Checks if an implementation of the decoder was compiled in and is supported by the CPU.
+ * 
+ * @param impl          implementation of the decoder
+ * @return true         if supported
+ * @return false        if not
+ */
+bool decodeImplSupported(decode_impl_t impl);
+
+
+/**
+ * @brief Returns the fastest implementation of the decoder supported by the CPU.
+ * 
+ * @return decode_impl_t    implementation of the decoder
+ */
+decode_impl_t decodeImplBest(void);
+
+
+/**
+ * @brief Returns the name of an implementation of the decoder.
+ * 
+ * @param impl          implementation of the decoder
+ * @return const char*  name (e.g. "avx2")
+ */
+const char* decodeImplName(decode_impl_t impl);
+
+
 
 #endif // HELPER_H
\ No newline at end of file
@@ -0,0 +1,239 @@
+/**
+ * @file bench_decode.c
+ * @author awa
+ * @date 17-10-2026
+ *
+ * @brief Microbenchmark of the block decoder and unit conversion (utility.c)
+ *
+ *  Checks every implementation supported by the CPU against the scalar loop, then decodes full
+ *  KX132 sample buffers (16-Bit and 8-Bit) for BENCH_TIME_NS each and prints samples per second.
+ *  Conversion to g is measured the same way, per axis.
+ *  Built with "make bench", not part of kx132.
+ *
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+///\endcond
+
+#include <utility.h>
+#include <macros_kx132.h>
+#include <config_kx132.h>
+#include <timestamp.h>
+
+
+#define BENCH_TIME_NS           500000000   ///< time per implementation and resolution
+#define BENCH_BLOCKS            1000        ///< blocks decoded between two reads of the clock
+#define BENCH_CHECK_SAMPLES     1000        ///< odd sizes up to this are compared against the scalar loop
+
+
+static uint8_t  rawData     [BENCH_CHECK_SAMPLES * NUMBER_OF_CHANNELS];
+static int16_t  xyzData     [NUMBER_OF_AXES][BENCH_CHECK_SAMPLES];
+static int16_t  xyzRef      [NUMBER_OF_AXES][BENCH_CHECK_SAMPLES];
+static int8_t   xyzData8    [NUMBER_OF_AXES][BENCH_CHECK_SAMPLES];
+static int8_t   xyzRef8     [NUMBER_OF_AXES][BENCH_CHECK_SAMPLES];
+static float    unitData    [BENCH_CHECK_SAMPLES];
+static float    unitRef     [BENCH_CHECK_SAMPLES];
+
+static const float benchScale = 1.0 / 4096;         ///< g per count at 8 g
+
+
+/**
+ * @brief Decodes every block size up to BENCH_CHECK_SAMPLES with an implementation and the scalar loop.
+ *
+ * @param impl          implementation of the decoder
+ * @return true         if results are identical
+ * @return false        if not
+ */
+static bool bench_check(decode_impl_t impl);
+
+
+/**
+ * @brief Decodes full sample buffers for BENCH_TIME_NS.
+ *
+ * @param impl              implementation of the decoder
+ * @param compact           8-Bit samples if true
+ * @return double           decoded samples per second
+ */
+static double bench_run(decode_impl_t impl, bool compact);
+
+
+/**
+ * @brief Scales every block size up to BENCH_CHECK_SAMPLES with an implementation and the scalar loop.
+ *
+ * @param impl          implementation of the conversion
+ * @return true         if results are identical
+ * @return false        if not
+ */
+static bool bench_check_units(decode_impl_t impl);
+
+
+/**
+ * @brief Scales one axis of full sample buffers to g for BENCH_TIME_NS.
+ *
+ * @param impl              implementation of the conversion
+ * @param compact           8-Bit counts if true
+ * @return double           scaled values per second
+ */
+static double bench_run_units(decode_impl_t impl, bool compact);
+
+
+int main(void){
+
+    bool ok = true;
+
+    srand(1);
+    for(uint32_t i = 0; i < sizeof(rawData); i++){
+        rawData[i] = (uint8_t) rand();
+    }
+
+    printf("[bench] Block decoder, %u samples (16-Bit) / %u samples (8-Bit) per block, best: %s\n",
+            KX132_BUF_MAX_SAMPLES,
+            KX132_BUF_MAX_SAMPLES_8BIT,
+            decodeImplName(decodeImplBest()));
+
+    for(decode_impl_t impl = decode_scalar; impl < NUMBER_OF_DECODE_IMPLS; impl++){
+
+        if(!decodeImplSupported(impl)){
+            printf("[bench] %-8s not supported\n", decodeImplName(impl));
+            continue;
+        }
+
+        if(!bench_check(impl)){
+            ok = false;
+            continue;
+        }
+
+        printf("[bench] %-8s 16-Bit: %8.1f Msamples/s    8-Bit: %8.1f Msamples/s\n",
+                decodeImplName(impl),
+                bench_run(impl, false) / 1e6,
+                bench_run(impl, true) / 1e6);
+    }
+
+    printf("[bench] Conversion to g, one axis per block\n");
+
+    for(decode_impl_t impl = decode_scalar; impl < NUMBER_OF_DECODE_IMPLS; impl++){
+
+        if(!decodeImplSupported(impl)){
+            continue;
+        }
+
+        if(!bench_check_units(impl)){
+            ok = false;
+            continue;
+        }
+
+        printf("[bench] %-8s 16-Bit: %8.1f Mvalues/s     8-Bit: %8.1f Mvalues/s\n",
+                decodeImplName(impl),
+                bench_run_units(impl, false) / 1e6,
+                bench_run_units(impl, true) / 1e6);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+static bool bench_check(decode_impl_t impl){
+
+    for(uint32_t n = 0; n <= BENCH_CHECK_SAMPLES; n++){
+
+        convertRawBlockImpl(decode_scalar, rawData, n, xyzRef[X_INDEX], xyzRef[Y_INDEX], xyzRef[Z_INDEX]);
+        convertRawBlockImpl(impl, rawData, n, xyzData[X_INDEX], xyzData[Y_INDEX], xyzData[Z_INDEX]);
+
+        convertRawBlock8Impl(decode_scalar, rawData, n, xyzRef8[X_INDEX], xyzRef8[Y_INDEX], xyzRef8[Z_INDEX]);
+        convertRawBlock8Impl(impl, rawData, n, xyzData8[X_INDEX], xyzData8[Y_INDEX], xyzData8[Z_INDEX]);
+
+        for(uint8_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            if(memcmp(xyzRef[axis], xyzData[axis], n * sizeof(int16_t)) != 0 ||
+               memcmp(xyzRef8[axis], xyzData8[axis], n * sizeof(int8_t)) != 0){
+                printf("[bench][error] %s differs from scalar decoder (%u samples, axis %u)\n", decodeImplName(impl), n, axis);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static double bench_run(decode_impl_t impl, bool compact){
+
+    uint32_t    samplesPerBlock = compact ? KX132_BUF_MAX_SAMPLES_8BIT : KX132_BUF_MAX_SAMPLES;
+    uint64_t    samples         = 0;
+    uint64_t    startNs         = ts_now_ns();
+    uint64_t    elapsedNs       = 0;
+
+    do{
+        for(uint32_t block = 0; block < BENCH_BLOCKS; block++){
+            if(compact){
+                convertRawBlock8Impl(impl, rawData, samplesPerBlock, xyzData8[X_INDEX], xyzData8[Y_INDEX], xyzData8[Z_INDEX]);
+            }
+            else{
+                convertRawBlockImpl(impl, rawData, samplesPerBlock, xyzData[X_INDEX], xyzData[Y_INDEX], xyzData[Z_INDEX]);
+            }
+            // keeps the compiler from dropping blocks whose result is never read
+            __asm__ volatile("" : : "r"(xyzData), "r"(xyzData8) : "memory");
+        }
+        samples    += (uint64_t) BENCH_BLOCKS * samplesPerBlock;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static bool bench_check_units(decode_impl_t impl){
+
+    const int16_t*  counts  = (const int16_t*) rawData;
+    const int8_t*   counts8 = (const int8_t*) rawData;
+
+    for(uint32_t n = 0; n <= BENCH_CHECK_SAMPLES; n++){
+
+        convertCountsToUnitImpl(decode_scalar, counts, n, benchScale, unitRef);
+        convertCountsToUnitImpl(impl, counts, n, benchScale, unitData);
+
+        if(memcmp(unitRef, unitData, n * sizeof(float)) != 0){
+            printf("[bench][error] %s differs from scalar conversion (%u 16-Bit counts)\n", decodeImplName(impl), n);
+            return false;
+        }
+
+        convertCounts8ToUnitImpl(decode_scalar, counts8, n, benchScale * 256, unitRef);
+        convertCounts8ToUnitImpl(impl, counts8, n, benchScale * 256, unitData);
+
+        if(memcmp(unitRef, unitData, n * sizeof(float)) != 0){
+            printf("[bench][error] %s differs from scalar conversion (%u 8-Bit counts)\n", decodeImplName(impl), n);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static double bench_run_units(decode_impl_t impl, bool compact){
+
+    uint32_t    valuesPerBlock  = compact ? KX132_BUF_MAX_SAMPLES_8BIT : KX132_BUF_MAX_SAMPLES;
+    uint64_t    values          = 0;
+    uint64_t    startNs         = ts_now_ns();
+    uint64_t    elapsedNs       = 0;
+
+    do{
+        for(uint32_t block = 0; block < BENCH_BLOCKS; block++){
+            if(compact){
+                convertCounts8ToUnitImpl(impl, (const int8_t*) rawData, valuesPerBlock, benchScale * 256, unitData);
+            }
+            else{
+                convertCountsToUnitImpl(impl, (const int16_t*) rawData, valuesPerBlock, benchScale, unitData);
+            }
+            __asm__ volatile("" : : "r"(unitData) : "memory");
+        }
+        values     += (uint64_t) BENCH_BLOCKS * valuesPerBlock;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return values * 1e9 / elapsedNs;
+}
@@ -0,0 +1,696 @@
+/**
+ * @file bench_ringbuffer.c
+ * @author awa
+ * @date 17-10-2026
+ *
+ * @brief Microbenchmark of the ringbuffers of the axes (ringbuffer.c)
+ *
+ *  Compares 3 ringbuffer_t (rb_push() per value, bench_legacy_push_raw(), rb_read_chunk() per axis) with
+ *  ringbuffer_xyz_t in all layouts (rb_push_block(), rb_push_raw_block(), rb_read_block()).
+ *  Envelopes (rb_pyramid_push()) are checked against a direct computation and measured on top of rb_push_raw_block().
+ *  The compressed ring (rb_pack_push()) is fed a noisy sine with jittered timestamps, since random data does not compress,
+ *  and its windows are checked against the ringbuffer packed from.
+ *  All variants are checked against each other first, every measurement runs for BENCH_TIME_NS
+ *  on a buffer of DEFAULT_BUFFER_SIZE samples, so the buffers do not fit into any cache.
+ *  Built with "make bench", not part of kx132.
+ *
+ */
+
+///\cond
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+///\endcond
+
+#include <ringbuffer.h>
+#include <utility.h>
+#include <macros_kx132.h>
+#include <config_kx132.h>
+#include <timestamp.h>
+
+
+#define BENCH_TIME_NS           500000000           ///< time per measurement
+#define BENCH_BUFFER_SIZE       BUFFER_SIZE_2048_KB ///< samples per axis, same as DEFAULT_BUFFER_SIZE of kx132
+#define BENCH_BLOCK_SAMPLES     KX132_BUF_MAX_SAMPLES
+#define BENCH_WINDOW_SAMPLES    64000               ///< 2.5 s at 25.6 kHz
+#define BENCH_CHECK_WINDOWS     1000                ///< random windows compared between all variants
+#define BENCH_PACK_SIZE         (4 << 20)           ///< bytes of compressed ring, holds less than the ringbuffer, so all of it can be checked
+#define BENCH_PACK_SIGNAL       65536               ///< samples of the synthetic signal, pushed over and over
+#define BENCH_PACK_PERIOD_NS    39062               ///< 25.6 kHz
+
+
+/// variants of ringbuffer measured
+typedef enum{
+    bench_legacy        = 0,    ///< 3 ringbuffer_t
+    bench_soa           = 1,    ///< ringbuffer_xyz_t, rb_layout_soa
+    bench_interleaved   = 2,    ///< ringbuffer_xyz_t, rb_layout_interleaved
+    bench_mirrored      = 3,    ///< ringbuffer_xyz_t, rb_layout_mirrored
+    NUMBER_OF_BENCH_VARIANTS
+} bench_variant_t;
+
+
+static const char* variantNames [NUMBER_OF_BENCH_VARIANTS] = {"3 x rb", "soa", "block", "mirror"};
+static const rb_layout_t variantLayouts [NUMBER_OF_BENCH_VARIANTS] = {rb_layout_soa, rb_layout_soa, rb_layout_interleaved, rb_layout_mirrored};
+
+static ringbuffer_t     legacyRingbuffer    [NUMBER_OF_AXES];
+static ringbuffer_xyz_t xyzRingbuffer       [NUMBER_OF_BENCH_VARIANTS];     ///< index bench_legacy unused
+
+static uint8_t          rawData             [BENCH_BLOCK_SAMPLES * NUMBER_OF_CHANNELS];
+static int16_t          xyzBlock            [NUMBER_OF_AXES][BENCH_BLOCK_SAMPLES];
+static int16_t          xyzWindow           [NUMBER_OF_AXES][BENCH_WINDOW_SAMPLES];
+static int16_t          xyzWindowRef        [NUMBER_OF_AXES][BENCH_WINDOW_SAMPLES];
+static ringbuffer_ts_t  timestampRingbuffer;                                ///< timestamps of the pyramids, all 0
+static uint64_t         timestamps          [BENCH_BLOCK_SAMPLES];
+static rb_pyramid_t     pyramid             [NUMBER_OF_BENCH_VARIANTS];     ///< index bench_legacy unused
+static rb_pack_t        pack;                                               ///< packed from the soa ringbuffer
+static int16_t          packSignal          [NUMBER_OF_AXES][BENCH_PACK_SIGNAL];
+static int32_t          packJitter          [BENCH_PACK_SIGNAL];
+static uint64_t         packTimestamp;                                      ///< timestamp of the next sample pushed
+static uint64_t         windowTimestamps    [BENCH_WINDOW_SAMPLES];
+
+
+/**
+ * @brief Allocates and prefaults the ringbuffers of all variants.
+ *
+ * @return true         if success
+ * @return false        if memory could not be allocated
+ */
+static bool bench_init(void);
+
+
+/**
+ * @brief Pushes the same blocks into all variants and compares random windows read back.
+ *
+ * @return true         if all variants return identical windows
+ * @return false        if not
+ */
+static bool bench_check(void);
+
+
+/**
+ * @brief Pushes blocks for BENCH_TIME_NS.
+ *
+ * @param variant           ringbuffer measured
+ * @param raw               raw samples decoded by the ringbuffer if true, decoded blocks pushed if false
+ * @return double           samples (all axes) per second
+ */
+static double bench_push(bench_variant_t variant, bool raw);
+
+
+/**
+ * @brief Reads windows starting at pseudo random positions for BENCH_TIME_NS.
+ *
+ * @param variant           ringbuffer measured
+ * @return double           samples (all axes) per second
+ */
+static double bench_read(bench_variant_t variant);
+
+
+/**
+ * @brief Reads every sample back one by one for BENCH_TIME_NS, the access pattern of trigger detection.
+ *
+ * @param variant           ringbuffer measured
+ * @return double           samples (all axes) per second
+ */
+static double bench_sample(bench_variant_t variant);
+
+
+/**
+ * @brief Reads one window of all axes.
+ *
+ * @param variant           ringbuffer read
+ * @param triggerInfo       borders of window
+ * @param xyzOut            pointer to 3 buffers of BENCH_WINDOW_SAMPLES values
+ */
+static void bench_read_window(bench_variant_t variant, trigger_info_t *triggerInfo, int16_t (*xyzOut)[BENCH_WINDOW_SAMPLES]);
+
+
+/**
+ * @brief Converts a block of raw samples straight into the slots of the 3 legacy ringbuffers.
+ *
+ * @param rb                pointer to array of 3 ringbuffers, pushed together only, so their indices stay the same
+ * @param xyzRawData        pointer to raw samples (low + high), NUMBER_OF_CHANNELS bytes each
+ * @param numberOfSamples   number of samples in block
+ * @return                  local index of first sample, same as rb_push()
+ */
+static uint32_t bench_legacy_push_raw(ringbuffer_t *rb, const uint8_t *xyzRawData, uint32_t numberOfSamples);
+
+
+/**
+ * @brief Compares the newest envelope of every level with one computed from the samples of the legacy ringbuffers.
+ *
+ * @param variant           ringbuffer, its pyramid was pushed with the same samples as the legacy ringbuffers
+ * @return true             if all levels match
+ * @return false            if not
+ */
+static bool bench_check_pyramid(bench_variant_t variant);
+
+
+/**
+ * @brief Pushes raw blocks and adds them to the envelopes for BENCH_TIME_NS.
+ *
+ * @param variant           ringbuffer measured
+ * @return double           samples (all axes) per second
+ */
+static double bench_pyramid(bench_variant_t variant);
+
+
+/**
+ * @brief Pushes the synthetic signal into the soa ringbuffer and packs it for BENCH_TIME_NS.
+ * 
+ * @return double           samples (all axes) per second
+ */
+static double bench_pack_push(void);
+
+
+/**
+ * @brief Compares windows of the compressed ring with the same samples read from the soa ringbuffer.
+ * 
+ * @return true             if all samples and timestamps match
+ * @return false            if not
+ */
+static bool bench_check_pack(void);
+
+
+/**
+ * @brief Decodes windows of the compressed ring for BENCH_TIME_NS.
+ * 
+ * @return double           samples (all axes) per second
+ */
+static double bench_pack_read(void);
+
+
+int main(void){
+
+    srand(1);
+    for(uint32_t i = 0; i < sizeof(rawData); i++){
+        rawData[i] = (uint8_t) rand();
+    }
+    convertRawBlock(rawData, BENCH_BLOCK_SAMPLES, xyzBlock[X_INDEX], xyzBlock[Y_INDEX], xyzBlock[Z_INDEX]);
+
+    if(!bench_init()){
+        return EXIT_FAILURE;
+    }
+
+    if(!bench_check()){
+        return EXIT_FAILURE;
+    }
+
+    printf("[bench] Ringbuffer of %u samples per axis, blocks of %u samples, windows of %u samples, decoder: %s\n",
+            BENCH_BUFFER_SIZE,
+            BENCH_BLOCK_SAMPLES,
+            BENCH_WINDOW_SAMPLES,
+            decodeImplName(decodeImplBest()));
+
+    printf("[bench]          push decoded      push raw          read window       read per sample\n");
+
+    for(bench_variant_t variant = bench_legacy; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+        printf("[bench] %-8s %8.1f Msamples/s %8.1f Msamples/s %8.1f Msamples/s %8.1f Msamples/s\n",
+                variantNames[variant],
+                bench_push(variant, false) / 1e6,
+                bench_push(variant, true) / 1e6,
+                bench_read(variant) / 1e6,
+                bench_sample(variant) / 1e6);
+    }
+
+    printf("[bench]          push raw + envelopes\n");
+
+    for(bench_variant_t variant = bench_soa; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+        printf("[bench] %-8s %8.1f Msamples/s\n", variantNames[variant], bench_pyramid(variant) / 1e6);
+    }
+
+    // noisy sine, about the 10 % of full scale a vibration fills, the estimator steps the timestamps between two FIFO reads
+    for(uint32_t i = 0; i < BENCH_PACK_SIGNAL; i++){
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            packSignal[axis][i] = (int16_t) (3000.0 * sin(2.0 * M_PI * (axis + 1) * i / 512.0) + (rand() % 33) - 16);
+        }
+        packJitter[i] = (rand() % 2001) - 1000;
+    }
+
+    printf("[bench]          push + pack       read packed       compression\n");
+    printf("[bench] %-8s %8.1f Msamples/s ", variantNames[bench_soa], bench_pack_push() / 1e6);
+
+    if(!bench_check_pack()){
+        return EXIT_FAILURE;
+    }
+
+    printf("%8.1f Msamples/s %8.1f x (%u samples in %u MB)\n",
+            bench_pack_read() / 1e6,
+            (double) ((pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT) * (NUMBER_OF_AXES * sizeof(int16_t) + sizeof(uint64_t)) / pack.size,
+            (pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT,
+            pack.size >> 20);
+
+    return EXIT_SUCCESS;
+}
+
+
+static bool bench_init(void){
+
+    int16_t*    legacyBuffers   [NUMBER_OF_AXES];
+    void*       buffer          = NULL;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        legacyBuffers[axis] = malloc(BENCH_BUFFER_SIZE * sizeof(int16_t));
+
+        if(legacyBuffers[axis] == NULL){
+            printf("[bench][error] Buffer could not be allocated.\n");
+            return false;
+        }
+        memset(legacyBuffers[axis], 0, BENCH_BUFFER_SIZE * sizeof(int16_t));
+    }
+
+    if(!rb_xyz_init(legacyRingbuffer, legacyBuffers, BENCH_BUFFER_SIZE)){
+        return false;
+    }
+
+    for(bench_variant_t variant = bench_soa; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+        buffer = rb_multi_alloc(BENCH_BUFFER_SIZE, sizeof(int16_t), variantLayouts[variant]);
+
+        if(buffer == NULL){
+            printf("[bench][error] Buffer could not be allocated.\n");
+            return false;
+        }
+        memset(buffer, 0, rb_multi_bytes(BENCH_BUFFER_SIZE, sizeof(int16_t), variantLayouts[variant]));
+
+        if(!rb_multi_init(&xyzRingbuffer[variant], buffer, BENCH_BUFFER_SIZE, sizeof(int16_t), variantLayouts[variant])){
+            return false;
+        }
+
+        if(!rb_pyramid_init(&pyramid[variant])){
+            return false;
+        }
+    }
+
+    if(!rb_pack_init(&pack, BENCH_PACK_SIZE, sizeof(int16_t), 0)){
+        return false;
+    }
+
+    buffer = calloc(BENCH_BUFFER_SIZE, sizeof(uint64_t));
+
+    if((buffer == NULL) || !rb_ts_init(&timestampRingbuffer, buffer, BENCH_BUFFER_SIZE)){
+        printf("[bench][error] Timestamp buffer could not be allocated.\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool bench_check(void){
+
+    trigger_info_t  triggerInfo;
+    uint32_t        samplesPushed   = 0;
+    int16_t         xyzSample       [NUMBER_OF_AXES];
+    int16_t         xyzSampleRef    [NUMBER_OF_AXES];
+    void*           xyzSpan         [NUMBER_OF_AXES];
+
+    // odd block sizes, so blocks end anywhere within interleaved blocks and the buffer wraps more than once
+    while(samplesPushed < 3 * BENCH_BUFFER_SIZE){
+        uint32_t samples = 1 + (rand() % BENCH_BLOCK_SAMPLES);
+
+        bench_legacy_push_raw(legacyRingbuffer, rawData, samples);
+        rb_ts_push_block(&timestampRingbuffer, timestamps, samples);
+        for(bench_variant_t variant = bench_soa; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+            rb_push_raw_block(&xyzRingbuffer[variant], rawData, samples);
+            rb_pyramid_push(&pyramid[variant], &xyzRingbuffer[variant], &timestampRingbuffer, samples);
+        }
+        samplesPushed += samples;
+    }
+
+    for(bench_variant_t variant = bench_soa; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+        if(!bench_check_pyramid(variant)){
+            return false;
+        }
+    }
+
+    for(uint32_t window = 0; window < BENCH_CHECK_WINDOWS; window++){
+
+        memset(&triggerInfo, 0, sizeof(triggerInfo));
+        triggerInfo.triggerIndex        = ((uint32_t) rand()) & (BENCH_BUFFER_SIZE - 1);
+        triggerInfo.samplesBeforeTrig   = rand() % (BENCH_WINDOW_SAMPLES / 2);
+        triggerInfo.numberOfSamples     = 1 + (rand() % BENCH_WINDOW_SAMPLES);
+
+        bench_read_window(bench_legacy, &triggerInfo, xyzWindowRef);
+
+        for(bench_variant_t variant = bench_soa; variant < NUMBER_OF_BENCH_VARIANTS; variant++){
+
+            bench_read_window(variant, &triggerInfo, xyzWindow);
+
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                if(memcmp(xyzWindow[axis], xyzWindowRef[axis], triggerInfo.numberOfSamples * sizeof(int16_t)) != 0){
+                    printf("[bench][error] Window of %s differs (index %u, %u samples, axis %u)\n",
+                            variantNames[variant], triggerInfo.triggerIndex, triggerInfo.numberOfSamples, axis);
+                    return false;
+                }
+            }
+
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                xyzSampleRef[axis] = legacyRingbuffer[axis].buffer[triggerInfo.triggerIndex];
+            }
+            rb_get_span(&xyzRingbuffer[variant], triggerInfo.triggerIndex, 1, xyzSpan);
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                xyzSample[axis] = *(int16_t*) xyzSpan[axis];
+            }
+
+            if(memcmp(xyzSample, xyzSampleRef, sizeof(xyzSample)) != 0){
+                printf("[bench][error] Sample of %s differs (index %u)\n", variantNames[variant], triggerInfo.triggerIndex);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static void bench_read_window(bench_variant_t variant, trigger_info_t *triggerInfo, int16_t (*xyzOut)[BENCH_WINDOW_SAMPLES]){
+
+    void* xyzBuffers[NUMBER_OF_AXES] = {xyzOut[X_INDEX], xyzOut[Y_INDEX], xyzOut[Z_INDEX]};
+
+    if(variant == bench_legacy){
+        rb_read_chunk(&legacyRingbuffer[X_INDEX], xyzOut[X_INDEX], triggerInfo);
+        rb_read_chunk(&legacyRingbuffer[Y_INDEX], xyzOut[Y_INDEX], triggerInfo);
+        rb_read_chunk(&legacyRingbuffer[Z_INDEX], xyzOut[Z_INDEX], triggerInfo);
+    }
+    else{
+        rb_read_block(&xyzRingbuffer[variant], xyzBuffers, triggerInfo);
+    }
+}
+
+
+static uint32_t bench_legacy_push_raw(ringbuffer_t *rb, const uint8_t *xyzRawData, uint32_t numberOfSamples){
+
+    uint32_t firstIndex     = rb[X_INDEX].index & rb[X_INDEX].modulo;
+    uint32_t firstSpan      = rb[X_INDEX].size - firstIndex;
+
+    if(firstSpan > numberOfSamples){
+        firstSpan = numberOfSamples;
+    }
+
+    // block is split once at most, if it wraps past the end of the buffers
+    convertRawBlock(xyzRawData, firstSpan,
+                    &rb[X_INDEX].buffer[firstIndex], &rb[Y_INDEX].buffer[firstIndex], &rb[Z_INDEX].buffer[firstIndex]);
+    convertRawBlock(&xyzRawData[firstSpan * NUMBER_OF_CHANNELS], numberOfSamples - firstSpan,
+                    rb[X_INDEX].buffer, rb[Y_INDEX].buffer, rb[Z_INDEX].buffer);
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        rb[axis].index += numberOfSamples;
+    }
+
+    return firstIndex;
+}
+
+
+static bool bench_check_pyramid(bench_variant_t variant){
+
+    rb_envelope_t   envelope;
+    uint32_t        samples     = 0;
+    uint32_t        first       = 0;
+    int16_t         value       = 0;
+    int16_t         min         = 0;
+    int16_t         max         = 0;
+    int64_t         sum         = 0;
+    uint64_t        sumSquares  = 0;
+
+    for(uint8_t level = 0; level < RB_PYRAMID_LEVELS; level++){
+
+        samples = 1 << (RB_PYRAMID_SHIFT * (level + 1));
+        first   = (pyramid[variant].level[level].index - 1) * samples;
+
+        if(rb_pyramid_read(&pyramid[variant], level, 1, &envelope) != 1){
+            printf("[bench][error] Level %u of %s is empty\n", level, variantNames[variant]);
+            return false;
+        }
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            min         = INT16_MAX;
+            max         = INT16_MIN;
+            sum         = 0;
+            sumSquares  = 0;
+
+            for(uint32_t i = first; i < first + samples; i++){
+                value        = legacyRingbuffer[axis].buffer[i & (BENCH_BUFFER_SIZE - 1)];
+                min          = (value < min) ? value : min;
+                max          = (value > max) ? value : max;
+                sum         += value;
+                sumSquares  += (uint64_t) (value * value);
+            }
+
+            if((envelope.min[axis] != min) || (envelope.max[axis] != max) ||
+               (envelope.mean[axis] != (int16_t) (sum / samples)) ||
+               (envelope.rms[axis] != (uint16_t) sqrt((double) sumSquares / samples))){
+                printf("[bench][error] Envelope of level %u of %s differs (axis %u)\n", level, variantNames[variant], axis);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static double bench_pyramid(bench_variant_t variant){
+
+    uint64_t    samples     = 0;
+    uint64_t    startNs     = ts_now_ns();
+    uint64_t    elapsedNs   = 0;
+
+    do{
+        for(uint32_t block = 0; block < BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES; block++){
+            rb_push_raw_block(&xyzRingbuffer[variant], rawData, BENCH_BLOCK_SAMPLES);
+            rb_ts_push_block(&timestampRingbuffer, timestamps, BENCH_BLOCK_SAMPLES);
+            rb_pyramid_push(&pyramid[variant], &xyzRingbuffer[variant], &timestampRingbuffer, BENCH_BLOCK_SAMPLES);
+        }
+        samples    += (uint64_t) (BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES) * BENCH_BLOCK_SAMPLES;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static double bench_push(bench_variant_t variant, bool raw){
+
+    void*       xyzData     [NUMBER_OF_AXES]    = {xyzBlock[X_INDEX], xyzBlock[Y_INDEX], xyzBlock[Z_INDEX]};
+    uint64_t    samples     = 0;
+    uint64_t    startNs     = ts_now_ns();
+    uint64_t    elapsedNs   = 0;
+
+    do{
+        // one pass over the whole buffer between two reads of the clock
+        for(uint32_t block = 0; block < BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES; block++){
+            if(variant == bench_legacy){
+                if(raw){
+                    bench_legacy_push_raw(legacyRingbuffer, rawData, BENCH_BLOCK_SAMPLES);
+                }
+                else{
+                    for(uint32_t sample = 0; sample < BENCH_BLOCK_SAMPLES; sample++){
+                        rb_push(&legacyRingbuffer[X_INDEX], xyzBlock[X_INDEX][sample]);
+                        rb_push(&legacyRingbuffer[Y_INDEX], xyzBlock[Y_INDEX][sample]);
+                        rb_push(&legacyRingbuffer[Z_INDEX], xyzBlock[Z_INDEX][sample]);
+                    }
+                }
+            }
+            else if(raw){
+                rb_push_raw_block(&xyzRingbuffer[variant], rawData, BENCH_BLOCK_SAMPLES);
+            }
+            else{
+                rb_push_block(&xyzRingbuffer[variant], xyzData, BENCH_BLOCK_SAMPLES);
+            }
+        }
+        samples    += (uint64_t) (BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES) * BENCH_BLOCK_SAMPLES;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static double bench_read(bench_variant_t variant){
+
+    trigger_info_t  triggerInfo;
+    uint32_t        start       = 0;
+    uint64_t        samples     = 0;
+    uint64_t        startNs     = ts_now_ns();
+    uint64_t        elapsedNs   = 0;
+
+    memset(&triggerInfo, 0, sizeof(triggerInfo));
+    triggerInfo.numberOfSamples     = BENCH_WINDOW_SAMPLES;
+    triggerInfo.samplesBeforeTrig   = BENCH_WINDOW_SAMPLES / 2;
+
+    do{
+        // windows jump through the buffer, so they are never in the cache
+        for(uint32_t window = 0; window < 16; window++){
+            start                       = (start + 7 * BENCH_WINDOW_SAMPLES + 12345) & (BENCH_BUFFER_SIZE - 1);
+            triggerInfo.triggerIndex    = start;
+
+            bench_read_window(variant, &triggerInfo, xyzWindow);
+            __asm__ volatile("" : : "r"(xyzWindow) : "memory");
+        }
+        samples    += 16 * BENCH_WINDOW_SAMPLES;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static double bench_sample(bench_variant_t variant){
+
+    int16_t     xyzSample   [NUMBER_OF_AXES];
+    void*       xyzSpan     [NUMBER_OF_AXES];
+    uint32_t    span        = 0;
+    int32_t     sum         = 0;
+    uint64_t    samples     = 0;
+    uint64_t    startNs     = ts_now_ns();
+    uint64_t    elapsedNs   = 0;
+
+    do{
+        for(uint32_t index = 0; index < BENCH_BUFFER_SIZE; index += span){
+            if(variant == bench_legacy){
+                span = 1;
+                for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                    xyzSample[axis] = legacyRingbuffer[axis].buffer[index];
+                }
+                sum += xyzSample[X_INDEX] + xyzSample[Y_INDEX] + xyzSample[Z_INDEX];
+                continue;
+            }
+
+            // like trigger detection, the samples of a pushed block are gone through span by span
+            span = rb_get_span(&xyzRingbuffer[variant], index, BENCH_BUFFER_SIZE - index, xyzSpan);
+            for(uint32_t i = 0; i < span; i++){
+                for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                    xyzSample[axis] = ((int16_t*) xyzSpan[axis])[i];
+                }
+                sum += xyzSample[X_INDEX] + xyzSample[Y_INDEX] + xyzSample[Z_INDEX];
+            }
+        }
+        samples    += BENCH_BUFFER_SIZE;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    // keeps the compiler from dropping the reads
+    __asm__ volatile("" : : "r"(sum));
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static double bench_pack_push(void){
+
+    void*       xyzData     [NUMBER_OF_AXES];
+    uint32_t    signal      = 0;
+    uint64_t    samples     = 0;
+    uint64_t    startNs     = 0;
+    uint64_t    elapsedNs   = 0;
+
+    // packing starts with the next sample pushed
+    rb_pack_free(&pack);
+    if(!rb_pack_init(&pack, BENCH_PACK_SIZE, sizeof(int16_t), xyzRingbuffer[bench_soa].index)){
+        return 0;
+    }
+
+    startNs = ts_now_ns();
+
+    do{
+        for(uint32_t block = 0; block < BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES; block++){
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                xyzData[axis] = &packSignal[axis][signal];
+            }
+            for(uint32_t i = 0; i < BENCH_BLOCK_SAMPLES; i++){
+                timestamps[i] = packTimestamp + packJitter[signal];
+                packTimestamp += BENCH_PACK_PERIOD_NS;
+            }
+            signal = (signal + BENCH_BLOCK_SAMPLES) % (BENCH_PACK_SIGNAL - BENCH_BLOCK_SAMPLES);
+
+            rb_push_block(&xyzRingbuffer[bench_soa], xyzData, BENCH_BLOCK_SAMPLES);
+            rb_ts_push_block(&timestampRingbuffer, timestamps, BENCH_BLOCK_SAMPLES);
+            rb_pack_push(&pack, &xyzRingbuffer[bench_soa], &timestampRingbuffer);
+        }
+        samples    += (uint64_t) (BENCH_BUFFER_SIZE / BENCH_BLOCK_SAMPLES) * BENCH_BLOCK_SAMPLES;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
+
+
+static bool bench_check_pack(void){
+
+    trigger_info_t  triggerInfo;
+    rb_view_t       view;
+    rb_pack_view_t  packView;
+    void*           xyzBuffers  [NUMBER_OF_AXES]    = {xyzWindow[X_INDEX], xyzWindow[Y_INDEX], xyzWindow[Z_INDEX]};
+    void*           xyzRef      [NUMBER_OF_AXES]    = {xyzWindowRef[X_INDEX], xyzWindowRef[Y_INDEX], xyzWindowRef[Z_INDEX]};
+    uint32_t        index       = xyzRingbuffer[bench_soa].index;
+    uint32_t        packed      = (pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT;
+
+    // windows anywhere in the compressed ring, the last ones reach into the samples not packed yet
+    for(uint32_t window = 0; window < BENCH_CHECK_WINDOWS; window++){
+        memset(&triggerInfo, 0, sizeof(triggerInfo));
+        triggerInfo.numberOfSamples     = BENCH_WINDOW_SAMPLES;
+        triggerInfo.samplesBeforeTrig   = BENCH_WINDOW_SAMPLES / 2;
+        triggerInfo.triggerIndex        = (window < BENCH_CHECK_WINDOWS - 10) ?
+                                          index - BENCH_WINDOW_SAMPLES - (uint32_t) rand() % (packed - 2 * BENCH_WINDOW_SAMPLES) :
+                                          index - BENCH_WINDOW_SAMPLES / 2 + window % 10;
+
+        if(!rb_pack_take(&pack, &xyzRingbuffer[bench_soa], &triggerInfo, &view, &packView)){
+            printf("[bench][error] Window %u of compressed ring could not be taken\n", window);
+            return false;
+        }
+
+        if((triggerInfo.numberOfSamples != BENCH_WINDOW_SAMPLES) ||
+           (rb_pack_read(&pack, &packView, 0, packView.numberOfSamples, xyzBuffers, windowTimestamps) != packView.numberOfSamples)){
+            printf("[bench][error] Window %u of compressed ring is incomplete\n", window);
+            return false;
+        }
+
+        rb_read_block(&xyzRingbuffer[bench_soa], xyzRef, &triggerInfo);
+
+        for(uint32_t i = 0; i < packView.numberOfSamples; i++){
+            if((xyzWindow[X_INDEX][i] != xyzWindowRef[X_INDEX][i]) ||
+               (xyzWindow[Y_INDEX][i] != xyzWindowRef[Y_INDEX][i]) ||
+               (xyzWindow[Z_INDEX][i] != xyzWindowRef[Z_INDEX][i]) ||
+               (windowTimestamps[i] != timestampRingbuffer.buffer[(packView.firstSample + i) & timestampRingbuffer.modulo])){
+                printf("[bench][error] Sample %u of window %u of compressed ring differs\n", i, window);
+                return false;
+            }
+        }
+
+        rb_view_release(&xyzRingbuffer[bench_soa]);
+        rb_pack_release(&pack);
+    }
+
+    return true;
+}
+
+
+static double bench_pack_read(void){
+
+    rb_pack_view_t  packView;
+    void*           xyzBuffers  [NUMBER_OF_AXES]    = {xyzWindow[X_INDEX], xyzWindow[Y_INDEX], xyzWindow[Z_INDEX]};
+    uint32_t        packed      = (pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT;
+    uint32_t        start       = 0;
+    uint64_t        samples     = 0;
+    uint64_t        startNs     = ts_now_ns();
+    uint64_t        elapsedNs   = 0;
+
+    do{
+        // windows jump through the compressed ring and start anywhere within a block
+        for(uint32_t window = 0; window < 16; window++){
+            start                       = (start + 7 * BENCH_WINDOW_SAMPLES + 12345) % (packed - BENCH_WINDOW_SAMPLES);
+            packView.firstSample        = pack.firstSample + (pack.oldestBlock << RB_PACK_BLOCK_SHIFT) + start;
+            packView.numberOfSamples    = BENCH_WINDOW_SAMPLES;
+
+            rb_pack_read(&pack, &packView, 0, BENCH_WINDOW_SAMPLES, xyzBuffers, windowTimestamps);
+            __asm__ volatile("" : : "r"(xyzWindow), "r"(windowTimestamps) : "memory");
+        }
+        samples    += 16 * BENCH_WINDOW_SAMPLES;
+        elapsedNs   = ts_now_ns() - startNs;
+    } while(elapsedNs < BENCH_TIME_NS);
+
+    return samples * 1e9 / elapsedNs;
+}
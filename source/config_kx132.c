@@ -75,9 +75,25 @@ static const char* xFixedThres_Flag    = "-xF";
 static const char* yFixedThres_Flag    = "-yF";
 static const char* zFixedThres_Flag    = "-zF";
 
+static const char* sensor_Flag         = "-sensor";
+
+static const char* adpOutput_Flag      = "-adpout";
+static const char* adpOff_Arg          = "off";
+static const char* adpFilter_Arg       = "filter";
+static const char* adpRms_Arg          = "rms";
+static const char* adpRmsAverage_Flag  = "-adprms";
+static const char* adpFilter1_Flag     = "-adpf1";
+static const char* adpFilter2_Flag     = "-adpf2";
+
+static const char* unitG_Arg           = "g";
+static const char* unitMs2_Arg         = "ms2";
+static const char* unitCounts_Arg      = "counts";
+
 
 static const double outputDataRate_double_list[16] = {0.781, 1.563, 3.125, 6.25, 12.5, 25, 50, 100, 200, 400, 800, 1600, 3200, 6400, 12800, 25600};
 
+static const float gPerCount_list[4] = {1.0 / 16384, 1.0 / 8192, 1.0 / 4096, 1.0 / 2048};    ///< indexed by g-range >> 3 (2g, 4g, 8g, 16g)
+
 static const trigger_bitmask_t triggerBitmaskList[7] = {
     x_trigger,
     y_trigger,
@@ -128,23 +144,350 @@ static void setTriggerTimeSamplesAfter(trigger_info_t *triggerInfo, outputDataRa
 static void setTriggerTimeSamples(trigger_info_t *triggerInfo, outputDataRate_hw_t outputDataRate);
 
 
+/**
+ * @brief Returns the output data rate used for calculating samples before + after trigger.
+ * 
+ * @param triggerInfo       pointer to struct containing the measured output data rate
+ * @param outputDataRate    hardware frequency of sensor, used as long as no rate was measured
+ * @return double           output data rate in Hz
+ */
+static double getTriggerSampleRate(trigger_info_t *triggerInfo, outputDataRate_hw_t outputDataRate);
+
+
+/**
+ * @brief Sets the default values of all settings.
+ * 
+ * @param kx132_config      pointer to struct containg all configuration settings
+ */
+static void setDefaultConfig(kx132_config_t *kx132_config);
+
+
+/**
+ * @brief Parses "<bus>.<cs>" and sets bus, chip-select and spidev-path of a sensor.
+ * 
+ * @param arg               argument of "-sensor"
+ * @param spiConfig         pointer to SPI config of sensor
+ * @return true             if bus and chip-select are valid
+ * @return false            if error
+ */
+static bool setSensorAddress(const char *arg, spi_config_t *spiConfig);
+
+
+/**
+ * @brief Parses "off" / "filter" / "rms" and sets the output of the Advanced Data Path.
+ * 
+ * @param arg               argument of "-adpout"
+ * @param adpConfig         pointer to ADP config of sensor
+ * @return true             if argument is valid
+ * @return false            if error
+ */
+static bool setAdpOutput(const char *arg, adp_config_t *adpConfig);
+
+
+/**
+ * @brief Parses the number of samples averaged by the RMS engine.
+ * 
+ * @param arg               argument of "-adprms", power of two (ADP_RMS_AVERAGE_MIN - ADP_RMS_AVERAGE_MAX)
+ * @param adpConfig         pointer to ADP config of sensor
+ * @return true             if argument is valid
+ * @return false            if error
+ */
+static bool setAdpRmsAverage(const char *arg, adp_config_t *adpConfig);
+
+
+/**
+ * @brief Parses "off" or "<1A>,<BA>,<CA>,<ISH>,<OSH>" (decimal or 0x-hex) and sets filter-1.
+ * 
+ * @param arg               argument of "-adpf1"
+ * @param adpConfig         pointer to ADP config of sensor
+ * @return true             if argument is valid
+ * @return false            if error
+ */
+static bool setAdpFilter1(const char *arg, adp_config_t *adpConfig);
+
+
+/**
+ * @brief Parses "off" or "<1A>,<BA>,<ISH>,<OSH>" (decimal or 0x-hex) and sets filter-2.
+ * 
+ * @param arg               argument of "-adpf2"
+ * @param adpConfig         pointer to ADP config of sensor
+ * @return true             if argument is valid
+ * @return false            if error
+ */
+static bool setAdpFilter2(const char *arg, adp_config_t *adpConfig);
+
+
+/**
+ * @brief Parses "counts" / "g" / "ms2" and sets the unit of an output.
+ * 
+ * @param arg               argument of "-unitstream" / "-unittrig"
+ * @param unit              pointer to unit of output
+ * @return true             if argument is valid
+ * @return false            if error
+ */
+static bool setOutputUnit(const char *arg, outputUnit_t *unit);
+
+
+/**
+ * @brief Parses a threshold given in physical units, e.g. "0.5g" or "4.9ms2".
+ * 
+ * @param arg               argument of a threshold flag
+ * @param thresholdG        pointer to where the threshold in g should be saved
+ * @return true             if argument has a unit
+ * @return false            if argument is no number or has no unit (counts)
+ */
+static bool parseThresholdG(const char *arg, float *thresholdG);
+
+
+/**
+ * @brief Converts a threshold in g to counts of the g-range, limited to the range of the threshold.
+ * 
+ * @param thresholdG        threshold in g
+ * @param gRange            hardware setting of g-range
+ * @param min               min value of threshold in counts
+ * @param max               max value of threshold in counts
+ * @return int32_t          threshold in counts
+ */
+static int32_t getThresholdCounts(float thresholdG, gRange_hw_t gRange, int32_t min, int32_t max);
+
+
+/**
+ * @brief Sets scale factors of the outputs and converts thresholds given in physical units to counts.
+ * 
+ * @note Called once after parsing, when the g-range is known.
+ * 
+ * @param kx132_config      pointer to struct containg all configuration settings of one sensor
+ */
+static void setUnitConfig(kx132_config_t *kx132_config);
+
+
 //-------------------------------------------------------------------
 //--- Function Definitions  -----------------------------------------
 //-------------------------------------------------------------------
 
-void kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config){
+uint8_t kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config, uint8_t maxSensors){
+
+    uint8_t     numberOfSensors = 0;
+    uint16_t    baseEnd         = 0;
+    uint16_t    sectionStart    = 0;
+    uint16_t    sectionEnd      = 0;
+    bool        duplicate       = false;
+
+
+    // flags before the first "-sensor" are the base of all sensors
+    for(baseEnd = 1; baseEnd < argc; baseEnd++){
+        if(!strcmp(argv[baseEnd], sensor_Flag)){
+            break;
+        }
+    }
+
+    sectionEnd = baseEnd;
+
+    do{
+        sectionStart = sectionEnd;
+        for(sectionEnd = sectionStart + 1; sectionEnd < argc; sectionEnd++){
+            if(!strcmp(argv[sectionEnd], sensor_Flag)){
+                break;
+            }
+        }
+
+        if(numberOfSensors >= maxSensors){
+            printf("[config][warning] Only %d sensors supported, ignoring the rest.\n", maxSensors);
+            break;
+        }
+
+        kx132_config_t* config = &kx132_config[numberOfSensors];
+
+        setDefaultConfig(config);
+
+        // process user input coming from console and set config accordingly
+        if(baseEnd > 1){
+            processInitFlags(baseEnd, argv, config->mainConfig, config->triggerConfig, config->triggerData);
+        }
+
+        // without "-sensor" the default bus and chip-select are used
+        if(sectionStart >= argc){
+            numberOfSensors++;
+            break;
+        }
+
+        if((sectionStart + 1 >= argc) || !setSensorAddress(argv[sectionStart + 1], &config->mainConfig->spiConfig)){
+            printf("[config][warning] Expected \"%s <bus>.<cs>\", ignoring sensor.\n", sensor_Flag);
+            continue;
+        }
+
+        duplicate = false;
+        for(uint8_t s = 0; s < numberOfSensors; s++){
+            if((kx132_config[s].mainConfig->spiConfig.bus        == config->mainConfig->spiConfig.bus) &&
+               (kx132_config[s].mainConfig->spiConfig.chipSelect == config->mainConfig->spiConfig.chipSelect)){
+                duplicate = true;
+            }
+        }
+        if(duplicate){
+            printf("[config][warning] Sensor %s configured twice, ignoring it.\n", argv[sectionStart + 1]);
+            continue;
+        }
+
+        // section starts with "-sensor <bus>.<cs>", processInitFlags() skips the first argument like argv[0] of main()
+        if(sectionEnd - sectionStart > 2){
+            processInitFlags(sectionEnd - sectionStart - 1,
+                             &argv[sectionStart + 1],
+                             config->mainConfig,
+                             config->triggerConfig,
+                             config->triggerData);
+        }
+
+        numberOfSensors++;
+
+    } while(sectionEnd < argc);
+
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        main_config_t* mainConfig = kx132_config[s].mainConfig;
+
+        // sync1 can't work without INT1, fall back to the default GPIO
+        if((mainConfig->readMode_hw == synchronous_read_1) && (mainConfig->int1Config.source == gpio_source_none)){
+            mainConfig->int1Config.source = gpio_source_cdev;
+        }
+
+        // "-wm" may come before "-res", so the watermark is checked against the resolution afterwards
+        if((mainConfig->resolution_hw == resolution_16bit) && (mainConfig->bufferWatermark > KX132_BUF_MAX_SAMPLES)){
+            printf("[config][warning] Watermark %d exceeds 16-Bit sample buffer, using %d.\n", mainConfig->bufferWatermark, KX132_BUF_MAX_SAMPLES);
+            mainConfig->bufferWatermark = KX132_BUF_MAX_SAMPLES;
+        }
+
+        // ADP can't run faster than the sensor, only the sample buffer can be filled at a lower rate
+        if(mainConfig->adpConfig.outputDataRate > mainConfig->outputDataRate_hw){
+            mainConfig->adpConfig.outputDataRate = mainConfig->outputDataRate_hw;
+        }
+        if((mainConfig->adpConfig.outputDataRate < mainConfig->outputDataRate_hw) && (mainConfig->readMode_hw != buffer_read)){
+            printf("[config][warning] Lower ADP output data rate needs \"-read buffer\", using output data rate.\n");
+            mainConfig->adpConfig.outputDataRate = mainConfig->outputDataRate_hw;
+        }
+
+        // the sample buffer keeps the pre-trigger history while the host idles, there is none without buffer_read
+        if(mainConfig->wakeConfig.enabled && ((mainConfig->useMode != triggered_mode) || (mainConfig->readMode_hw != buffer_read))){
+            printf("[config][warning] Wake-up engine needs \"-mode trig\" and \"-read buffer\", disabled.\n");
+            mainConfig->wakeConfig.enabled = false;
+        }
+        if(mainConfig->bufferTrigger && ((mainConfig->useMode != triggered_mode) || (mainConfig->readMode_hw != buffer_read))){
+            printf("[config][warning] Trigger mode of sample buffer needs \"-mode trig\" and \"-read buffer\", disabled.\n");
+            mainConfig->bufferTrigger = false;
+        }
+        if(mainConfig->bufferTrigger && !mainConfig->wakeConfig.enabled){
+            printf("[config][warning] Sample buffer is only triggered through TRIG-PIN, use \"-waketh\" for triggering on motion.\n");
+        }
+        if(mainConfig->wakeConfig.sleepThreshold == 0){
+            mainConfig->wakeConfig.sleepThreshold = mainConfig->wakeConfig.wakeThreshold;
+        }
+        // sync1 waits on INT1 and buffer_read sleeps until the watermark anyway
+        if(mainConfig->waitConfig.hybrid && (mainConfig->readMode_hw != synchronous_read_0) && (mainConfig->readMode_hw != asynchronous_read)){
+            mainConfig->waitConfig.hybrid = false;
+        }
+
+        // history file is read by the software trigger only, the sample buffer trigger sends the sensor's history
+        if((mainConfig->historyPath[0] != '\0') && ((mainConfig->useMode != triggered_mode) || mainConfig->bufferTrigger)){
+            printf("[config][warning] History file is only used by the software trigger of \"-mode trig\", ignored.\n");
+            mainConfig->historyPath[0] = '\0';
+        }
+        if(mainConfig->envelope && ((mainConfig->useMode != triggered_mode) || mainConfig->bufferTrigger)){
+            printf("[config][warning] Envelopes are only kept by the software trigger of \"-mode trig\", disabled.\n");
+            mainConfig->envelope = false;
+        }
+        if((mainConfig->packSize > 0) && ((mainConfig->useMode != triggered_mode) || mainConfig->bufferTrigger)){
+            printf("[config][warning] Compressed history is only kept by the software trigger of \"-mode trig\", disabled.\n");
+            mainConfig->packSize = 0;
+        }
+        if((mainConfig->historyPath[0] != '\0') && (numberOfSensors > 1)){
+            size_t length = strlen(mainConfig->historyPath);
+            snprintf(&mainConfig->historyPath[length], HISTORY_PATH_LEN - length, ".%u", s);
+        }
+        if(mainConfig->historyMinutes > 0){
+            double      historySamples  = mainConfig->historyMinutes * 60 * getOutputDataRateHz(getSampleOutputDataRate(mainConfig));
+            uint32_t    bufferSize      = BUFFER_SIZE_128_KB;
+
+            while((bufferSize < historySamples) && (bufferSize < BUFFER_SIZE_MAX)){
+                bufferSize <<= 1;
+            }
+            mainConfig->bufferSize = bufferSize;
+
+            if(mainConfig->historyPath[0] == '\0'){
+                printf("[config][warning] History of %.1f minutes kept in RAM, use \"-histfile\" for long histories.\n", mainConfig->historyMinutes);
+            }
+        }
+
+        setTriggerTimeSamples(kx132_config[s].triggerConfig->triggerInfo, getSampleOutputDataRate(mainConfig));
+        setUnitConfig(&kx132_config[s]);
+    }
+
+    return numberOfSensors;
+}
+
+
+static void setDefaultConfig(kx132_config_t *kx132_config){
 
     main_config_t*      mainConfig      =  kx132_config->mainConfig;
     trigger_config_t*   triggerConfig   =  kx132_config->triggerConfig;
     trigger_data_t*     triggerData     =  kx132_config->triggerData;
 
-
     mainConfig->outputDataRate_hw                                   = odr_25600_Hz;
     mainConfig->resolution_hw                                       = resolution_16bit;
     mainConfig->readMode_hw                                         = synchronous_read_0;
     mainConfig->gRange_hw                                           = g_range_8g;
     mainConfig->useMode                                             = triggered_mode;
     mainConfig->bufferSize                                          = DEFAULT_BUFFER_SIZE;
+    mainConfig->bufferLayout                                        = rb_layout_soa;
+    mainConfig->historyPath[0]                                      = '\0';
+    mainConfig->historyMinutes                                      = 0;
+    mainConfig->envelope                                            = false;
+    mainConfig->packSize                                            = 0;
+    mainConfig->bufferWatermark                                     = DEFAULT_BUF_WATERMARK;
+    mainConfig->adpConfig.output                                    = adp_output_off;
+    mainConfig->adpConfig.outputDataRate                            = odr_25600_Hz;     // limited to output data rate after parsing
+    mainConfig->adpConfig.rmsAverage                                = DEFAULT_ADP_RMS_AVERAGE;
+    mainConfig->adpConfig.filter1.enabled                           = false;
+    mainConfig->adpConfig.filter2.enabled                           = false;
+    mainConfig->bufferTrigger                                       = false;
+    mainConfig->wakeConfig.enabled                                  = false;
+    mainConfig->wakeConfig.wakeThreshold                            = 0;
+    mainConfig->wakeConfig.sleepThreshold                           = 0;                // wake threshold, if not set
+    mainConfig->wakeConfig.wakeCount                                = DEFAULT_WAKE_COUNT;
+    mainConfig->wakeConfig.sleepCount                               = DEFAULT_SLEEP_COUNT;
+    mainConfig->wakeConfig.outputDataRate                           = WAKE_ODR_MAX;
+    mainConfig->waitConfig.hybrid                                   = true;
+    mainConfig->waitConfig.spinUs                                   = DEFAULT_WAIT_SPIN_US;
+    mainConfig->unitConfig.stream                                   = unit_counts;
+    mainConfig->unitConfig.trigger                                  = unit_counts;
+    mainConfig->unitConfig.streamScale                              = 1;
+    mainConfig->unitConfig.triggerScale                             = 1;
+    mainConfig->int1Config.source                                   = gpio_source_none;
+    mainConfig->int1Config.line                                     = DEFAULT_GPIO_INT1_LINE;
+    strncpy(mainConfig->int1Config.chipPath, DEFAULT_GPIO_CHIP_PATH, GPIO_CHIP_PATH_LEN - 1);
+    mainConfig->int1Config.chipPath[GPIO_CHIP_PATH_LEN - 1]         = '\0';
+
+    #ifdef SPI_BACKEND_BCM2835
+    mainConfig->spiConfig.backend                                   = spi_backend_bcm2835;
+    #else
+    mainConfig->spiConfig.backend                                   = spi_backend_spidev;
+    #endif //SPI_BACKEND_BCM2835
+    mainConfig->spiConfig.clockHz                                   = DEFAULT_SPI_CLOCK_HZ;
+    mainConfig->spiConfig.autoClock                                 = false;
+    mainConfig->spiConfig.bus                                       = 0;
+    mainConfig->spiConfig.chipSelect                                = 0;
+    strncpy(mainConfig->spiConfig.devicePath, DEFAULT_SPIDEV_PATH, SPI_DEVICE_PATH_LEN - 1);
+    mainConfig->spiConfig.devicePath[SPI_DEVICE_PATH_LEN - 1]       = '\0';
+
+    mainConfig->simConfig.signal                                    = sim_signal_none;
+    mainConfig->simConfig.amplitudeG                                = DEFAULT_SIM_AMPLITUDE_G;
+    mainConfig->simConfig.frequencyHz                               = DEFAULT_SIM_FREQUENCY_HZ;
+    mainConfig->simConfig.noiseG                                    = DEFAULT_SIM_NOISE_G;
+    mainConfig->simConfig.impulsePeriodS                            = DEFAULT_SIM_IMPULSE_PERIOD_S;
+    mainConfig->simConfig.timeScale                                 = DEFAULT_SIM_TIME_SCALE;
+    mainConfig->simConfig.maxSpiClockHz                             = DEFAULT_SIM_MAX_SPI_CLOCK_HZ;
+    mainConfig->simConfig.waveformPath[0]                           = '\0';
+
+    mainConfig->rtConfig.priority                                   = RT_PRIORITY_OFF;
+    mainConfig->rtConfig.cpu                                        = RT_CPU_ANY;
+    mainConfig->rtConfig.lockMemory                                 = false;
 
     triggerConfig->triggerMode                                      = fixedTriggerMode;
     triggerConfig->edgeDetection                                    = detectBoth;
@@ -154,6 +497,7 @@ void kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config
     triggerConfig->triggerInfo->timeBeforeTrig                      = DEFAULT_TIME;
     triggerConfig->triggerInfo->timeAfterTrig                       = DEFAULT_TIME;
     triggerConfig->triggerInfo->triggerIndex                        = ZERO;
+    triggerConfig->triggerInfo->sampleRateHz                        = ZERO;
 
     triggerData->normalizedData[X_AXIS]                             = DEFAULT_NORMALIZED;
     triggerData->normalizedData[Y_AXIS]                             = DEFAULT_NORMALIZED;
@@ -167,131 +511,730 @@ void kx132_config_init(uint16_t argc, char *argv[], kx132_config_t *kx132_config
     triggerData->offsetThreshold->offsetThresholdValues[Y_AXIS]     = DEFAULT_THRESHOLD;
     triggerData->offsetThreshold->offsetThresholdValues[Z_AXIS]     = DEFAULT_THRESHOLD;
 
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        mainConfig->unitConfig.offsetThresholdG[axis]               = NAN;
+        mainConfig->unitConfig.fixedThresholdG[axis]                = NAN;
+    }
+}
+
+
+static bool setSensorAddress(const char *arg, spi_config_t *spiConfig){
+
+    uint32_t bus        = 0;
+    uint32_t chipSelect = 0;
+
+    if(sscanf(arg, "%u.%u", &bus, &chipSelect) != 2){
+        return false;
+    }
+
+    if((bus >= SPI_MAX_BUSES) || (chipSelect >= SPI_MAX_CHIP_SELECTS)){
+        printf("[config][error] Sensor %s out of range (bus < %d, chip-select < %d).\n", arg, SPI_MAX_BUSES, SPI_MAX_CHIP_SELECTS);
+        return false;
+    }
+
+    spiConfig->bus          = bus;
+    spiConfig->chipSelect   = chipSelect;
+
+    // "-spidev" after "-sensor" still overrides the path
+    snprintf(spiConfig->devicePath, SPI_DEVICE_PATH_LEN, SPIDEV_PATH_FORMAT, bus, chipSelect);
+
+    return true;
+}
+
+
+static bool setAdpOutput(const char *arg, adp_config_t *adpConfig){
+
+    if(!strncmp(arg, adpOff_Arg, strlen(adpOff_Arg))){
+        adpConfig->output = adp_output_off;
+    }
+    else if(!strncmp(arg, adpFilter_Arg, strlen(adpFilter_Arg))){
+        adpConfig->output = adp_output_filter;
+    }
+    else if(!strncmp(arg, adpRms_Arg, strlen(adpRms_Arg))){
+        adpConfig->output = adp_output_rms;
+    }
+    else{
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool setAdpRmsAverage(const char *arg, adp_config_t *adpConfig){
+
+    uint32_t average = 0;
+
+    if(sscanf(arg, "%u", &average) != 1){
+        return false;
+    }
+
+    if((average < ADP_RMS_AVERAGE_MIN) || (average > ADP_RMS_AVERAGE_MAX) || ((average & (average - 1)) != 0)){
+        printf("[config][warning] ADP RMS average has to be a power of two (%d - %d).\n", ADP_RMS_AVERAGE_MIN, ADP_RMS_AVERAGE_MAX);
+        return false;
+    }
+
+    adpConfig->rmsAverage = average;
+    return true;
+}
+
+
+static bool setAdpFilter1(const char *arg, adp_config_t *adpConfig){
+
+    int a1, ba, ca, inputShift, outputShift;
+
+    if(!strncmp(arg, adpOff_Arg, strlen(adpOff_Arg))){
+        adpConfig->filter1.enabled = false;
+        return true;
+    }
+
+    if(sscanf(arg, "%i,%i,%i,%i,%i", &a1, &ba, &ca, &inputShift, &outputShift) != 5){
+        printf("[config][warning] Expected \"%s <1A>,<BA>,<CA>,<ISH>,<OSH>\".\n", adpFilter1_Flag);
+        return false;
+    }
+
+    adpConfig->filter1.enabled      = true;
+    adpConfig->filter1.a1           = a1            & 0x7F;
+    adpConfig->filter1.ba           = ba            & 0x7FFFFF;
+    adpConfig->filter1.ca           = ca            & 0x7FFFFF;
+    adpConfig->filter1.inputShift   = inputShift    & 0x1F;
+    adpConfig->filter1.outputShift  = outputShift   & 0x01;
+    return true;
+}
+
+
+static bool setAdpFilter2(const char *arg, adp_config_t *adpConfig){
+
+    int a1, ba, inputShift, outputShift;
+
+    if(!strncmp(arg, adpOff_Arg, strlen(adpOff_Arg))){
+        adpConfig->filter2.enabled = false;
+        return true;
+    }
+
+    if(sscanf(arg, "%i,%i,%i,%i", &a1, &ba, &inputShift, &outputShift) != 4){
+        printf("[config][warning] Expected \"%s <1A>,<BA>,<ISH>,<OSH>\".\n", adpFilter2_Flag);
+        return false;
+    }
+
+    adpConfig->filter2.enabled      = true;
+    adpConfig->filter2.a1           = a1            & 0x7F;
+    adpConfig->filter2.ba           = ba            & 0x7FFF;
+    adpConfig->filter2.inputShift   = inputShift    & 0x1F;
+    adpConfig->filter2.outputShift  = outputShift   & 0x1F;
+    return true;
+}
+
+
+static bool setOutputUnit(const char *arg, outputUnit_t *unit){
+
+    if(!strncmp(arg, unitCounts_Arg, strlen(unitCounts_Arg))){
+        *unit = unit_counts;
+    }
+    else if(!strncmp(arg, unitMs2_Arg, strlen(unitMs2_Arg))){
+        *unit = unit_ms2;
+    }
+    else if(!strncmp(arg, unitG_Arg, strlen(unitG_Arg))){
+        *unit = unit_g;
+    }
+    else{
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool parseThresholdG(const char *arg, float *thresholdG){
+
+    float   value       = 0;
+    char    unit        [8];
+
+    // unit has to follow the number directly, plain numbers are counts
+    if(sscanf(arg, "%f%7[^ \t\r\n]", &value, unit) != 2){
+        return false;
+    }
+
+    if(!strcmp(unit, unitG_Arg)){
+        *thresholdG = value;
+    }
+    else if(!strcmp(unit, unitMs2_Arg)){
+        *thresholdG = value / STANDARD_GRAVITY;
+    }
+    else{
+        return false;
+    }
+
+    return true;
+}
+
+
+static int32_t getThresholdCounts(float thresholdG, gRange_hw_t gRange, int32_t min, int32_t max){
+
+    double counts = round(thresholdG / getUnitPerCount(gRange, unit_g));
+
+    if(counts < min){
+        return min;
+    }
+    if(counts > max){
+        return max;
+    }
+    return (int32_t) counts;
+}
+
+
+static void setUnitConfig(kx132_config_t *kx132_config){
+
+    unit_config_t*  unitConfig  = &kx132_config->mainConfig->unitConfig;
+    gRange_hw_t     gRange      = kx132_config->mainConfig->gRange_hw;
+    trigger_data_t* triggerData = kx132_config->triggerData;
+
+    unitConfig->streamScale     = getUnitPerCount(gRange, unitConfig->stream);
+    unitConfig->triggerScale    = getUnitPerCount(gRange, unitConfig->trigger);
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        if(!isnan(unitConfig->offsetThresholdG[axis])){
+            triggerData->offsetThreshold->offsetThresholdValues[axis]   = getThresholdCounts(unitConfig->offsetThresholdG[axis], gRange, ZERO, UINT16_MAX);
+        }
+        if(!isnan(unitConfig->fixedThresholdG[axis])){
+            triggerData->fixedThresholds[axis]                          = getThresholdCounts(unitConfig->fixedThresholdG[axis], gRange, INT16_MIN, INT16_MAX);
+        }
+    }
+}
+
+
+void processInitFlags(  uint16_t            argc,
+                        char                *argv[],
+                        main_config_t       *mainConfig,
+                        trigger_config_t    *triggerConfig,
+                        trigger_data_t      *triggerData)
+{
+
+    if( ((argc-1) % 2) != 0){
+        printf("[config][warning] Flags might not be set correctly. Did you forget an argument?\n");
+    }
+
+    // for finding corresponding value to flag
+    outputDataRate_hw_t outputDataRateList[16] = {
+        odr_0_781_Hz,
+        odr_1_563_Hz,
+        odr_3_125_Hz,
+        odr_6_25_Hz,
+        odr_12_5_Hz,
+        odr_25_Hz,
+        odr_50_Hz,
+        odr_100_Hz,
+        odr_200_Hz,
+        odr_400_Hz,
+        odr_800_Hz,
+        odr_1600_Hz,
+        odr_3200_Hz,
+        odr_6400_Hz,
+        odr_12800_Hz,
+        odr_25600_Hz,
+    };
+
+    const char* mode_Flag           = "-mode";
+    const char* modeStream_Arg      = "stream";
+    const char* modeTrig_Arg        = "trig";
+
+    const char* odr_Flag            = "-odr";
+    const char* resolution_Flag     = "-res";
+    const char* gRange_Flag         = "-g";
+
+    const char* readMode_Flag       = "-read";
+    const char* readSync0_Arg       = "sync0";
+    const char* readSync1_Arg       = "sync1";
+    const char* readAsync_Arg       = "async";
+    const char* readBuffer_Arg      = "buffer";
+
+    const char* watermark_Flag      = "-wm";
+
+    const char* bufferMode_Flag     = "-bufmode";
+    const char* bufferStream_Arg    = "stream";
+    const char* bufferTrigger_Arg   = "trig";
+
+    const char* layout_Flag         = "-layout";
+    const char* layoutSoa_Arg       = "soa";
+    const char* layoutBlock_Arg     = "block";
+    const char* layoutMirror_Arg    = "mirror";
+    const char* historyFile_Flag    = "-histfile";
+    const char* historyMinutes_Flag = "-histmin";
+    const char* envelope_Flag       = "-envelope";
+    const char* pack_Flag           = "-pack";
+
+    const char* int1_Flag           = "-int1";
+    const char* int1Sim_Arg         = "sim";
+    const char* gpioChip_Flag       = "-gpiochip";
+
+    const char* spiBackend_Flag     = "-spi";
+    const char* spiBcm2835_Arg      = "bcm2835";
+    const char* spiSpidev_Arg       = "spidev";
+    const char* spiSim_Arg          = "sim";
+    const char* spiDevice_Flag      = "-spidev";
+    const char* spiClock_Flag       = "-spiclk";
+    const char* spiClockAuto_Arg    = "auto";
+
+    const char* simSignal_Flag      = "-simsig";
+    const char* simNone_Arg         = "none";
+    const char* simSine_Arg         = "sine";
+    const char* simNoise_Arg        = "noise";
+    const char* simImpulse_Arg      = "impulse";
+    const char* simAmplitude_Flag   = "-simamp";
+    const char* simFrequency_Flag   = "-simfreq";
+    const char* simNoise_Flag       = "-simnoise";
+    const char* simImpulse_Flag     = "-simimp";
+    const char* simSpeed_Flag       = "-simspeed";
+    const char* simSpiClock_Flag    = "-simspiclk";
+    const char* simFile_Flag        = "-simfile";
+
+    const char* rtPriority_Flag     = "-rtprio";
+    const char* rtCpu_Flag          = "-cpu";
+    const char* rtLockMemory_Flag   = "-mlock";
+
+    const char* adpOdr_Flag         = "-adpodr";
+
+    const char* wakeThreshold_Flag  = "-waketh";
+    const char* sleepThreshold_Flag = "-sleepth";
+    const char* wakeCount_Flag      = "-wakecnt";
+    const char* sleepCount_Flag     = "-sleepcnt";
+    const char* wakeOdr_Flag        = "-wakeodr";
+
+    const char* pollWait_Flag       = "-pollwait";
+    const char* pollSpin_Arg        = "spin";
+    const char* pollHybrid_Arg      = "hybrid";
+    const char* pollSpin_Flag       = "-pollspin";
+
+    const char* unitStream_Flag     = "-unitstream";
+    const char* unitTrigger_Flag    = "-unittrig";
+
+
+    uint32_t intArgValue = 0;
+
+
+    // start at 1, first argv is call to program
+    for(int i = 1; i < argc; i++){
+
+        //---------------------
+        //--- Use Mode  -------
+        //---------------------
+        if (!strncmp(argv[i], mode_Flag, strlen(mode_Flag))){
+            if(!strncmp(argv[i+1], modeStream_Arg, strlen(modeStream_Arg))){
+                mainConfig->useMode = streaming_mode;
+                i++; // increment i by 1, in case it was a correct argument for the flag
+            }
+            else if(!strncmp(argv[i+1], modeTrig_Arg, strlen(modeTrig_Arg))){
+                mainConfig->useMode = triggered_mode;
+                i++;
+            }
+        }
+
+        //---------------------
+        //--- Frequency  ------
+        //---------------------
+        if(!strncmp(argv[i], odr_Flag, strlen(odr_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                mainConfig->outputDataRate_hw   = outputDataRateList[intArgValue];
+                setTriggerTimeSamples(triggerConfig->triggerInfo, mainConfig->outputDataRate_hw);
+                i++;
+            }
+        }
+
+        //---------------------
+        //--- Resolution  -----
+        //---------------------
+        if(!strncmp(argv[i], resolution_Flag, strlen(resolution_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue == RESO_8_BIT){
+                    mainConfig->resolution_hw = resolution_8bit;
+                    i++; 
+                }
+                else if(intArgValue == RESO_16_BIT){
+                    mainConfig->resolution_hw = resolution_16bit;
+                    i++; 
+                }
+            }
+        }
+
+        //---------------------
+        //--- Read Mode  ------
+        //---------------------
+        if (!strncmp(argv[i], readMode_Flag, strlen(readMode_Flag))){
+
+            if(!strncmp(argv[i+1], readSync0_Arg, strlen(readSync0_Arg))){
+                mainConfig->readMode_hw = synchronous_read_0;
+                i++;
+            }
+
+            else if(!strncmp(argv[i+1], readSync1_Arg, strlen(readSync1_Arg))){
+                mainConfig->readMode_hw = synchronous_read_1;
+                i++;
+            }
+
+            else if(!strncmp(argv[i+1], readAsync_Arg, strlen(readAsync_Arg))){
+                mainConfig->readMode_hw = asynchronous_read;
+                i++;
+            }
+
+            else if(!strncmp(argv[i+1], readBuffer_Arg, strlen(readBuffer_Arg))){
+                mainConfig->readMode_hw = buffer_read;
+                i++;
+            }
+        }
+
+        //---------------------
+        //--- Watermark  ------
+        //---------------------
+        if(!strncmp(argv[i], watermark_Flag, strlen(watermark_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if((intArgValue > ZERO) && (intArgValue <= KX132_BUF_MAX_SAMPLES_8BIT)){
+                    mainConfig->bufferWatermark = intArgValue;
+                    i++;
+                }
+            }
+        }
+
+        // trig: sensor keeps the pre-trigger history, host only drains the buffer after a trigger event
+        if(!strncmp(argv[i], bufferMode_Flag, strlen(bufferMode_Flag))){
+            if(!strncmp(argv[i+1], bufferStream_Arg, strlen(bufferStream_Arg))){
+                mainConfig->bufferTrigger = false;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], bufferTrigger_Arg, strlen(bufferTrigger_Arg))){
+                mainConfig->bufferTrigger = true;
+                i++;
+            }
+        }
+
+        //---------------------
+        //--- Ringbuffer  -----
+        //---------------------
+        // block: axes interleaved per cache line, a trigger window is read as one stream instead of three
+        // mirror: one array per axis mapped twice, a trigger window never wraps
+        if(!strncmp(argv[i], layout_Flag, strlen(layout_Flag))){
+            if(!strncmp(argv[i+1], layoutSoa_Arg, strlen(layoutSoa_Arg))){
+                mainConfig->bufferLayout = rb_layout_soa;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], layoutBlock_Arg, strlen(layoutBlock_Arg))){
+                mainConfig->bufferLayout = rb_layout_interleaved;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], layoutMirror_Arg, strlen(layoutMirror_Arg))){
+                mainConfig->bufferLayout = rb_layout_mirrored;
+                i++;
+            }
+        }
+
+        // history file: minutes of pre-trigger history on disk, only the recent pages stay in RAM
+        if(!strncmp(argv[i], historyFile_Flag, strlen(historyFile_Flag))){
+            strncpy(mainConfig->historyPath, argv[i+1], HISTORY_PATH_LEN - 1);
+            mainConfig->historyPath[HISTORY_PATH_LEN - 1] = '\0';
+            i++;
+        }
+
+        if(!strncmp(argv[i], historyMinutes_Flag, strlen(historyMinutes_Flag))){
+            double minutes = 0;
+            if(sscanf(argv[i+1], "%lf", &minutes) == 1){
+                if(minutes > ZERO){
+                    mainConfig->historyMinutes = minutes;
+                    i++;
+                }
+            }
+        }
+
+        // envelopes: hours of min / max history for a few MB, requested by client with "envelope <seconds>"
+        if(!strncmp(argv[i], envelope_Flag, strlen(envelope_Flag))){
+            mainConfig->envelope = true;
+        }
+
+        // compressed history: MB of delta / bit-packed blocks, several times the pre-trigger history of the ringbuffer
+        if(!strncmp(argv[i], pack_Flag, strlen(pack_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if((intArgValue > 0) && (intArgValue <= PACK_SIZE_MAX_MB)){
+                    mainConfig->packSize = 1 << 20;
+                    while((mainConfig->packSize >> 20) < intArgValue){
+                        mainConfig->packSize <<= 1;
+                    }
+                    i++;
+                }
+            }
+        }
+
+        //---------------------
+        //--- INT1 GPIO  ------
+        //---------------------
+        if(!strncmp(argv[i], int1_Flag, strlen(int1_Flag))){
+            if(!strncmp(argv[i+1], int1Sim_Arg, strlen(int1Sim_Arg))){
+                mainConfig->int1Config.source = gpio_source_sim;
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                mainConfig->int1Config.source = gpio_source_cdev;
+                mainConfig->int1Config.line   = intArgValue;
+                i++;
+            }
+        }
+
+        if(!strncmp(argv[i], gpioChip_Flag, strlen(gpioChip_Flag))){
+            strncpy(mainConfig->int1Config.chipPath, argv[i+1], GPIO_CHIP_PATH_LEN - 1);
+            i++;
+        }
+
+        //---------------------
+        //--- SPI Backend  ----
+        //---------------------
+        if(!strncmp(argv[i], spiBackend_Flag, strlen(spiBackend_Flag))){
+            if(!strncmp(argv[i+1], spiBcm2835_Arg, strlen(spiBcm2835_Arg))){
+                mainConfig->spiConfig.backend = spi_backend_bcm2835;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], spiSpidev_Arg, strlen(spiSpidev_Arg))){
+                mainConfig->spiConfig.backend = spi_backend_spidev;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], spiSim_Arg, strlen(spiSim_Arg))){
+                mainConfig->spiConfig.backend = spi_backend_sim;
+                i++;
+            }
+        }
+
+        if(!strncmp(argv[i], spiDevice_Flag, strlen(spiDevice_Flag))){
+            strncpy(mainConfig->spiConfig.devicePath, argv[i+1], SPI_DEVICE_PATH_LEN - 1);
+            mainConfig->spiConfig.backend = spi_backend_spidev;
+            i++;
+        }
+
+        // auto: fastest clock passing the link check at startup, with a safety margin
+        if(!strncmp(argv[i], spiClock_Flag, strlen(spiClock_Flag))){
+            if(!strncmp(argv[i+1], spiClockAuto_Arg, strlen(spiClockAuto_Arg))){
+                mainConfig->spiConfig.autoClock = true;
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue > ZERO){
+                    mainConfig->spiConfig.clockHz   = intArgValue;
+                    mainConfig->spiConfig.autoClock = false;
+                    i++;
+                }
+            }
+        }
+
+        //---------------------
+        //--- Simulated KX132 -
+        //---------------------
+        if(!strncmp(argv[i], simSignal_Flag, strlen(simSignal_Flag))){
+            if(!strncmp(argv[i+1], simNone_Arg, strlen(simNone_Arg))){
+                mainConfig->simConfig.signal = sim_signal_none;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], simSine_Arg, strlen(simSine_Arg))){
+                mainConfig->simConfig.signal = sim_signal_sine;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], simNoise_Arg, strlen(simNoise_Arg))){
+                mainConfig->simConfig.signal = sim_signal_noise;
+                i++;
+            }
+            else if(!strncmp(argv[i+1], simImpulse_Arg, strlen(simImpulse_Arg))){
+                mainConfig->simConfig.signal = sim_signal_impulse;
+                i++;
+            }
+        }
+
+        // amplitude and noise in mg
+        if(!strncmp(argv[i], simAmplitude_Flag, strlen(simAmplitude_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                mainConfig->simConfig.amplitudeG = intArgValue / 1000.0;
+                i++;
+            }
+        }
 
-    // process user input coming from console and set config accordingly
-    if(argc > 1){
-        processInitFlags(argc, argv, mainConfig, triggerConfig, triggerData);
-    }
+        if(!strncmp(argv[i], simFrequency_Flag, strlen(simFrequency_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                mainConfig->simConfig.frequencyHz = intArgValue;
+                i++;
+            }
+        }
 
-    setTriggerTimeSamples(triggerConfig->triggerInfo, mainConfig->outputDataRate_hw);
+        if(!strncmp(argv[i], simNoise_Flag, strlen(simNoise_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                mainConfig->simConfig.noiseG = intArgValue / 1000.0;
+                i++;
+            }
+        }
 
-}
+        // time between impulses in ms
+        if(!strncmp(argv[i], simImpulse_Flag, strlen(simImpulse_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue > ZERO){
+                    mainConfig->simConfig.impulsePeriodS = intArgValue / 1000.0;
+                    i++;
+                }
+            }
+        }
 
+        if(!strncmp(argv[i], simSpeed_Flag, strlen(simSpeed_Flag))){
+            double speed = 0;
+            if(sscanf(argv[i+1], "%lf", &speed) == 1){
+                if(speed > ZERO){
+                    mainConfig->simConfig.timeScale = speed;
+                    i++;
+                }
+            }
+        }
 
-void processInitFlags(  uint16_t            argc,
-                        char                *argv[],
-                        main_config_t       *mainConfig,
-                        trigger_config_t    *triggerConfig,
-                        trigger_data_t      *triggerData)
-{
+        if(!strncmp(argv[i], simSpiClock_Flag, strlen(simSpiClock_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue > ZERO){
+                    mainConfig->simConfig.maxSpiClockHz = intArgValue;
+                    i++;
+                }
+            }
+        }
 
-    if( ((argc-1) % 2) != 0){
-        printf("[config][warning] Flags might not be set correctly. Did you forget an argument?\n");
-    }
+        if(!strncmp(argv[i], simFile_Flag, strlen(simFile_Flag))){
+            strncpy(mainConfig->simConfig.waveformPath, argv[i+1], SIM_PATH_LEN - 1);
+            mainConfig->simConfig.waveformPath[SIM_PATH_LEN - 1] = '\0';
+            mainConfig->simConfig.signal = sim_signal_file;
+            i++;
+        }
 
-    // for finding corresponding value to flag
-    outputDataRate_hw_t outputDataRateList[16] = {
-        odr_0_781_Hz,
-        odr_1_563_Hz,
-        odr_3_125_Hz,
-        odr_6_25_Hz,
-        odr_12_5_Hz,
-        odr_25_Hz,
-        odr_50_Hz,
-        odr_100_Hz,
-        odr_200_Hz,
-        odr_400_Hz,
-        odr_800_Hz,
-        odr_1600_Hz,
-        odr_3200_Hz,
-        odr_6400_Hz,
-        odr_12800_Hz,
-        odr_25600_Hz,
-    };
+        //---------------------
+        //--- Real-Time  ------
+        //---------------------
+        if(!strncmp(argv[i], rtPriority_Flag, strlen(rtPriority_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue <= RT_PRIORITY_MAX){
+                    mainConfig->rtConfig.priority = intArgValue;
+                    i++;
+                }
+            }
+        }
 
-    const char* mode_Flag           = "-mode";
-    const char* modeStream_Arg      = "stream";
-    const char* modeTrig_Arg        = "trig";
+        if(!strncmp(argv[i], rtCpu_Flag, strlen(rtCpu_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue <= RT_CPU_MAX){
+                    mainConfig->rtConfig.cpu = intArgValue;
+                    i++;
+                }
+            }
+        }
 
-    const char* odr_Flag            = "-odr";
-//  const char* resolution_Flag     = "-res";
-    const char* gRange_Flag         = "-g";
+        if(!strncmp(argv[i], rtLockMemory_Flag, strlen(rtLockMemory_Flag))){
+            mainConfig->rtConfig.lockMemory = true;
+        }
 
-    const char* readMode_Flag       = "-read";
-    const char* readSync0_Arg       = "sync0";
-//  const char* readSync1_Arg       = "sync1";
-    const char* readAsync_Arg       = "async";
+        //---------------------
+        //--- Advanced Data Path
+        //---------------------
+        if(!strncmp(argv[i], adpOutput_Flag, strlen(adpOutput_Flag))){
+            if(setAdpOutput(argv[i+1], &mainConfig->adpConfig)){
+                i++;
+            }
+        }
 
+        if(!strncmp(argv[i], adpOdr_Flag, strlen(adpOdr_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue <= odr_25600_Hz){
+                    mainConfig->adpConfig.outputDataRate = outputDataRateList[intArgValue];
+                    i++;
+                }
+            }
+        }
 
-    uint32_t intArgValue = 0;
+        if(!strncmp(argv[i], adpRmsAverage_Flag, strlen(adpRmsAverage_Flag))){
+            if(setAdpRmsAverage(argv[i+1], &mainConfig->adpConfig)){
+                i++;
+            }
+        }
 
+        if(!strncmp(argv[i], adpFilter1_Flag, strlen(adpFilter1_Flag))){
+            if(setAdpFilter1(argv[i+1], &mainConfig->adpConfig)){
+                i++;
+            }
+        }
 
-    // start at 1, first argv is call to program
-    for(int i = 1; i < argc; i++){
+        if(!strncmp(argv[i], adpFilter2_Flag, strlen(adpFilter2_Flag))){
+            if(setAdpFilter2(argv[i+1], &mainConfig->adpConfig)){
+                i++;
+            }
+        }
 
         //---------------------
-        //--- Use Mode  -------
+        //--- Wake-Up / Back-To-Sleep
         //---------------------
-        if (!strncmp(argv[i], mode_Flag, strlen(mode_Flag))){
-            if(!strncmp(argv[i+1], modeStream_Arg, strlen(modeStream_Arg))){
-                mainConfig->useMode = streaming_mode;
-                i++; // increment i by 1, in case it was a correct argument for the flag
+        // thresholds in mg, converted to counts of the engine
+        if(!strncmp(argv[i], wakeThreshold_Flag, strlen(wakeThreshold_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if((intArgValue > ZERO) && (intArgValue <= WAKE_THRESHOLD_MAX * WAKE_MG_PER_COUNT)){
+                    mainConfig->wakeConfig.enabled          = true;
+                    mainConfig->wakeConfig.wakeThreshold    = (intArgValue / WAKE_MG_PER_COUNT) + 0.5;
+                    i++;
+                }
             }
-            else if(!strncmp(argv[i+1], modeTrig_Arg, strlen(modeTrig_Arg))){
-                mainConfig->useMode = triggered_mode;
-                i++;
+        }
+
+        if(!strncmp(argv[i], sleepThreshold_Flag, strlen(sleepThreshold_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if((intArgValue > ZERO) && (intArgValue <= WAKE_THRESHOLD_MAX * WAKE_MG_PER_COUNT)){
+                    mainConfig->wakeConfig.sleepThreshold   = (intArgValue / WAKE_MG_PER_COUNT) + 0.5;
+                    i++;
+                }
             }
         }
 
-        //---------------------
-        //--- Frequency  ------
-        //---------------------
-        if(!strncmp(argv[i], odr_Flag, strlen(odr_Flag))){
+        if(!strncmp(argv[i], wakeCount_Flag, strlen(wakeCount_Flag))){
             if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
-                mainConfig->outputDataRate_hw   = outputDataRateList[intArgValue];
-                setTriggerTimeSamples(triggerConfig->triggerInfo, mainConfig->outputDataRate_hw);
-                i++;
+                if((intArgValue > ZERO) && (intArgValue <= UINT8_MAX)){
+                    mainConfig->wakeConfig.wakeCount = intArgValue;
+                    i++;
+                }
             }
         }
 
-        // Left, in case it's needed later.
-        //---------------------
-        //--- Resolution  -----
-        //---------------------
-        // if(!strncmp(argv[i], resolution_Flag, strlen(resolution_Flag))){
-        //     if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
-        //         if(intArgValue == RESO_8_BIT){
-        //             mainConfig->resolution_hw = resolution_8bit;
-        //             i++; 
-        //         }
-        //         else if(intArgValue == RESO_16_BIT){
-        //             mainConfig->resolution_hw = resolution_16bit;
-        //             i++; 
-        //         }
-        //     }
-        // }
+        if(!strncmp(argv[i], sleepCount_Flag, strlen(sleepCount_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if((intArgValue > ZERO) && (intArgValue <= UINT8_MAX)){
+                    mainConfig->wakeConfig.sleepCount = intArgValue;
+                    i++;
+                }
+            }
+        }
+
+        if(!strncmp(argv[i], wakeOdr_Flag, strlen(wakeOdr_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue <= WAKE_ODR_MAX){
+                    mainConfig->wakeConfig.outputDataRate = intArgValue;
+                    i++;
+                }
+            }
+        }
 
         //---------------------
-        //--- Read Mode  ------
+        //--- Data-Ready Wait
         //---------------------
-        if (!strncmp(argv[i], readMode_Flag, strlen(readMode_Flag))){
-
-            if(!strncmp(argv[i+1], readSync0_Arg, strlen(readSync0_Arg))){
-                mainConfig->readMode_hw = synchronous_read_0;
+        // spin: busy polling, hybrid: sleep until shortly before the next sample is due
+        if(!strncmp(argv[i], pollWait_Flag, strlen(pollWait_Flag))){
+            if(!strncmp(argv[i+1], pollSpin_Arg, strlen(pollSpin_Arg))){
+                mainConfig->waitConfig.hybrid = false;
                 i++;
             }
-
-            // else if(!strncmp(argv[i+1], readSync1_Arg, strlen(readSync1_Arg))){
-            //     mainConfig->readMode_hw = synchronous_read_1;
-            //     i++;
-            // }
-
-            else if(!strncmp(argv[i+1], readAsync_Arg, strlen(readAsync_Arg))){
-                mainConfig->readMode_hw = asynchronous_read;
+            else if(!strncmp(argv[i+1], pollHybrid_Arg, strlen(pollHybrid_Arg))){
+                mainConfig->waitConfig.hybrid = true;
                 i++;
             }
         }
 
+        if(!strncmp(argv[i], pollSpin_Flag, strlen(pollSpin_Flag))){
+            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+                if(intArgValue <= WAIT_SPIN_MAX_US){
+                    mainConfig->waitConfig.spinUs = intArgValue;
+                    i++;
+                }
+            }
+        }
+
         //---------------------
         //--- G-Range  --------
         //---------------------
@@ -316,6 +1259,20 @@ void processInitFlags(  uint16_t            argc,
             }
         }
 
+        //---------------------
+        //--- Output Units  ---
+        //---------------------
+        if(!strncmp(argv[i], unitStream_Flag, strlen(unitStream_Flag))){
+            if(setOutputUnit(argv[i+1], &mainConfig->unitConfig.stream)){
+                i++;
+            }
+        }
+        if(!strncmp(argv[i], unitTrigger_Flag, strlen(unitTrigger_Flag))){
+            if(setOutputUnit(argv[i+1], &mainConfig->unitConfig.trigger)){
+                i++;
+            }
+        }
+
         //---------------------
         //--- Trig Mode  ------
         //---------------------
@@ -398,25 +1355,37 @@ void processInitFlags(  uint16_t            argc,
         //--- Offset Thres  ---
         //---------------------
         if(!strncmp(argv[i], xOffsetThres_Flag, strlen(xOffsetThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.offsetThresholdG[X_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                     triggerData->offsetThreshold->offsetThresholdValues[X_INDEX] = intArgValue;
+                    mainConfig->unitConfig.offsetThresholdG[X_INDEX]             = NAN;
                     i++;
                 }
             }
         }
         if(!strncmp(argv[i], yOffsetThres_Flag, strlen(yOffsetThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.offsetThresholdG[Y_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                     triggerData->offsetThreshold->offsetThresholdValues[Y_INDEX] = intArgValue;
+                    mainConfig->unitConfig.offsetThresholdG[Y_INDEX]             = NAN;
                     i++;
                 }
             }
         }
         if(!strncmp(argv[i], zOffsetThres_Flag, strlen(zOffsetThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.offsetThresholdG[Z_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                     triggerData->offsetThreshold->offsetThresholdValues[Z_INDEX] = intArgValue;
+                    mainConfig->unitConfig.offsetThresholdG[Z_INDEX]             = NAN;
                     i++;
                 }
             }
@@ -426,25 +1395,37 @@ void processInitFlags(  uint16_t            argc,
         //--- Fixed Thres  ----
         //---------------------
         if(!strncmp(argv[i], xFixedThres_Flag, strlen(xFixedThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.fixedThresholdG[X_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[X_INDEX]  = intArgValue;
+                    mainConfig->unitConfig.fixedThresholdG[X_INDEX] = NAN;
                     i++;
                 }
             }
         }
         if(!strncmp(argv[i], yFixedThres_Flag, strlen(yFixedThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.fixedThresholdG[Y_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[Y_INDEX]  = intArgValue;
+                    mainConfig->unitConfig.fixedThresholdG[Y_INDEX] = NAN;
                     i++;
                 }
             }
         }
         if(!strncmp(argv[i], zFixedThres_Flag, strlen(zFixedThres_Flag))){
-            if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
+            if(parseThresholdG(argv[i+1], &mainConfig->unitConfig.fixedThresholdG[Z_INDEX])){
+                i++;
+            }
+            else if(sscanf(argv[i+1], "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[Z_INDEX]  = intArgValue;
+                    mainConfig->unitConfig.fixedThresholdG[Z_INDEX] = NAN;
                     i++;
                 }
             }
@@ -455,10 +1436,21 @@ void processInitFlags(  uint16_t            argc,
 }
 
 
-bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_data_t* triggerData, outputDataRate_hw_t outputDataRate){
+bool processRuntimeFlags(char *data, kx132_sensor_t *sensor){
+
+    trigger_config_t*       triggerConfig   = sensor->config->triggerConfig;
+    trigger_data_t*         triggerData     = sensor->config->triggerData;
+    outputDataRate_hw_t     outputDataRate  = sensor->outputDataRate;
+    adp_config_t*           adpConfig       = &sensor->config->mainConfig->adpConfig;
+    adpOutput_hw_t          adpOutput       = adpConfig->output;
+    gRange_hw_t             gRange          = sensor->config->mainConfig->gRange_hw;
 
     const char* exit_Flag       = "exit";
+    const char* stats_Flag      = "stats";
+    const char* resetStats_Flag = "resetstats";
+    const char* envelope_Flag   = "envelope";
     uint32_t    intArgValue     = 0;
+    float       thresholdG      = 0;
 
 
     char *strPtr = strtok (data," ");
@@ -471,6 +1463,54 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
             return true;
         }
 
+        //---------------------
+        //--- Statistics  -----
+        //---------------------
+        if(!strncmp(strPtr, stats_Flag, strlen(stats_Flag))){
+            kx132_print_stats(sensor);
+        }
+        if(!strncmp(strPtr, resetStats_Flag, strlen(resetStats_Flag))){
+            kx132_reset_sample_stats(sensor);
+        }
+
+        //---------------------
+        //--- Advanced Data Path
+        //---------------------
+        // switching ADP on or off changes output data rate and read registers, only filter / rms can be swapped
+        if(!strncmp(strPtr, adpOutput_Flag, strlen(adpOutput_Flag))){
+            strPtr = strtok (NULL, " ");
+            if((strPtr != NULL) && setAdpOutput(strPtr, adpConfig)){
+                if((adpConfig->output == adp_output_off) != (adpOutput == adp_output_off)){
+                    printf("[config][warning] ADP can only be switched on or off at start.\n");
+                    adpConfig->output = adpOutput;
+                }
+                else{
+                    sensor->adpUpdate = true;
+                }
+            }
+        }
+
+        if(!strncmp(strPtr, adpRmsAverage_Flag, strlen(adpRmsAverage_Flag))){
+            strPtr = strtok (NULL, " ");
+            if((strPtr != NULL) && setAdpRmsAverage(strPtr, adpConfig)){
+                sensor->adpUpdate = (adpOutput != adp_output_off);
+            }
+        }
+
+        if(!strncmp(strPtr, adpFilter1_Flag, strlen(adpFilter1_Flag))){
+            strPtr = strtok (NULL, " ");
+            if((strPtr != NULL) && setAdpFilter1(strPtr, adpConfig)){
+                sensor->adpUpdate = (adpOutput != adp_output_off);
+            }
+        }
+
+        if(!strncmp(strPtr, adpFilter2_Flag, strlen(adpFilter2_Flag))){
+            strPtr = strtok (NULL, " ");
+            if((strPtr != NULL) && setAdpFilter2(strPtr, adpConfig)){
+                sensor->adpUpdate = (adpOutput != adp_output_off);
+            }
+        }
+
         //---------------------
         //--- Trig Mode  ------
         //---------------------
@@ -552,7 +1592,10 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         //---------------------
         if(!strncmp(strPtr, xOffsetThres_Flag, strlen(xOffsetThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->offsetThreshold->offsetThresholdValues[X_INDEX] = getThresholdCounts(thresholdG, gRange, ZERO, UINT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                    triggerData->offsetThreshold->offsetThresholdValues[X_INDEX] = intArgValue;
                 }
@@ -560,7 +1603,10 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         }
         if(!strncmp(strPtr, yOffsetThres_Flag, strlen(yOffsetThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->offsetThreshold->offsetThresholdValues[Y_INDEX] = getThresholdCounts(thresholdG, gRange, ZERO, UINT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                     triggerData->offsetThreshold->offsetThresholdValues[Y_INDEX] = intArgValue;
                 }
@@ -568,7 +1614,10 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         }
         if(!strncmp(strPtr, zOffsetThres_Flag, strlen(zOffsetThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->offsetThreshold->offsetThresholdValues[Z_INDEX] = getThresholdCounts(thresholdG, gRange, ZERO, UINT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= ZERO) && (intArgValue <= UINT16_MAX)){
                     triggerData->offsetThreshold->offsetThresholdValues[Z_INDEX] = intArgValue;
                 }
@@ -580,7 +1629,10 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         //---------------------
         if(!strncmp(strPtr, xFixedThres_Flag, strlen(xFixedThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->fixedThresholds[X_INDEX]  = getThresholdCounts(thresholdG, gRange, INT16_MIN, INT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[X_INDEX]  = intArgValue;
                 }
@@ -588,7 +1640,10 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         }
         if(!strncmp(strPtr, yFixedThres_Flag, strlen(yFixedThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->fixedThresholds[Y_INDEX]  = getThresholdCounts(thresholdG, gRange, INT16_MIN, INT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[Y_INDEX]  = intArgValue;
                 }
@@ -596,13 +1651,35 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
         }
         if(!strncmp(strPtr, zFixedThres_Flag, strlen(zFixedThres_Flag))){
             strPtr = strtok (NULL, " ");
-            if(sscanf(strPtr, "%d", &intArgValue) == 1){
+            if(parseThresholdG(strPtr, &thresholdG)){
+                triggerData->fixedThresholds[Z_INDEX]  = getThresholdCounts(thresholdG, gRange, INT16_MIN, INT16_MAX);
+            }
+            else if(sscanf(strPtr, "%d", &intArgValue) == 1){
                 if((intArgValue >= INT16_MIN) && (intArgValue <= INT16_MAX)){
                     triggerData->fixedThresholds[Z_INDEX]  = intArgValue;
                 }
             }
         }
 
+        //---------------------
+        //--- Envelopes  ------
+        //---------------------
+        // queued by trigger evaluation, sent by the sending thread between trigger events
+        if(!strncmp(strPtr, envelope_Flag, strlen(envelope_Flag))){
+            strPtr = strtok (NULL, " ");
+            if((strPtr != NULL) && (sscanf(strPtr, "%u", &intArgValue) == 1) && (intArgValue > ZERO)){
+                if(sensor->config->mainConfig->envelope){
+                    atomic_store(&sensor->envelopeRequest, intArgValue);
+                }
+                else{
+                    printf("[config][warning] Envelopes of sensor %d need \"-envelope\" at start.\n", sensor->id);
+                }
+            }
+            if(strPtr == NULL){
+                break;
+            }
+        }
+
         strPtr = strtok (NULL, " ");
     }
 
@@ -611,14 +1688,42 @@ bool processRuntimeFlags(char *data, trigger_config_t* triggerConfig, trigger_da
 }
 
 
+double getOutputDataRateHz(outputDataRate_hw_t outputDataRate){
+    return outputDataRate_double_list[outputDataRate & 0xF];
+}
+
+
+float getUnitPerCount(gRange_hw_t gRange, outputUnit_t unit){
+    switch (unit)
+    {
+        case unit_g:
+            return gPerCount_list[(gRange >> 3) & 0x3];
+
+        case unit_ms2:
+            return gPerCount_list[(gRange >> 3) & 0x3] * STANDARD_GRAVITY;
+
+        default:
+            return 1;
+    }
+}
+
+
+outputDataRate_hw_t getSampleOutputDataRate(main_config_t *mainConfig){
+    if(mainConfig->adpConfig.output != adp_output_off){
+        return mainConfig->adpConfig.outputDataRate;
+    }
+    return mainConfig->outputDataRate_hw;
+}
+
+
 void setTriggerTimeSamplesBefore(trigger_info_t *triggerInfo, outputDataRate_hw_t outputDataRate){
-    triggerInfo->samplesBeforeTrig   = (uint32_t) ( ceil( outputDataRate_double_list[outputDataRate] * triggerInfo->timeBeforeTrig / 1000) );
+    triggerInfo->samplesBeforeTrig   = (uint32_t) ( ceil( getTriggerSampleRate(triggerInfo, outputDataRate) * triggerInfo->timeBeforeTrig / 1000) );
     triggerInfo->numberOfSamples     = triggerInfo->samplesBeforeTrig + TRIGGER_INDEX_VALUE + triggerInfo->samplesAfterTrig;
 }
 
 
 void setTriggerTimeSamplesAfter(trigger_info_t *triggerInfo, outputDataRate_hw_t outputDataRate){
-    triggerInfo->samplesAfterTrig   = (uint32_t) ( ceil( outputDataRate_double_list[outputDataRate] * triggerInfo->timeAfterTrig / 1000) );
+    triggerInfo->samplesAfterTrig   = (uint32_t) ( ceil( getTriggerSampleRate(triggerInfo, outputDataRate) * triggerInfo->timeAfterTrig / 1000) );
     triggerInfo->numberOfSamples     = triggerInfo->samplesBeforeTrig + TRIGGER_INDEX_VALUE + triggerInfo->samplesAfterTrig;
 }
 
@@ -629,6 +1734,20 @@ void setTriggerTimeSamples(trigger_info_t *triggerInfo, outputDataRate_hw_t outp
 }
 
 
+void setTriggerSampleRate(trigger_info_t *triggerInfo, double sampleRateHz, outputDataRate_hw_t outputDataRate){
+    triggerInfo->sampleRateHz = sampleRateHz;
+    setTriggerTimeSamples(triggerInfo, outputDataRate);
+}
+
+
+static double getTriggerSampleRate(trigger_info_t *triggerInfo, outputDataRate_hw_t outputDataRate){
+    if(triggerInfo->sampleRateHz > 0){
+        return triggerInfo->sampleRateHz;
+    }
+    return outputDataRate_double_list[outputDataRate];
+}
+
+
 void setOffsetThresholds(trigger_data_t* triggerData){
     for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
         triggerData->offsetThreshold->positiveThresholdValues[axis] = triggerData->normalizedData[axis] + 
@@ -640,38 +1759,27 @@ void setOffsetThresholds(trigger_data_t* triggerData){
 }
 
 
-void normalizeThresholds(readMode_hw_t readMode, trigger_data_t* triggerData){
+void normalizeThresholds(kx132_sensor_t *sensor){
+
+    readMode_hw_t   readMode        = sensor->config->mainConfig->readMode_hw;
+    trigger_data_t* triggerData     = sensor->config->triggerData;
 
-    uint8_t     xyzRawData      [NUMBER_OF_CHANNELS];
+    kx132_raw_block_t rawBlock;
     int16_t     xyzFormatted    [NUMBER_OF_AXES];
 
     int32_t     xSum            = 0;
     int32_t     ySum            = 0;
     int32_t     zSum            = 0;
     uint32_t    count           = 0;
+    uint16_t    samplesRead     = 0;
 
-    if(readMode == synchronous_read_0){
-        while(count <= NUM_NORMALIZE_SAMPLES){
-            if(!kx_132_sync0_read_raw_data(xyzRawData)){
-                continue;
-            }
-
-            // converting of raw xyzRawData to signed 16-Bit
-            convertRawArray(xyzRawData, xyzFormatted);
-
-            xSum += xyzFormatted[X_INDEX];
-            ySum += xyzFormatted[Y_INDEX];
-            zSum += xyzFormatted[Z_INDEX];
+    while(count < NUM_NORMALIZE_SAMPLES){
+        samplesRead = kx132_read_raw_samples(sensor, readMode, &rawBlock, NULL);
 
-            count++;
-        }
-    }
-    else if(readMode == asynchronous_read){
-        while(count <= NUM_NORMALIZE_SAMPLES){
-            kx132_async_read_raw_data(xyzRawData);
+        for(uint16_t i = 0; (i < samplesRead) && (count < NUM_NORMALIZE_SAMPLES); i++){
 
             // converting of raw xyzRawData to signed 16-Bit
-            convertRawArray(xyzRawData, xyzFormatted);
+            kx132_convert_raw_sample(sensor, &rawBlock.data[i * sensor->bytesPerSample], xyzFormatted);
 
             xSum += xyzFormatted[X_INDEX];
             ySum += xyzFormatted[Y_INDEX];
@@ -16,8 +16,12 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 ///\endcond
 
+#include <drv_kx132.h>
 #include <regs_kx132.h>
 #include <spi_wrapper.h>
 #include <config_kx132.h>
@@ -26,37 +30,268 @@
 #include <utility.h>
 #include <trigger.h>
 #include <tcp.h>
+#include <gpio_event.h>
+#include <rt_thread.h>
+#include <timestamp.h>
+#include <spsc_queue.h>
 #include <debug_macros.h>
 
 
+#define INS2_DRDY                   0x10    ///< Data-Ready-Bit in INS2_REG
+#define BUF_CNTL2_BUFE              0x80    ///< Enables the sample buffer
+#define BUF_CNTL2_BRES_16_BIT       0x40    ///< Sample buffer stores 16-Bit values, cleared it stores only the high bytes
+#define BUF_CNTL2_BM_STREAM         0x01    ///< Stream-Mode: oldest samples are discarded when buffer is full
+#define BUF_CNTL2_BM_TRIGGER        0x02    ///< Trigger-Mode: SMP_TH samples before trigger event are kept, then filled until full
+#define BUF_CNTL2_BM_MASK           0x03
+#define BUF_STATUS2_BUF_TRIG        0x80    ///< Trigger event occurred, cleared by BUF_CLEAR
+#define BUF_STATUS2_SMP_LEV_H       0x03    ///< Bits 9:8 of the number of bytes stored in the sample buffer
+#define BUF_STATUS_LEN              2       ///< BUF_STATUS1 + BUF_STATUS2 are read in one burst
+#define ASYNC_BUF_CLEAR_BYTES       (KX132_BUF_MAX_SAMPLES_8BIT / 2 * NUMBER_OF_CHANNELS_8BIT)  ///< async clears the counting sample buffer at this level, long before it is full
+#define INC1_IEN1_ACTIVE_HIGH       0x30    ///< Enables INT1-PIN, active high, latched until INT_REL is read
+#define INC4_DRDYI1                 0x10    ///< Routes Data-Ready-Interrupt to INT1
+#define INC4_WMI1                   0x20    ///< Routes Watermark-Interrupt to INT1
+#define INC4_WUFI1                  0x02    ///< Routes Wake-Up-Interrupt to INT1
+#define INC4_BFI1                   0x40    ///< Routes Buffer-Full-Interrupt to INT1
+#define INC2_WAKE_ALL_DIRECTIONS    0x3F    ///< Motion on every axis in both directions wakes up the sensor
+#define INS3_WUFS                   0x80    ///< Wake-up detected, cleared by INT_REL
+#define INS3_BTS                    0x40    ///< Back-to-sleep detected, cleared by INT_REL
+#define STATUS_REG_WAKE             0x01    ///< Wake-up engine is in wake state
+#define WAKE_STATUS_LEN             2       ///< INS3 + STATUS_REG are read in one burst
+#define CNTL4_TH_MODE               0x40    ///< Wake-up / back-to-sleep thresholds relative to last sample of engine
+#define CNTL4_WUF_EN                0x20    ///< Enables the wake-up engine
+#define CNTL4_BTS_EN                0x10    ///< Enables the back-to-sleep engine
+#define BTSWUFTH_WUFTH_H_SHIFT      4       ///< Bits 10:8 of wake-up threshold in bits 6:4
+#define EVENT_POLL_US               10000   ///< status is polled this often while idling without INT1
+#define EVENT_INT1_TIMEOUT_US       1000000 ///< waiting for wake-up / trigger event on INT1 times out, recovers from missed edges
+#define CNTL1_PC1                   0x80    ///< Operating mode, most control registers can only be written in standby
+#define ADP_CNTL1_RMS_AVC_SHIFT     4       ///< RMS_AVC: 2^(n+1) samples averaged
+#define ADP_CNTL2_ADP_EN            0x80    ///< Enables the Advanced Data Path
+#define ADP_CNTL2_ADP_FLT2_BYP      0x10    ///< Bypasses filter-2
+#define ADP_CNTL2_ADP_FLT1_BYP      0x08    ///< Bypasses filter-1
+#define ADP_CNTL2_ADP_RMS_OSEL      0x02    ///< RMS instead of filtered samples in XADP registers
+#define ADP_CNTL2_ADP_BUF_SEL       0x01    ///< ADP output instead of raw samples in sample buffer
+
+#define USEC_PER_SEC                1000000
+#define NSEC_PER_USEC               1000
+#define NSEC_PER_SEC                1000000000
+#define INT1_TIMEOUT_PERIODS        4       ///< waiting for INT1 times out after this many expected periods
+#define INT1_TIMEOUT_MIN_US         1000    ///< lower bound of INT1 timeout
+
+#define WAIT_SPIN_POLLS             4       ///< more polls per sample shorten the spin of hybrid wait
+#define WAIT_SPIN_STEP_US           10      ///< spin of hybrid wait grows at least by this, if a sample was already waiting
+
+#define SOFTWARE_RESET_DELAY_US     2000    ///< KX132 does not respond correctly until software reset is finished
+#define SPI_CHECK_REPETITIONS       100     ///< link checks every clock has to pass without error
+#define SPI_CLOCK_MARGIN_STEPS      1       ///< calibrated clock is this many steps slower than the fastest passing one
+#define SPI_TIMING_READS            1000    ///< sample reads for measuring the transfer time
+#define SPI_CHECK_REG               BUF_CNTL1_REG_ADDR  ///< read / write register without side effects while the buffer is off
+
+
+#define RUNTIME_SENSOR_FLAG         "sensor"    ///< runtime input "sensor <n> ..." only changes sensor n
+
+
 static bool MAIN_LOOP = true;
 
+static const uint32_t   spiClockStepsHz [] = {20000000, 16000000, 12500000, 10000000, 8000000, 6250000, 5000000, 4000000, 2000000, 1000000};  ///< fast to slow
+
+static kx132_sensor_t*  sensors         [KX132_MAX_SENSORS];    ///< sensors registered by kx132_init(), changed by runtime config
+static uint8_t          numberOfSensors = 0;
+
+
+/**
+ * @brief Requests the GPIO connected to INT1 and calculates the timeout for waiting.
+ * 
+ * @param sensor            pointer to sensor containing INT1 config and output data rate
+ * @param samplesPerEdge    number of samples between two edges (1 for Data-Ready, watermark for sample buffer)
+ * @return true             if success
+ * @return false            if error
+ */
+static bool kx132_int1_init(kx132_sensor_t *sensor, uint8_t samplesPerEdge);
+
+
+/**
+ * @brief Copies the sample in batchRawData to xyzRawData.
+ * 
+ *  XOUT_H, YOUT_H and ZOUT_H are not consecutive, so all output registers are read and 8-Bit keeps the high bytes.
+ * 
+ * @param sensor        pointer to sensor
+ * @param xyzRawData    pointer to buffer where raw data should be saved (bytesPerSample bytes)
+ */
+static void kx132_copy_raw_sample(kx132_sensor_t *sensor, uint8_t* xyzRawData);
+
+
+/**
+ * @brief Writes output data rate, RMS average and filter coefficients of the Advanced Data Path.
+ * 
+ * @note KX132 has to be in standby (PC1 = 0).
+ * 
+ * @param sensor        pointer to sensor containing ADP config
+ */
+static void kx132_adp_configure(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Applies ADP settings changed at runtime, called by the reading thread.
+ * 
+ *  Puts the KX132 in standby for writing the registers, the sample buffer is cleared afterwards.
+ * 
+ * @param sensor        pointer to sensor
+ */
+static void kx132_adp_update(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Writes output data rate, thresholds and counters of the wake-up / back-to-sleep engine.
+ * 
+ * @note KX132 has to be in standby (PC1 = 0).
+ * 
+ * @param sensor        pointer to sensor containing wake config
+ */
+static void kx132_wake_configure(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Idles until the wake-up engine detects motion, called by the reading thread in trigger mode.
+ * 
+ *  Waits on INT1, if it is routed to wake-up, otherwise sleeps EVENT_POLL_US. Then INS3 / STATUS_REG
+ *  are read once. The sample buffer keeps filling meanwhile and holds the history before wake-up.
+ * 
+ * @param sensor        pointer to sensor
+ * @return true         if sensor is awake, reading starts again
+ * @return false        if sensor is still asleep
+ */
+static bool kx132_wait_for_wake(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Checks if the back-to-sleep engine detected a quiet sensor.
+ * 
+ * @param sensor        pointer to sensor
+ * @return true         if sensor went back to sleep, reading thread idles
+ * @return false        if sensor is still awake
+ */
+static bool kx132_back_to_sleep(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Sleeps until shortly before the next sample is due, called before every poll of sync0 / async.
+ * 
+ *  The due time follows from the estimated time of the last sample and the estimated period.
+ *  Once a poll found no new sample, the reading loop spins until it arrives.
+ * 
+ * @param sensor        pointer to sensor
+ */
+static void kx132_wait_for_sample(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Adapts the spin of hybrid wait to the polls needed for the last sample.
+ * 
+ *  A sample that was already waiting doubles the spin (up to half a period), many polls shorten it
+ *  down to the configured minimum.
+ * 
+ * @param sensor        pointer to sensor
+ */
+static void kx132_wait_adapt(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Hands a filled block over to the processing thread, called by the reading thread.
+ * 
+ * @param sensor        pointer to sensor
+ * @param block         block taken from spsc_write_slot() with numberOfSamples set
+ * @param restart       thresholds were normalized again before this block
+ */
+static void kx132_queue_block(kx132_sensor_t *sensor, kx132_block_t* block, bool restart);
+
+
+/**
+ * @brief Checks the SPI link at the current clock with repeated reads of known registers and write-readbacks.
+ * 
+ * @param sensor        pointer to sensor
+ * @return true         if every check passed
+ * @return false        if a single byte was wrong
+ */
+static bool kx132_spi_check_link(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Takes blocks read in streaming mode from the queue and sends them over tcp to client.
+ * 
+ * @param sensor 			pointer to sensor, its resolution and output unit are used
+ */
+void kx132_streaming_mode(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Takes blocks read in trigger mode from the queue, writes them to ringbuffer and detects triggers.
+ * 
+ * 	When trigger occurs, blocks are taken as long as specified in triggerConfig->samplesAfterTrig,
+ * 	then a view of the event in the ringbuffer is queued for kx132_event_sender(), the samples are not copied.
+ * 	With a history file the ringbuffers are mapped from it and continue after the samples of the last run.
+ * 	With "-pack" completed blocks are compressed, the older part of a window comes from the compressed ring.
+ * 
+ * @param sensor 			pointer to sensor containing buffersize, trigger settings, thresholds and normalized data
+ */
+void kx132_trigger_mode(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Sends the trigger events queued by kx132_trigger_mode() over tcp to client.
+ * 
+ * 	Runs in its own thread, a slow client only fills the event slots and never stalls reading.
+ * 	Evaluation only waits, if the ringbuffer caught up with a window still being sent.
+ * 
+ * @param kx_sensor 		pointer to sensor
+ */
+static void *kx132_event_sender(void *kx_sensor);
+
+
+/**
+ * @brief Waits until a push does not overwrite a window the sending thread still reads, called by trigger evaluation.
+ * 
+ *  Blocks queue up meanwhile, so every wait is counted and the first one is reported right away.
+ * 
+ * @param sensor            pointer to sensor
+ * @param rb                pointer to ringbuffer of the axes
+ * @param pack              pointer to compressed ring packed from rb, NULL to check the ringbuffer itself
+ * @param numberOfSamples   samples to be pushed onto the ringbuffer, unused with pack
+ */
+static void kx132_guard_wait(kx132_sensor_t *sensor, ringbuffer_xyz_t *rb, rb_pack_t *pack, uint32_t numberOfSamples);
+
 
 /**
- * @brief Reads Data from KX132 in streaming mode and sends it over tcp to client.
+ * @brief Takes every window frozen by the sample buffer in trigger mode from the queue and sends it over tcp to client.
+ * 
+ * 	No ringbuffer and no software trigger detection, the window is limited to the capacity of the sample buffer.
  * 
- * @param readMode 			for reading with sync0 / async
+ * @param sensor 			pointer to sensor containing trigger times and normalized data
  */
-void kx132_streaming_mode(readMode_hw_t readMode);
+void kx132_buffer_trigger_mode(kx132_sensor_t *sensor);
 
 
 /**
- * @brief Reads data from KX132 in trigger mode and writes it to ringbuffer. 
+ * @brief Returns the samples kept before the trigger event by the sample buffer in trigger mode.
  * 
- * 	When trigger occurs, data is read as long as specified in triggerConfig->samplesAfterTrig
- * 	and then send over tcp to client.
+ * @param sensor 			pointer to sensor containing trigger times and capacity of sample buffer
+ * @return uint8_t          SMP_TH, limited so the trigger sample and one sample before it fit
+ */
+static uint8_t kx132_buffer_trigger_samples_before(kx132_sensor_t *sensor);
+
+
+/**
+ * @brief Switches the sample buffer to trigger mode and routes buffer full / wake-up to INT1.
  * 
- * @param softwareConfig 	pointer to struct containing readMode and buffersize
- * @param triggerConfig 	pointer to struct containing settings of trigger mode
- * @param triggerData 		pointer to struct containing thresholds and normalized data
+ * @param sensor        pointer to sensor
+ * @param samplesBeforeTrigger  SMP_TH, samples kept before trigger event
  */
-void kx132_trigger_mode(main_config_t *mainConfig, trigger_config_t *triggerConfig, trigger_data_t *triggerData);
+static void kx132_buffer_trigger_arm(kx132_sensor_t *sensor, uint8_t samplesBeforeTrigger);
 
 
 
-bool kx132_init(kx132_config_t* kx132_config){
+bool kx132_init(kx132_sensor_t* sensor){
 
-    main_config_t*	mainConfig                  = (main_config_t*) kx132_config->mainConfig;
+    main_config_t*	mainConfig                  = sensor->config->mainConfig;
 
     uint8_t 		whoAmI_Register_Default     = 0x3D;
     uint8_t 		whoAmI_Register_Value       = 0;
@@ -70,42 +305,139 @@ bool kx132_init(kx132_config_t* kx132_config){
     manId_Register_Default[3] = 0x6E;
 
 
-    spi_read(WHO_AM_I_REG_ADDR, &whoAmI_Register_Value);
+    spi_read(&sensor->spiDevice, WHO_AM_I_REG_ADDR, &whoAmI_Register_Value);
     if(whoAmI_Register_Value != whoAmI_Register_Default){
-        printf("[error] WHO_AM_I_REGISTER not read correctly. Should be: 0x3D\n");
+        printf("[error] WHO_AM_I_REGISTER of sensor %d not read correctly. Should be: 0x3D\n", sensor->id);
     }
 
-    spi_read_burst(MAN_ID_REG_ADDR, manId_Register_Value, 4);
+    spi_read_burst(&sensor->spiDevice, MAN_ID_REG_ADDR, manId_Register_Value, 4);
     for(uint8_t i = 0; i < 4; i++){
         if(manId_Register_Default[i] != manId_Register_Value[i]){
-            printf("[error] MAN_ID_REGISTER not read correctly.\n");
+            printf("[error] MAN_ID_REGISTER of sensor %d not read correctly.\n", sensor->id);
             break;
         }
     }
 
 
+    sensor->bufferWatermark = mainConfig->bufferWatermark;
+    sensor->samplePeriodUs  = USEC_PER_SEC / getOutputDataRateHz(getSampleOutputDataRate(mainConfig));
+    sensor->int1Enabled     = false;
+    sensor->eventInt1       = false;
+    sensor->bufferTrigger   = false;
+    sensor->int1TimeoutUs   = INT1_TIMEOUT_MIN_US;
+    sensor->outputDataRate  = getSampleOutputDataRate(mainConfig);
+    sensor->outputRegister  = (mainConfig->adpConfig.output != adp_output_off) ? XADP_L_REG_ADDR : XOUT_L_REG_ADDR;
+    sensor->adpUpdate       = false;
+    sensor->waitSpinNs      = (uint64_t) mainConfig->waitConfig.spinUs * NSEC_PER_USEC;
+    sensor->waitPolls       = 0;
+
+    // CNTL1 RES selects the high-performance mode, not the output width. 8-Bit drops the low bytes while reading.
+    if(mainConfig->resolution_hw == resolution_8bit){
+        sensor->bytesPerSample  = NUMBER_OF_CHANNELS_8BIT;
+        sensor->bufferCapacity  = KX132_BUF_MAX_SAMPLES_8BIT;
+    }
+    else{
+        sensor->bytesPerSample  = NUMBER_OF_CHANNELS;
+        sensor->bufferCapacity  = KX132_BUF_MAX_SAMPLES;
+    }
+
+    ts_init(&sensor->timestampEstimator, getOutputDataRateHz(sensor->outputDataRate), DEFAULT_TS_BANDWIDTH_HZ);
+    pthread_mutex_init(&sensor->sampleStatsMutex, NULL);
+
+    // reading thread only hands blocks over, it never waits for processing or sending
+    if(!spsc_init(&sensor->blockQueue, PIPELINE_BLOCK_SLOTS, sizeof(kx132_block_t))){
+        printf("[drv_kx132][error] Block queue of sensor %d could not be allocated.\n", sensor->id);
+        return false;
+    }
+    atomic_init(&sensor->capturing, false);
+    atomic_init(&sensor->envelopeRequest, 0);
+    sensor->pyramid = NULL;
+
+    // batches only need to be set up once, they are executed again for every read
+    spi_batch_clear (&sensor->sync0Batch);
+    spi_batch_read  (&sensor->sync0Batch, INS2_REG_ADDR,            &sensor->batchStatus,   1);
+    spi_batch_read  (&sensor->sync0Batch, sensor->outputRegister,   sensor->batchRawData,   NUMBER_OF_CHANNELS);
+
+    // only reading ZOUT_H releases Data-Ready, ADP output needs INT_REL (INS2 was already saved)
+    if(sensor->outputRegister != XOUT_L_REG_ADDR){
+        spi_batch_read(&sensor->sync0Batch, INT_REL_REG_ADDR,       &sensor->batchRelease,  1);
+    }
+
+    spi_batch_clear (&sensor->sync1Batch);
+    spi_batch_read  (&sensor->sync1Batch, sensor->outputRegister,   sensor->batchRawData,   NUMBER_OF_CHANNELS);
+    spi_batch_read  (&sensor->sync1Batch, INT_REL_REG_ADDR,         &sensor->batchStatus,   1);
+
+    // async can't see Data-Ready, the sample buffer counts new samples instead
+    spi_batch_clear (&sensor->asyncBatch);
+    spi_batch_read  (&sensor->asyncBatch, BUF_STATUS1_REG_ADDR,     sensor->batchBufferStatus,  BUF_STATUS_LEN);
+    spi_batch_read  (&sensor->asyncBatch, sensor->outputRegister,   sensor->batchRawData,       NUMBER_OF_CHANNELS);
+    sensor->asyncLevelBytes = 0;
+
+    // ADP registers can only be written in standby
+    spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 0x00);
+    kx132_adp_configure(sensor);
+    kx132_wake_configure(sensor);
+
     switch (mainConfig->readMode_hw)
     {
         case synchronous_read_0:
-            spi_write(CNTL1_REG_ADDR, 	0x00);
-            spi_write(ODCNTL_REG_ADDR, 	mainConfig->outputDataRate_hw);
-            spi_write(CNTL1_REG_ADDR, 	0xE0 | mainConfig->gRange_hw);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	0x00);
+            spi_write(&sensor->spiDevice, ODCNTL_REG_ADDR, 	mainConfig->outputDataRate_hw);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	0xE0 | mainConfig->gRange_hw);
 
             break;
 
-        // case synchronous_read_1:
-        // 	spi_write(CNTL1_REG_ADDR,	0x00);
-        // 	spi_write(INC1_REG_ADDR,	0x30);
-        // 	spi_write(INC4_REG_ADDR,	0x10);
-        // 	spi_write(ODCNTL_REG_ADDR,	mainConfig->outputDataRate_hw);
-        // 	spi_write(CNTL1_REG_ADDR,	0xE0 | mainConfig->gRange_hw);
-        // 
-        // 	break;
+        case synchronous_read_1:
+            if(!kx132_int1_init(sensor, 1)){
+                return false;
+            }
+
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR,	0x00);
+            spi_write(&sensor->spiDevice, INC1_REG_ADDR,	INC1_IEN1_ACTIVE_HIGH);
+            spi_write(&sensor->spiDevice, INC4_REG_ADDR,	INC4_DRDYI1);
+            spi_write(&sensor->spiDevice, ODCNTL_REG_ADDR,	mainConfig->outputDataRate_hw);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR,	0xE0 | mainConfig->gRange_hw);
+
+            break;
 
         case asynchronous_read:
-            spi_write(CNTL1_REG_ADDR, 	0x00);
-            spi_write(ODCNTL_REG_ADDR, 	mainConfig->outputDataRate_hw);
-            spi_write(CNTL1_REG_ADDR, 	0xC0 | mainConfig->gRange_hw);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	    0x00);
+            spi_write(&sensor->spiDevice, ODCNTL_REG_ADDR, 	    mainConfig->outputDataRate_hw);
+
+            // samples are read from the output registers, the 8-Bit sample buffer only counts them
+            spi_write(&sensor->spiDevice, BUF_CNTL2_REG_ADDR,   BUF_CNTL2_BUFE | BUF_CNTL2_BM_STREAM);
+            spi_write(&sensor->spiDevice, BUF_CLEAR_REG_ADDR,   0x00);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	    0xC0 | mainConfig->gRange_hw);
+
+            break;
+
+        case buffer_read:
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	    0x00);
+
+            // INT1 is optional in buffer mode, without it the sample buffer is polled
+            if(mainConfig->int1Config.source != gpio_source_none){
+                if(!kx132_int1_init(sensor, mainConfig->bufferWatermark)){
+                    return false;
+                }
+                spi_write(&sensor->spiDevice, INC1_REG_ADDR,    INC1_IEN1_ACTIVE_HIGH);
+
+                // with the wake-up engine INT1 ends idling, the sample buffer is polled while capturing
+                if(mainConfig->wakeConfig.enabled){
+                    spi_write(&sensor->spiDevice, INC4_REG_ADDR, INC4_WUFI1);
+                    sensor->int1Enabled = false;
+                    sensor->eventInt1   = true;
+                }
+                else{
+                    spi_write(&sensor->spiDevice, INC4_REG_ADDR, INC4_WMI1);
+                }
+            }
+
+            spi_write(&sensor->spiDevice, ODCNTL_REG_ADDR, 	    mainConfig->outputDataRate_hw);
+            spi_write(&sensor->spiDevice, BUF_CNTL1_REG_ADDR,   mainConfig->bufferWatermark);
+            spi_write(&sensor->spiDevice, BUF_CNTL2_REG_ADDR,   BUF_CNTL2_BUFE | BUF_CNTL2_BM_STREAM |
+                                                                ((mainConfig->resolution_hw == resolution_8bit) ? 0x00 : BUF_CNTL2_BRES_16_BIT));
+            spi_write(&sensor->spiDevice, BUF_CLEAR_REG_ADDR,   0x00);
+            spi_write(&sensor->spiDevice, CNTL1_REG_ADDR, 	    0xC0 | mainConfig->gRange_hw);
 
             break;
         
@@ -114,266 +446,1574 @@ bool kx132_init(kx132_config_t* kx132_config){
             break;
     }
 
+    if(numberOfSensors < KX132_MAX_SENSORS){
+        sensors[numberOfSensors++] = sensor;
+    }
 
     return true;
 }
 
 
-void kx132_software_reset(void){
-    spi_write(CNTL2_REG_ADDR, 0x8);
-}
+static bool kx132_int1_init(kx132_sensor_t *sensor, uint8_t samplesPerEdge){
+
+    double edgePeriodUs = sensor->samplePeriodUs * samplesPerEdge;
+
+    if(!gpio_event_init(&sensor->int1Event, &sensor->config->mainConfig->int1Config, (uint64_t) (edgePeriodUs * NSEC_PER_USEC))){
+        printf("[drv_kx132][error] GPIO for INT1 of sensor %d could not be initialized.\n", sensor->id);
+        return false;
+    }
 
+    sensor->int1TimeoutUs = (uint32_t) (edgePeriodUs * INT1_TIMEOUT_PERIODS);
+    if(sensor->int1TimeoutUs < INT1_TIMEOUT_MIN_US){
+        sensor->int1TimeoutUs = INT1_TIMEOUT_MIN_US;
+    }
 
-void kx132_async_read_raw_data(uint8_t* xyzRawData){
-    spi_read_burst(XOUT_L_REG_ADDR, xyzRawData, NUMBER_OF_CHANNELS);
+    sensor->int1Enabled = true;
+    return true;
 }
 
 
-bool kx_132_sync0_read_raw_data(uint8_t* xyzRawData){
-    uint8_t dataReady = 0;
-    spi_read(INS2_REG_ADDR, &dataReady);
+static void kx132_copy_raw_sample(kx132_sensor_t *sensor, uint8_t* xyzRawData){
 
-    if(dataReady & 0x10){
-        spi_read_burst(XOUT_L_REG_ADDR, xyzRawData, NUMBER_OF_CHANNELS);
-        return true;
+    if(sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT){
+        xyzRawData[X_INDEX] = sensor->batchRawData[X_HIGH_CHANNEL];
+        xyzRawData[Y_INDEX] = sensor->batchRawData[Y_HIGH_CHANNEL];
+        xyzRawData[Z_INDEX] = sensor->batchRawData[Z_HIGH_CHANNEL];
+        return;
     }
 
-    return false;
+    memcpy(xyzRawData, sensor->batchRawData, NUMBER_OF_CHANNELS);
 }
 
 
-void *kx132_runtime_config(void *kx_config){
-    
-    kx132_config_t      *kx132_config 	= (kx132_config_t*) kx_config;
-    trigger_config_t    *triggerConfig 	= kx132_config->triggerConfig;
-    trigger_data_t      *triggerData 	= kx132_config->triggerData;
-    outputDataRate_hw_t  outputDataRate = kx132_config->mainConfig->outputDataRate_hw;
-
-    #ifdef TCP_SERVER
-        printf("[drv_kx132] Runtime Config listening.\n");
-        char data[256];
-
-        while(MAIN_LOOP){
-            tcp_recv(data);
+void kx132_convert_raw_sample(kx132_sensor_t *sensor, uint8_t* xyzRawData, int16_t* xyzFormatted){
+    if(sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT){
+        convertRawArray8(xyzRawData, xyzFormatted);
+    }
+    else{
+        convertRawArray(xyzRawData, xyzFormatted);
+    }
+}
 
-            if(processRuntimeFlags(data, triggerConfig, triggerData, outputDataRate)){
-                printf("[drv_kx132] Client terminated connection. Exiting Program.\n");
-                MAIN_LOOP = false;
-                break;
-            }
 
-            strcpy(data, "");
+void kx132_convert_to_unit(kx132_sensor_t* sensor, void** xyzCounts, uint32_t numberOfSamples, float scale, float** xyzUnit){
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        if(sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT){
+            convertCounts8ToUnit((const int8_t*) xyzCounts[axis], numberOfSamples, scale * 256, xyzUnit[axis]);
         }
-    #endif //TCP_SERVER
-
-    return NULL;
+        else{
+            convertCountsToUnit((const int16_t*) xyzCounts[axis], numberOfSamples, scale, xyzUnit[axis]);
+        }
+    }
 }
 
 
-void *kx132_main_loop(void *kx_config){
+static void kx132_adp_configure(kx132_sensor_t *sensor){
 
-    kx132_config_t      *kx132_config 	= (kx132_config_t*) kx_config;
+    adp_config_t*   adpConfig   = &sensor->config->mainConfig->adpConfig;
+    uint8_t         rmsAvc      = 0;
+    uint8_t         adpCntl2    = 0;
 
-    main_config_t       *mainConfig     = kx132_config->mainConfig;
-    trigger_config_t    *triggerConfig 	= kx132_config->triggerConfig;
-    trigger_data_t      *triggerData 	= kx132_config->triggerData;
+    if(adpConfig->output == adp_output_off){
+        spi_write(&sensor->spiDevice, ADP_CNTL2_REG_ADDR, 0x00);
+        return;
+    }
 
-    if(mainConfig->useMode == streaming_mode){
-        kx132_streaming_mode(mainConfig->readMode_hw);
+    // RMS_AVC = log2(average) - 1
+    while((2u << rmsAvc) < adpConfig->rmsAverage){
+        rmsAvc++;
     }
-    else if(mainConfig->useMode == triggered_mode){
-        kx132_trigger_mode(mainConfig, triggerConfig, triggerData);
+
+    spi_write(&sensor->spiDevice, ADP_CNTL1_REG_ADDR,   (rmsAvc << ADP_CNTL1_RMS_AVC_SHIFT) | adpConfig->outputDataRate);
+
+    if(adpConfig->filter1.enabled){
+        spi_write(&sensor->spiDevice, ADP_CNTL3_REG_ADDR,   adpConfig->filter1.a1);
+        spi_write(&sensor->spiDevice, ADP_CNTL4_REG_ADDR,   adpConfig->filter1.ba         & 0xFF);
+        spi_write(&sensor->spiDevice, ADP_CNTL5_REG_ADDR,  (adpConfig->filter1.ba >> 8)   & 0xFF);
+        spi_write(&sensor->spiDevice, ADP_CNTL6_REG_ADDR,  (adpConfig->filter1.ba >> 16)  & 0x7F);
+        spi_write(&sensor->spiDevice, ADP_CNTL7_REG_ADDR,   adpConfig->filter1.ca         & 0xFF);
+        spi_write(&sensor->spiDevice, ADP_CNTL8_REG_ADDR,  (adpConfig->filter1.ca >> 8)   & 0xFF);
+        spi_write(&sensor->spiDevice, ADP_CNTL9_REG_ADDR,  (adpConfig->filter1.ca >> 16)  & 0x7F);
+        spi_write(&sensor->spiDevice, ADP_CNTL10_REG_ADDR,  adpConfig->filter1.inputShift);
+    }
+    else{
+        adpCntl2 |= ADP_CNTL2_ADP_FLT1_BYP;
     }
 
-    return NULL;
-}
+    // ADP_F1_OSH shares ADP_CNTL11 with ADP_F2_1A
+    spi_write(&sensor->spiDevice, ADP_CNTL11_REG_ADDR, (adpConfig->filter1.outputShift ? 0x80 : 0x00) | adpConfig->filter2.a1);
 
+    if(adpConfig->filter2.enabled){
+        spi_write(&sensor->spiDevice, ADP_CNTL12_REG_ADDR,  adpConfig->filter2.ba         & 0xFF);
+        spi_write(&sensor->spiDevice, ADP_CNTL13_REG_ADDR, (adpConfig->filter2.ba >> 8)   & 0x7F);
+        spi_write(&sensor->spiDevice, ADP_CNTL18_REG_ADDR,  adpConfig->filter2.inputShift);
+        spi_write(&sensor->spiDevice, ADP_CNTL19_REG_ADDR,  adpConfig->filter2.outputShift);
+    }
+    else{
+        adpCntl2 |= ADP_CNTL2_ADP_FLT2_BYP;
+    }
 
-void kx132_streaming_mode(readMode_hw_t readMode){
+    if(adpConfig->output == adp_output_rms){
+        adpCntl2 |= ADP_CNTL2_ADP_RMS_OSEL;
+    }
 
+    // sample buffer is filled with the ADP output at OADP
+    if(sensor->config->mainConfig->readMode_hw == buffer_read){
+        adpCntl2 |= ADP_CNTL2_ADP_BUF_SEL;
+    }
 
-    //-------------------------------------------------------------------
-    //--- Variable Declarations  ----------------------------------------
-    //-------------------------------------------------------------------
+    spi_write(&sensor->spiDevice, ADP_CNTL2_REG_ADDR, ADP_CNTL2_ADP_EN | adpCntl2);
+}
 
-    uint8_t     xyzRawData      [NUMBER_OF_CHANNELS];
-    int16_t     xyzFormatted    [NUMBER_OF_AXES];
-    uint64_t    count           = 0;
 
+static void kx132_adp_update(kx132_sensor_t *sensor){
 
-    for(uint8_t i = 0; i < NUMBER_OF_AXES; i++){
-        xyzFormatted[i] = 0;
-    }
+    uint8_t cntl1 = 0;
 
+    sensor->adpUpdate = false;
 
-    //-------------------------------------------------------------------
-    //--- Reading Loop  -------------------------------------------------
-    //-------------------------------------------------------------------
+    spi_read    (&sensor->spiDevice, CNTL1_REG_ADDR, &cntl1);
+    spi_write   (&sensor->spiDevice, CNTL1_REG_ADDR, cntl1 & ~CNTL1_PC1);
+    kx132_adp_configure(sensor);
 
-    while(MAIN_LOOP)
-    {
-        if(readMode == synchronous_read_0){
-            if(!kx_132_sync0_read_raw_data(xyzRawData)){
-                continue;
-            }
-        }
-        else if(readMode == asynchronous_read){
-            kx132_async_read_raw_data(xyzRawData);
-        }
-        
-        convertRawArray(xyzRawData, xyzFormatted);
-        
+    if(sensor->config->mainConfig->readMode_hw == buffer_read){
+        spi_write(&sensor->spiDevice, BUF_CLEAR_REG_ADDR, 0x00);
+    }
 
-        #ifdef DEBUG_PRINT_STREAM_DATA
-            printf("|X: %6.d   |Y: %6.d   |Z: %6.d   | #%d\n",
-                    xyzFormatted[X_INDEX],
-                    xyzFormatted[Y_INDEX],
-                    xyzFormatted[Z_INDEX], count);
-        #endif //DEBUG_PRINT_STREAM_DATA
+    spi_write   (&sensor->spiDevice, CNTL1_REG_ADDR, cntl1);
 
+    printf("[drv_kx132] Advanced Data Path of sensor %d updated.\n", sensor->id);
+}
 
-        #ifdef TCP_SERVER
-            tcp_send(xyzFormatted);
-        #endif //TCP_SERVER
 
+static void kx132_wake_configure(kx132_sensor_t *sensor){
 
+    wake_config_t*  wakeConfig  = &sensor->config->mainConfig->wakeConfig;
 
-        count++;
+    if(!wakeConfig->enabled){
+        return;
     }
 
-    return;
+    // relative thresholds ignore gravity and the orientation of the sensor
+    spi_write(&sensor->spiDevice, CNTL3_REG_ADDR,       wakeConfig->outputDataRate);
+    spi_write(&sensor->spiDevice, CNTL4_REG_ADDR,       CNTL4_TH_MODE | CNTL4_WUF_EN | CNTL4_BTS_EN | wakeConfig->outputDataRate);
+    spi_write(&sensor->spiDevice, INC2_REG_ADDR,        INC2_WAKE_ALL_DIRECTIONS);
+    spi_write(&sensor->spiDevice, WUFTH_REG_ADDR,       wakeConfig->wakeThreshold & 0xFF);
+    spi_write(&sensor->spiDevice, BTSTH_REG_ADDR,       wakeConfig->sleepThreshold & 0xFF);
+    spi_write(&sensor->spiDevice, BTSWUFTH_REG_ADDR,   (((wakeConfig->wakeThreshold >> 8) & 0x07) << BTSWUFTH_WUFTH_H_SHIFT) |
+                                                        ((wakeConfig->sleepThreshold >> 8) & 0x07));
+    spi_write(&sensor->spiDevice, WUFC_REG_ADDR,        wakeConfig->wakeCount);
+    spi_write(&sensor->spiDevice, BTSC_REG_ADDR,        wakeConfig->sleepCount);
 }
 
 
-void kx132_trigger_mode(main_config_t *mainConfig, trigger_config_t* triggerConfig, trigger_data_t *triggerData){
+static bool kx132_wait_for_wake(kx132_sensor_t *sensor){
 
-    //-------------------------------------------------------------------
-    //--- Variable Declarations & Memory Allocation --------------------
-    //-------------------------------------------------------------------
+    uint8_t wakeStatus  [WAKE_STATUS_LEN];
+    uint8_t release     = 0;
 
-    uint8_t         xyzRawData      [NUMBER_OF_CHANNELS];
-    int16_t         xyzFormatted    [NUMBER_OF_AXES];
-    ringbuffer_t    xyzRingbuffer   [NUMBER_OF_AXES];
-    int16_t*        xyzBuffer       [NUMBER_OF_AXES];
-    int16_t*        xyzReadBuffer   [NUMBER_OF_AXES];
+    if(sensor->eventInt1){
+        gpio_event_wait(&sensor->int1Event, EVENT_INT1_TIMEOUT_US);
+    }
+    else{
+        usleep(EVENT_POLL_US);
+    }
 
-    uint32_t        samplesRead     = 0;
-    bool            triggerDetected = false;
+    // time spent waiting is no loop period
+    rt_jitter_pause(&sensor->jitter);
 
+    spi_read_burst(&sensor->spiDevice, INS3_REG_ADDR, wakeStatus, WAKE_STATUS_LEN);
+    if(!(wakeStatus[0] & INS3_WUFS) && !(wakeStatus[1] & STATUS_REG_WAKE)){
+        return false;
+    }
 
-    for(axis_t axis = 0; axis < NUMBER_OF_AXES ; axis++){
+    // releases latched INT1, next back-to-sleep is reported on its own
+    spi_read(&sensor->spiDevice, INT_REL_REG_ADDR, &release);
 
-        xyzBuffer[axis]     = (int16_t*) malloc(mainConfig->bufferSize * sizeof(int16_t));
-        xyzReadBuffer[axis] = (int16_t*) malloc(mainConfig->bufferSize * sizeof(int16_t));
+    // samples produced while idling are neither lost nor a gap, the first block is the pre-trigger history
+    ts_restart(&sensor->timestampEstimator);
 
-        if(xyzBuffer[axis] == NULL){
-            printf("[drv_kx132][error] Buffer could not be allocated!\n", axis+1);
-            return; //TODO
-        }
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    sensor->sampleStats.wakeUps++;
+    sensor->sampleStats.idleNs += ts_now_ns() - sensor->idleSinceNs;
+    sensor->sampleStatsStarted  = false;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
 
-        if(xyzReadBuffer[axis] == NULL){
-            printf("[drv_kx132][error] Buffer could not be allocated!\n", axis+1);
-            return; //TODO
-        }
+    return true;
+}
+
+
+static bool kx132_back_to_sleep(kx132_sensor_t *sensor){
+
+    uint8_t wakeStatus  [WAKE_STATUS_LEN];
+    uint8_t release     = 0;
+
+    spi_read_burst(&sensor->spiDevice, INS3_REG_ADDR, wakeStatus, WAKE_STATUS_LEN);
+    if(!(wakeStatus[0] & INS3_BTS)){
+        return false;
     }
 
-    
-    if(!rb_xyz_init(xyzRingbuffer, xyzBuffer, mainConfig->bufferSize)){
-        printf("[drv_kx132][error] Ringbuffer could not be initialized.\n");
-        return;
+    spi_read(&sensor->spiDevice, INT_REL_REG_ADDR, &release);
+
+    // woke up again before INT_REL was read, that wake-up was released with it
+    spi_read(&sensor->spiDevice, STATUS_REG_REG_ADDR, wakeStatus);
+    if(wakeStatus[0] & STATUS_REG_WAKE){
+        return false;
     }
 
-    //-------------------------------------------------------------------
-    //--- Reading Loop  -------------------------------------------------
-    //-------------------------------------------------------------------
+    sensor->idleSinceNs = ts_now_ns();
+    return true;
+}
 
-    while(MAIN_LOOP)
-    {
-        if(mainConfig->readMode_hw == synchronous_read_0){
-            if(!kx_132_sync0_read_raw_data(xyzRawData)){
-                continue; // repeatedly try to read until new axis data is available 
-            }
-        }
-        else if(mainConfig->readMode_hw == asynchronous_read){
-            kx132_async_read_raw_data(xyzRawData);
-        }
-        
-        convertRawArray(xyzRawData, xyzFormatted);
 
+static void kx132_buffer_trigger_arm(kx132_sensor_t *sensor, uint8_t samplesBeforeTrigger){
 
-        //-------------------------------------------------------------------
-        //---Trigger Detection  ----------------------------------------------
-        //-------------------------------------------------------------------
-        
-        triggerDetected = detectAllTriggers(xyzFormatted, triggerConfig, triggerData);
+    uint8_t cntl1       = 0;
+    uint8_t bufCntl2    = 0;
+    uint8_t release     = 0;
 
-        if(triggerDetected){
+    spi_read    (&sensor->spiDevice, CNTL1_REG_ADDR,        &cntl1);
+    spi_read    (&sensor->spiDevice, BUF_CNTL2_REG_ADDR,    &bufCntl2);
+    spi_write   (&sensor->spiDevice, CNTL1_REG_ADDR,        cntl1 & ~CNTL1_PC1);
 
-            // push values that triggered the threshold and get index for reading data from ringbuffer
-            triggerConfig->triggerInfo->triggerIndex	=   rb_push(&xyzRingbuffer[X_INDEX], xyzFormatted[X_INDEX]);
-                                                            rb_push(&xyzRingbuffer[Y_INDEX], xyzFormatted[Y_INDEX]);
-                                                            rb_push(&xyzRingbuffer[Z_INDEX], xyzFormatted[Z_INDEX]);
-            
+    // latched INT1 stays high after wake-up, only its edge ends waiting, buffer full is waited for by time
+    if(sensor->config->mainConfig->int1Config.source != gpio_source_none){
+        spi_write(&sensor->spiDevice, INC4_REG_ADDR, INC4_BFI1 | (sensor->config->mainConfig->wakeConfig.enabled ? INC4_WUFI1 : 0x00));
+        sensor->int1Enabled = false;
+        sensor->eventInt1   = true;
+    }
 
-            while(samplesRead <= triggerConfig->triggerInfo->samplesAfterTrig){
-                if(mainConfig->readMode_hw == synchronous_read_0){
-                    if(!kx_132_sync0_read_raw_data(xyzRawData)){
-                        continue; // repeatedly try to read until new axis data is available 
-                    }
-                }
-                else if(mainConfig->readMode_hw == asynchronous_read){
-                    kx132_async_read_raw_data(xyzRawData);
-                }
+    // in trigger mode the sample threshold is the number of samples kept before the trigger event
+    spi_write   (&sensor->spiDevice, BUF_CNTL1_REG_ADDR,    samplesBeforeTrigger);
+    spi_write   (&sensor->spiDevice, BUF_CNTL2_REG_ADDR,    (bufCntl2 & ~BUF_CNTL2_BM_MASK) | BUF_CNTL2_BM_TRIGGER);
+    spi_write   (&sensor->spiDevice, BUF_CLEAR_REG_ADDR,    0x00);
+    spi_read    (&sensor->spiDevice, INT_REL_REG_ADDR,      &release);
+    spi_write   (&sensor->spiDevice, CNTL1_REG_ADDR,        cntl1);
 
-                convertRawArray(xyzRawData, xyzFormatted);
+    sensor->bufferWatermark = samplesBeforeTrigger;
+    sensor->bufferTrigger   = true;
+}
 
-                rb_push(&xyzRingbuffer[X_INDEX], xyzFormatted[X_INDEX]);
-                rb_push(&xyzRingbuffer[Y_INDEX], xyzFormatted[Y_INDEX]);
-                rb_push(&xyzRingbuffer[Z_INDEX], xyzFormatted[Z_INDEX]);
 
-                samplesRead++;
-            }
+void kx132_software_reset(kx132_sensor_t *sensor){
+    spi_write(&sensor->spiDevice, CNTL2_REG_ADDR, 0x8);
+}
 
-            samplesRead = 0;
 
-            rb_read_chunk(&xyzRingbuffer[X_INDEX], xyzReadBuffer[X_INDEX], triggerConfig->triggerInfo);
-            rb_read_chunk(&xyzRingbuffer[Y_INDEX], xyzReadBuffer[Y_INDEX], triggerConfig->triggerInfo);
-            rb_read_chunk(&xyzRingbuffer[Z_INDEX], xyzReadBuffer[Z_INDEX], triggerConfig->triggerInfo);
+bool kx132_spi_calibrate(kx132_sensor_t *sensor){
 
+    uint8_t     numberOfSteps   = sizeof(spiClockStepsHz) / sizeof(spiClockStepsHz[0]);
+    uint8_t     fastestStep     = numberOfSteps;
+    uint8_t     step            = 0;
+    uint32_t    clockHz         = 0;
+    uint8_t     xyzRawData      [NUMBER_OF_CHANNELS];
+    uint64_t    startNs         = 0;
+    double      sampleUs        = 0;
+    double      busUs           = 0;
 
-            #ifdef DEBUG_PRINT_TRIG_DATA
-                printf("-------------------------------\n");
-                printf("-------------------------------\n");
-                for(int u = 0; u < triggerConfig->triggerInfo->numberOfSamples; u++){
-                    printf("X:%6.d  |Y:%6.d  |Z:%6.d    --- #%d\n", 
-                            xyzReadBuffer[X_INDEX][u],
-                            xyzReadBuffer[Y_INDEX][u],
-                            xyzReadBuffer[Z_INDEX][u],
-                            u);
-                }
-                printf("-------------------------------\n\n\n\n");
-            #endif //DEBUG_PRINT_TRIG_DATA
+    usleep(SOFTWARE_RESET_DELAY_US);
 
+    for(step = 0; step < numberOfSteps; step++){
+        clockHz = spi_set_clock(&sensor->spiDevice, spiClockStepsHz[step]);
 
-            #ifdef TCP_SERVER
-                tcp_send_trig_buffer(xyzReadBuffer, triggerConfig->triggerInfo, triggerData->normalizedData);
-            #endif //TCP_SERVER
+        if(kx132_spi_check_link(sensor)){
+            fastestStep = step;
+            break;
+        }
+
+        printf("[drv_kx132] SPI clock %.2f MHz of sensor %d failed link check.\n", clockHz / 1e6, sensor->id);
+    }
+
+    if(fastestStep == numberOfSteps){
+        printf("[drv_kx132][error] Sensor %d does not respond correctly at any SPI clock.\n", sensor->id);
+        return false;
+    }
 
-            continue; // jump back to reading Data.
+    // errors get rare right below the limit, the margin has to pass as well
+    for(step = fastestStep + SPI_CLOCK_MARGIN_STEPS; step > fastestStep; step--){
+        if(step >= numberOfSteps){
+            continue;
         }
 
-        // if no trigger was detected, just push the values onto ringbuffer
-        rb_push(&xyzRingbuffer[X_INDEX], xyzFormatted[X_INDEX]);
-        rb_push(&xyzRingbuffer[Y_INDEX], xyzFormatted[Y_INDEX]);
-        rb_push(&xyzRingbuffer[Z_INDEX], xyzFormatted[Z_INDEX]);
+        clockHz = spi_set_clock(&sensor->spiDevice, spiClockStepsHz[step]);
+        if(kx132_spi_check_link(sensor)){
+            break;
+        }
+    }
 
+    if(step == fastestStep){
+        clockHz = spi_set_clock(&sensor->spiDevice, spiClockStepsHz[fastestStep]);
     }
 
+    // register of link check back to reset value
+    spi_write(&sensor->spiDevice, SPI_CHECK_REG, 0x00);
 
-    for(int i = 0; i < NUMBER_OF_AXES ; i++){
-        free(xyzBuffer[i]);
+    startNs = ts_now_ns();
+    for(uint16_t i = 0; i < SPI_TIMING_READS; i++){
+        spi_read_burst(&sensor->spiDevice, XOUT_L_REG_ADDR, xyzRawData, NUMBER_OF_CHANNELS);
     }
+    sampleUs = (ts_now_ns() - startNs) / 1000.0 / SPI_TIMING_READS;
 
+    // address byte + one sample
+    busUs = (1 + NUMBER_OF_CHANNELS) * 8 * 1e6 / clockHz;
 
-    return;
-}
\ No newline at end of file
+    printf("[drv_kx132] SPI clock of sensor %d calibrated to %.2f MHz (fastest reliable %.2f MHz), %.1f us per sample read (%.1f us on the bus).\n",
+            sensor->id,
+            clockHz / 1e6,
+            spiClockStepsHz[fastestStep] / 1e6,
+            sampleUs,
+            busUs);
+
+    return true;
+}
+
+
+static bool kx132_spi_check_link(kx132_sensor_t *sensor){
+
+    const uint8_t   manIdDefault    [4] = {0x4B, 0x69, 0x6F, 0x6E};
+    const uint8_t   whoAmIDefault       = 0x3D;
+    uint8_t         manId           [4];
+    uint8_t         whoAmI              = 0;
+    uint8_t         pattern             = 0;
+    uint8_t         readback            = 0;
+
+    for(uint16_t i = 0; i < SPI_CHECK_REPETITIONS; i++){
+
+        spi_read        (&sensor->spiDevice, WHO_AM_I_REG_ADDR, &whoAmI);
+        spi_read_burst  (&sensor->spiDevice, MAN_ID_REG_ADDR,   manId, sizeof(manId));
+
+        if((whoAmI != whoAmIDefault) || memcmp(manId, manIdDefault, sizeof(manId))){
+            return false;
+        }
+
+        // alternating and walking bits
+        pattern = (i & 1) ? (0xAA ^ i) : (0x55 ^ (1 << (i % 8)));
+
+        spi_write       (&sensor->spiDevice, SPI_CHECK_REG, pattern);
+        spi_read        (&sensor->spiDevice, SPI_CHECK_REG, &readback);
+
+        if(readback != pattern){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void kx132_wait_for_sample(kx132_sensor_t *sensor){
+
+    ts_estimator_t* estimator   = &sensor->timestampEstimator;
+    struct timespec wakeTime;
+    double          wakeNs      = 0;
+    uint64_t        nowNs       = 0;
+
+    // no estimate before the first sample, spinning after a poll without sample
+    if(!sensor->config->mainConfig->waitConfig.hybrid || !estimator->started || (sensor->waitPolls > 0)){
+        return;
+    }
+
+    wakeNs  = estimator->lastSampleNs + estimator->periodNs - sensor->waitSpinNs;
+    nowNs   = ts_now_ns();
+
+    // reading loop is late already
+    if(wakeNs <= nowNs){
+        return;
+    }
+
+    wakeTime.tv_sec     = (time_t) (wakeNs / NSEC_PER_SEC);
+    wakeTime.tv_nsec    = (long) (wakeNs - (double) wakeTime.tv_sec * NSEC_PER_SEC);
+
+    // absolute time, an interrupted sleep does not drift
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL) != 0 && MAIN_LOOP);
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    sensor->sampleStats.sleepNs += ts_now_ns() - nowNs;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+}
+
+
+static void kx132_wait_adapt(kx132_sensor_t *sensor){
+
+    uint64_t minSpinNs = (uint64_t) sensor->config->mainConfig->waitConfig.spinUs * NSEC_PER_USEC;
+    uint64_t maxSpinNs = (uint64_t) (sensor->timestampEstimator.periodNs / 2);
+
+    // woke up after the sample arrived, it waited for an unknown time
+    if(sensor->waitPolls == 0){
+        sensor->waitSpinNs += (sensor->waitSpinNs > WAIT_SPIN_STEP_US * NSEC_PER_USEC) ? sensor->waitSpinNs : WAIT_SPIN_STEP_US * NSEC_PER_USEC;
+    }
+    else if(sensor->waitPolls > WAIT_SPIN_POLLS){
+        sensor->waitSpinNs -= sensor->waitSpinNs / 8;
+    }
+
+    if(sensor->waitSpinNs > maxSpinNs){
+        sensor->waitSpinNs = maxSpinNs;
+    }
+    if(sensor->waitSpinNs < minSpinNs){
+        sensor->waitSpinNs = minSpinNs;
+    }
+}
+
+
+bool kx132_async_read_raw_data(kx132_sensor_t *sensor, uint8_t* xyzRawData){
+
+    uint16_t    levelBytes  = 0;
+    bool        newSample   = false;
+
+    // sample level and output registers in one transaction, an unchanged level means the output registers were read before
+    spi_batch_execute(&sensor->spiDevice, &sensor->asyncBatch);
+
+    levelBytes  = ((sensor->batchBufferStatus[1] & BUF_STATUS2_SMP_LEV_H) << 8) | sensor->batchBufferStatus[0];
+    newSample   = (levelBytes != sensor->asyncLevelBytes);
+    sensor->asyncLevelBytes = levelBytes;
+
+    // a sample arriving between reading the level and clearing is not counted, the timestamp estimator counts it as lost
+    if(levelBytes >= ASYNC_BUF_CLEAR_BYTES){
+        spi_write(&sensor->spiDevice, BUF_CLEAR_REG_ADDR, 0x00);
+        sensor->asyncLevelBytes = 0;
+    }
+
+    if(!newSample){
+        return false;
+    }
+
+    kx132_copy_raw_sample(sensor, xyzRawData);
+    return true;
+}
+
+
+bool kx_132_sync0_read_raw_data(kx132_sensor_t *sensor, uint8_t* xyzRawData){
+
+    // INS2 and output registers are read in one transaction, the data is discarded without Data-Ready.
+    // A sample arriving between the INS2 and output frames is released unseen, the timestamp estimator counts it as lost.
+    spi_batch_execute(&sensor->spiDevice, &sensor->sync0Batch);
+
+    if(!(sensor->batchStatus & INS2_DRDY)){
+        return false;
+    }
+
+    kx132_copy_raw_sample(sensor, xyzRawData);
+    return true;
+}
+
+
+bool kx132_sync1_read_raw_data(kx132_sensor_t *sensor, uint8_t* xyzRawData){
+    uint8_t interruptRelease = 0;
+
+    int32_t edges = gpio_event_wait(&sensor->int1Event, sensor->int1TimeoutUs);
+    if(edges < 0){
+        return false;
+    }
+
+    // on timeout an edge might have been missed while INT1 was still latched, so check INS2 once
+    if(edges == 0){
+        if(!kx_132_sync0_read_raw_data(sensor, xyzRawData)){
+            return false;
+        }
+
+        spi_read(&sensor->spiDevice, INT_REL_REG_ADDR, &interruptRelease);
+        return true;
+    }
+
+    // read output registers and release latched INT1 in one transaction, so the next Data-Ready creates a new rising edge
+    spi_batch_execute(&sensor->spiDevice, &sensor->sync1Batch);
+
+    kx132_copy_raw_sample(sensor, xyzRawData);
+    return true;
+}
+
+
+uint16_t kx132_buffer_read_raw_data(kx132_sensor_t *sensor, kx132_raw_block_t* rawBlock){
+    uint8_t     bufferStatus    [BUF_STATUS_LEN];
+    uint16_t    bytesInBuffer   = 0;
+    uint16_t    samplesInBuffer = 0;
+
+    spi_read_burst(&sensor->spiDevice, BUF_STATUS1_REG_ADDR, bufferStatus, BUF_STATUS_LEN);
+
+    bytesInBuffer   = ((bufferStatus[1] & BUF_STATUS2_SMP_LEV_H) << 8) | bufferStatus[0];
+    samplesInBuffer = bytesInBuffer / sensor->bytesPerSample;
+
+    // sleep until the sample threshold should be reached instead of hammering BUF_STATUS
+    if(samplesInBuffer < sensor->bufferWatermark){
+        if(sensor->int1Enabled){
+            gpio_event_wait(&sensor->int1Event, sensor->int1TimeoutUs);
+        }
+        else{
+            usleep( (useconds_t) ((sensor->bufferWatermark - samplesInBuffer) * sensor->samplePeriodUs) );
+        }
+        return 0;
+    }
+
+    // in stream mode a full buffer overwrites the oldest samples
+    sensor->bufferOverflow = (samplesInBuffer >= sensor->bufferCapacity);
+    if(samplesInBuffer > sensor->bufferCapacity){
+        samplesInBuffer = sensor->bufferCapacity;
+    }
+
+    // BUF_READ does not auto-increment, so one burst drains all stored samples
+    if(sensor->int1Enabled){
+        // release latched INT1 in the same transaction
+        spi_batch_clear     (&sensor->bufferBatch);
+        spi_batch_read_frame(&sensor->bufferBatch, BUF_READ_REG_ADDR,   &rawBlock->frame,       samplesInBuffer * sensor->bytesPerSample);
+        spi_batch_read      (&sensor->bufferBatch, INT_REL_REG_ADDR,    &sensor->batchStatus,   1);
+        spi_batch_execute   (&sensor->spiDevice, &sensor->bufferBatch);
+    }
+    else{
+        spi_read_frame(&sensor->spiDevice, BUF_READ_REG_ADDR, &rawBlock->frame, samplesInBuffer * sensor->bytesPerSample);
+    }
+
+    return samplesInBuffer;
+}
+
+
+uint16_t kx132_buffer_trigger_read_raw_data(kx132_sensor_t *sensor, kx132_raw_block_t* rawBlock){
+    uint8_t     bufferStatus    [BUF_STATUS_LEN];
+    uint16_t    samplesInBuffer = 0;
+    uint16_t    samplesAfter    = sensor->bufferCapacity - sensor->bufferWatermark;
+    uint32_t    pollUs          = EVENT_POLL_US;
+    uint8_t     release         = 0;
+
+    spi_read_burst(&sensor->spiDevice, BUF_STATUS1_REG_ADDR, bufferStatus, BUF_STATUS_LEN);
+    samplesInBuffer = (((bufferStatus[1] & BUF_STATUS2_SMP_LEV_H) << 8) | bufferStatus[0]) / sensor->bytesPerSample;
+
+    if(!(bufferStatus[1] & BUF_STATUS2_BUF_TRIG)){
+        // polled twice while the buffer fills after the trigger event, so the read follows it closely
+        if(samplesAfter * sensor->samplePeriodUs / 2 < pollUs){
+            pollUs = samplesAfter * sensor->samplePeriodUs / 2;
+        }
+
+        if(sensor->eventInt1){
+            gpio_event_wait(&sensor->int1Event, EVENT_INT1_TIMEOUT_US);
+        }
+        else{
+            usleep(pollUs);
+        }
+
+        rt_jitter_pause(&sensor->jitter);
+        return 0;
+    }
+
+    // buffer keeps filling until full, the newest sample is produced when it is
+    if(samplesInBuffer < sensor->bufferCapacity){
+        usleep( (useconds_t) ((sensor->bufferCapacity - samplesInBuffer) * sensor->samplePeriodUs) );
+        rt_jitter_pause(&sensor->jitter);
+        return 0;
+    }
+
+    spi_read_frame(&sensor->spiDevice, BUF_READ_REG_ADDR, &rawBlock->frame, sensor->bufferCapacity * sensor->bytesPerSample);
+
+    // clearing the buffer clears BUF_TRIG as well, the buffer is armed again
+    spi_write   (&sensor->spiDevice, BUF_CLEAR_REG_ADDR, 0x00);
+    spi_read    (&sensor->spiDevice, INT_REL_REG_ADDR, &release);
+
+    // every window stands on its own, time between windows is neither lost nor a gap
+    ts_restart(&sensor->timestampEstimator);
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    sensor->sampleStatsStarted = false;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+
+    return sensor->bufferCapacity;
+}
+
+
+uint16_t kx132_read_raw_samples(kx132_sensor_t *sensor, readMode_hw_t readMode, kx132_raw_block_t* rawBlock, uint64_t* timestamps){
+
+    uint16_t samplesRead     = 0;
+    uint32_t samplesMissing  = 0;
+    uint64_t readTimeNs      = 0;
+    double   lastSampleNs    = 0;
+    double   gapNs           = 0;
+    bool     duplicate       = false;
+    bool     polled          = false;
+
+    switch (readMode)
+    {
+        case synchronous_read_0:
+            kx132_wait_for_sample(sensor);
+            samplesRead = kx_132_sync0_read_raw_data(sensor, rawBlock->data) ? 1 : 0;
+            polled      = true;
+            break;
+
+        case synchronous_read_1:
+            samplesRead = kx132_sync1_read_raw_data(sensor, rawBlock->data) ? 1 : 0;
+            break;
+
+        case asynchronous_read:
+            kx132_wait_for_sample(sensor);
+            samplesRead = kx132_async_read_raw_data(sensor, rawBlock->data) ? 1 : 0;
+            duplicate   = (samplesRead == 0);
+            polled      = true;
+            break;
+
+        case buffer_read:
+            samplesRead = sensor->bufferTrigger ? kx132_buffer_trigger_read_raw_data(sensor, rawBlock)
+                                                : kx132_buffer_read_raw_data(sensor, rawBlock);
+            break;
+
+        default:
+            return 0;
+    }
+
+    if(samplesRead == 0){
+        if(polled){
+            sensor->waitPolls++;
+
+            pthread_mutex_lock(&sensor->sampleStatsMutex);
+            sensor->sampleStats.pollsWasted++;
+            if(duplicate){
+                sensor->sampleStats.duplicatesDiscarded++;
+            }
+            pthread_mutex_unlock(&sensor->sampleStatsMutex);
+        }
+        return 0;
+    }
+
+    if(polled){
+        if(sensor->config->mainConfig->waitConfig.hybrid){
+            kx132_wait_adapt(sensor);
+        }
+        sensor->waitPolls       = 0;
+    }
+
+    // timestamp right after the transfer, newest sample of the block was produced shortly before
+    readTimeNs = ts_now_ns();
+
+    // single sample reads lose samples when the loop is too slow, buffer_read only when the buffer was full
+    if(sensor->sampleStatsStarted && ((readMode != buffer_read) || sensor->bufferOverflow)){
+        samplesMissing = ts_missing_samples(&sensor->timestampEstimator, readTimeNs, samplesRead);
+    }
+
+    lastSampleNs = sensor->timestampEstimator.lastSampleNs;
+    ts_update(&sensor->timestampEstimator, readTimeNs, samplesRead, samplesMissing, timestamps);
+    gapNs = sensor->timestampEstimator.lastSampleNs - (samplesRead - 1) * sensor->timestampEstimator.periodNs - lastSampleNs;
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    if(sensor->sampleStatsStarted && (gapNs > sensor->sampleStats.longestGapNs)){
+        sensor->sampleStats.longestGapNs = (uint64_t) gapNs;
+    }
+    if(samplesMissing > 0){
+        sensor->sampleStats.samplesLost += samplesMissing;
+        sensor->sampleStats.lossEvents++;
+    }
+    sensor->sampleStats.samplesRead += samplesRead;
+    sensor->sampleStatsStarted = true;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+
+    return samplesRead;
+}
+
+
+void kx132_get_sample_stats(kx132_sensor_t *sensor, sample_stats_t *stats){
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    *stats = sensor->sampleStats;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+}
+
+
+void kx132_reset_sample_stats(kx132_sensor_t *sensor){
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    memset(&sensor->sampleStats, 0, sizeof(sensor->sampleStats));
+    sensor->sampleStatsStarted = false;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+}
+
+
+void kx132_print_stats(kx132_sensor_t *sensor){
+
+    sample_stats_t stats;
+
+    kx132_get_sample_stats(sensor, &stats);
+
+    printf("[kx132] Sensor %d (bus %d, chip-select %d):\n",
+            sensor->id,
+            sensor->spiDevice.config.bus,
+            sensor->spiDevice.config.chipSelect);
+
+    rt_jitter_print(&sensor->jitter);
+    ts_print(&sensor->timestampEstimator);
+
+    printf("[kx132] Samples: %llu read, %llu duplicates discarded, %llu lost in %llu events, longest gap %.1f us\n",
+            (unsigned long long) stats.samplesRead,
+            (unsigned long long) stats.duplicatesDiscarded,
+            (unsigned long long) stats.samplesLost,
+            (unsigned long long) stats.lossEvents,
+            stats.longestGapNs / 1000.0);
+
+    if(sensor->config->mainConfig->waitConfig.hybrid){
+        printf("[kx132] Hybrid wait: %llu polls wasted (%.2f per sample), slept %.1f s, spinning %.1f us before each sample\n",
+                (unsigned long long) stats.pollsWasted,
+                stats.samplesRead ? (double) stats.pollsWasted / stats.samplesRead : 0.0,
+                stats.sleepNs / 1e9,
+                sensor->waitSpinNs / 1000.0);
+    }
+    else if((sensor->config->mainConfig->readMode_hw == synchronous_read_0) || (sensor->config->mainConfig->readMode_hw == asynchronous_read)){
+        printf("[kx132] Busy polling: %llu polls wasted (%.2f per sample)\n",
+                (unsigned long long) stats.pollsWasted,
+                stats.samplesRead ? (double) stats.pollsWasted / stats.samplesRead : 0.0);
+    }
+
+    printf("[kx132] Pipeline: up to %u of %u blocks queued, %llu samples dropped",
+            stats.maxBlocksQueued,
+            PIPELINE_BLOCK_SLOTS,
+            (unsigned long long) stats.samplesDropped);
+
+    if((sensor->config->mainConfig->useMode == triggered_mode) && !sensor->config->mainConfig->bufferTrigger){
+        printf(", %llu trigger events dropped", (unsigned long long) stats.eventsDropped);
+    }
+    printf("\n");
+
+    if(stats.guardStalls > 0){
+        printf("[kx132] Sending: evaluation waited %llu times for a window, %.1f ms in total, longest %.1f ms\n",
+                (unsigned long long) stats.guardStalls,
+                stats.guardStallNs / 1e6,
+                stats.longestGuardStallNs / 1e6);
+    }
+
+    // in trigger mode of the sample buffer the wake-up engine only triggers, the host does not idle on it
+    if(sensor->config->mainConfig->wakeConfig.enabled && !sensor->config->mainConfig->bufferTrigger){
+        printf("[kx132] Wake-up engine: %llu wake-ups, idle for %.1f s\n",
+                (unsigned long long) stats.wakeUps,
+                stats.idleNs / 1e9);
+    }
+}
+
+
+void kx132_stop(void){
+    MAIN_LOOP = false;
+}
+
+
+void *kx132_runtime_config(void *arg){
+
+    #ifdef TCP_SERVER
+        printf("[drv_kx132] Runtime Config listening.\n");
+        char        data        [256];
+        char        sensorData  [256];
+        uint32_t    sensorId    = 0;
+        int         offset      = 0;
+        bool        exitProgram = false;
+
+        while(MAIN_LOOP){
+            tcp_recv(data);
+            data[sizeof(data) - 1] = '\0';
+
+            // "sensor <n> ..." changes only sensor n, everything else is applied to all sensors
+            offset = 0;
+            if(!strncmp(data, RUNTIME_SENSOR_FLAG, strlen(RUNTIME_SENSOR_FLAG))){
+                if((sscanf(data, RUNTIME_SENSOR_FLAG " %u %n", &sensorId, &offset) < 1) || (offset == 0)){
+                    printf("[drv_kx132][warning] Expected \"%s <n> ...\".\n", RUNTIME_SENSOR_FLAG);
+                    continue;
+                }
+            }
+
+            for(uint8_t s = 0; s < numberOfSensors; s++){
+                if((offset > 0) && (sensors[s]->id != sensorId)){
+                    continue;
+                }
+
+                // processRuntimeFlags() splits the string, every sensor needs its own copy
+                strcpy(sensorData, &data[offset]);
+                exitProgram |= processRuntimeFlags(sensorData, sensors[s]);
+            }
+
+            if(exitProgram){
+                printf("[drv_kx132] Client terminated connection. Exiting Program.\n");
+                MAIN_LOOP = false;
+                break;
+            }
+
+            strcpy(data, "");
+        }
+    #endif //TCP_SERVER
+
+    return NULL;
+}
+
+
+void *kx132_main_loop(void *kx_sensor){
+
+    kx132_sensor_t      *sensor         = (kx132_sensor_t*) kx_sensor;
+    main_config_t       *mainConfig     = sensor->config->mainConfig;
+    trigger_config_t    *triggerConfig  = sensor->config->triggerConfig;
+
+    kx132_block_t       overflowBlock;                          ///< read into while the queue is full, its samples are dropped
+    kx132_raw_block_t   sampleBlock;                            ///< single sample read before it is appended to the open block
+    kx132_block_t*      block           = NULL;                 ///< open block, NULL after it was queued
+    kx132_block_t*      target          = NULL;
+    bool                triggered       = (mainConfig->useMode == triggered_mode);
+    bool                bufferTrigger   = triggered && mainConfig->bufferTrigger;
+    bool                wakeEngine      = triggered && !bufferTrigger && mainConfig->wakeConfig.enabled;
+    bool                idle            = wakeEngine;           ///< wake-up engine is asleep, nothing is read
+    bool                sleepCheck      = false;                ///< samples were read since back-to-sleep was last checked
+    bool                restart         = false;                ///< thresholds changed, next block restarts trigger evaluation
+    readMode_hw_t       readMode        = bufferTrigger ? buffer_read : mainConfig->readMode_hw;
+    bool                collect         = (readMode != buffer_read);    ///< single sample reads share a block, a queue slot per sample holds too little time
+    uint16_t            samplesInBlock  = 0;
+    uint16_t            offset          = 0;
+
+    rt_jitter_reset(&sensor->jitter);
+    kx132_reset_sample_stats(sensor);
+
+    if(bufferTrigger){
+        if(triggerConfig->triggerInfo->numberOfSamples > sensor->bufferCapacity){
+            printf("[drv_kx132][warning] Sample buffer of sensor %d holds %d samples, %d before trigger + %d after trigger requested.\n",
+                    sensor->id, sensor->bufferCapacity, triggerConfig->triggerInfo->samplesBeforeTrig, triggerConfig->triggerInfo->samplesAfterTrig);
+        }
+
+        kx132_buffer_trigger_arm(sensor, kx132_buffer_trigger_samples_before(sensor));
+    }
+
+    // history before wake-up is limited to what the sample buffer holds
+    if(wakeEngine && (triggerConfig->triggerInfo->samplesBeforeTrig > sensor->bufferCapacity)){
+        printf("[drv_kx132][warning] Sample buffer of sensor %d holds %d samples before wake-up, %d requested before trigger.\n",
+                sensor->id, sensor->bufferCapacity, triggerConfig->triggerInfo->samplesBeforeTrig);
+    }
+    sensor->idleSinceNs = ts_now_ns();
+
+    //-------------------------------------------------------------------
+    //--- Reading Loop  -------------------------------------------------
+    //-------------------------------------------------------------------
+
+    while(MAIN_LOOP)
+    {
+        rt_jitter_record(&sensor->jitter);
+
+        if(sensor->adpUpdate){
+            // samples collected so far belong to the old thresholds
+            if((block != NULL) && (block->numberOfSamples > 0)){
+                kx132_queue_block(sensor, block, restart);
+                restart = false;
+                block   = NULL;
+            }
+
+            kx132_adp_update(sensor);
+
+            // filtered and RMS data have different offsets, thresholds are normalized again
+            // clearing the sample buffer in trigger mode arms it again, normalized data is kept
+            if(triggered && !bufferTrigger){
+                normalizeThresholds(sensor);
+                setOffsetThresholds(sensor->config->triggerData);
+                restart = true;
+            }
+        }
+
+        // a running capture is finished before going back to sleep, evaluation has to catch up with all blocks first
+        if(sleepCheck && (block == NULL) && (spsc_count(&sensor->blockQueue) == 0) && !atomic_load(&sensor->capturing)){
+            sleepCheck  = false;
+            idle        = kx132_back_to_sleep(sensor);
+        }
+
+        // host idles until the wake-up engine detects motion
+        if(idle){
+            if(!kx132_wait_for_wake(sensor)){
+                continue;
+            }
+            idle = false;
+        }
+
+        if(block == NULL){
+            block = spsc_write_slot(&sensor->blockQueue);
+            if(block != NULL){
+                block->numberOfSamples = 0;
+            }
+        }
+        target = (block != NULL) ? block : &overflowBlock;
+        offset = (block != NULL) ? block->numberOfSamples : 0;
+
+        // single samples after the first of a block are appended, the raw frame of a read always starts at data
+        samplesInBlock = kx132_read_raw_samples(sensor, readMode, (offset == 0) ? &target->rawBlock : &sampleBlock, &target->timestamps[offset]);
+
+        if(samplesInBlock > 0){
+            sleepCheck = wakeEngine;
+
+            // samples are still read while the queue is full, so the sensor keeps its timing and loss stays countable
+            if(block == NULL){
+                pthread_mutex_lock(&sensor->sampleStatsMutex);
+                sensor->sampleStats.samplesDropped += samplesInBlock;
+                pthread_mutex_unlock(&sensor->sampleStatsMutex);
+                continue;
+            }
+
+            if(offset > 0){
+                memcpy(&block->rawBlock.data[offset * sensor->bytesPerSample], sampleBlock.data, samplesInBlock * sensor->bytesPerSample);
+            }
+            block->numberOfSamples += samplesInBlock;
+        }
+
+        // a block is queued when the next sample does not fit or its first sample waited long enough
+        if((block != NULL) && (block->numberOfSamples > 0) &&
+           (!collect || (block->numberOfSamples >= sensor->bufferCapacity) || (ts_now_ns() >= block->timestamps[0] + PIPELINE_BLOCK_NS))){
+            kx132_queue_block(sensor, block, restart);
+            restart = false;
+            block   = NULL;
+        }
+    }
+
+    if((block != NULL) && (block->numberOfSamples > 0)){
+        kx132_queue_block(sensor, block, restart);
+    }
+    spsc_close(&sensor->blockQueue);
+
+    return NULL;
+}
+
+
+static void kx132_queue_block(kx132_sensor_t *sensor, kx132_block_t* block, bool restart){
+
+    uint32_t    blocksQueued    = 0;
+
+    block->sampleRateHz = ts_locked(&sensor->timestampEstimator) ? ts_rate_hz(&sensor->timestampEstimator) : 0;
+    block->restart      = restart;
+    spsc_commit_write(&sensor->blockQueue);
+
+    blocksQueued = spsc_count(&sensor->blockQueue);
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    if(blocksQueued > sensor->sampleStats.maxBlocksQueued){
+        sensor->sampleStats.maxBlocksQueued = blocksQueued;
+    }
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+}
+
+
+void *kx132_consumer_loop(void *kx_sensor){
+
+    kx132_sensor_t      *sensor         = (kx132_sensor_t*) kx_sensor;
+    main_config_t       *mainConfig     = sensor->config->mainConfig;
+
+    if(mainConfig->useMode == streaming_mode){
+        kx132_streaming_mode(sensor);
+    }
+    else if(mainConfig->useMode == triggered_mode){
+        if(mainConfig->bufferTrigger){
+            kx132_buffer_trigger_mode(sensor);
+        }
+        else{
+            kx132_trigger_mode(sensor);
+        }
+    }
+
+    // blocks left after an error are discarded, the queue is freed only once the reading thread closed it
+    while(spsc_wait_slot(&sensor->blockQueue, PIPELINE_POLL_NS) != NULL){
+        spsc_commit_read(&sensor->blockQueue);
+    }
+    spsc_free(&sensor->blockQueue);
+
+    kx132_print_stats(sensor);
+
+    return NULL;
+}
+
+
+void kx132_streaming_mode(kx132_sensor_t *sensor){
+
+
+    //-------------------------------------------------------------------
+    //--- Variable Declarations  ----------------------------------------
+    //-------------------------------------------------------------------
+
+    kx132_block_t* block        = NULL;
+    uint8_t*    xyzRawData      = NULL;
+    uint64_t*   timestamps      = NULL;
+    int16_t     xyzFormatted    [NUMBER_OF_AXES];
+    int8_t      xyzCompact      [NUMBER_OF_AXES];
+    int16_t     xyzBlock        [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    int8_t      xyzBlock8       [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    float       xyzBlockUnit    [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    float*      xyzUnit         [NUMBER_OF_AXES]    = {xyzBlockUnit[X_INDEX], xyzBlockUnit[Y_INDEX], xyzBlockUnit[Z_INDEX]};
+    float       xyzSampleUnit   [NUMBER_OF_AXES];
+    bool        compact         = (sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT);
+    void*       xyzCounts       [NUMBER_OF_AXES]    = {compact ? (void*) xyzBlock8[X_INDEX] : (void*) xyzBlock[X_INDEX],
+                                                       compact ? (void*) xyzBlock8[Y_INDEX] : (void*) xyzBlock[Y_INDEX],
+                                                       compact ? (void*) xyzBlock8[Z_INDEX] : (void*) xyzBlock[Z_INDEX]};
+    unit_config_t* unitConfig   = &sensor->config->mainConfig->unitConfig;
+    bool        physical        = (unitConfig->stream != unit_counts);
+    uint64_t    count           = 0;
+    uint16_t    samplesRead     = 0;
+
+
+    for(uint8_t i = 0; i < NUMBER_OF_AXES; i++){
+        xyzFormatted[i] = 0;
+    }
+
+
+    //-------------------------------------------------------------------
+    //--- Sending Loop  -------------------------------------------------
+    //-------------------------------------------------------------------
+
+    while((block = spsc_wait_slot(&sensor->blockQueue, PIPELINE_POLL_NS)) != NULL)
+    {
+        xyzRawData  = block->rawBlock.data;
+        timestamps  = block->timestamps;
+        samplesRead = block->numberOfSamples;
+
+        // physical units: whole block is decoded and scaled per axis, samples are sent from the scaled arrays
+        if(physical && (samplesRead > 0)){
+            if(compact){
+                convertRawBlock8(xyzRawData, samplesRead, xyzBlock8[X_INDEX], xyzBlock8[Y_INDEX], xyzBlock8[Z_INDEX]);
+            }
+            else{
+                convertRawBlock(xyzRawData, samplesRead, xyzBlock[X_INDEX], xyzBlock[Y_INDEX], xyzBlock[Z_INDEX]);
+            }
+            kx132_convert_to_unit(sensor, xyzCounts, samplesRead, unitConfig->streamScale, xyzUnit);
+        }
+
+        for(uint16_t sample = 0; sample < samplesRead; sample++){
+
+            kx132_convert_raw_sample(sensor, &xyzRawData[sample * sensor->bytesPerSample], xyzFormatted);
+
+
+            #ifdef DEBUG_PRINT_STREAM_DATA
+                printf("|X: %6.d   |Y: %6.d   |Z: %6.d   | #%d\n",
+                        xyzFormatted[X_INDEX],
+                        xyzFormatted[Y_INDEX],
+                        xyzFormatted[Z_INDEX], count);
+            #endif //DEBUG_PRINT_STREAM_DATA
+
+
+            #ifdef TCP_SERVER
+                if(physical){
+                    xyzSampleUnit[X_INDEX] = xyzBlockUnit[X_INDEX][sample];
+                    xyzSampleUnit[Y_INDEX] = xyzBlockUnit[Y_INDEX][sample];
+                    xyzSampleUnit[Z_INDEX] = xyzBlockUnit[Z_INDEX][sample];
+                    tcp_send_float(sensor->id, xyzSampleUnit, timestamps[sample]);
+                }
+                else if(compact){
+                    xyzCompact[X_INDEX] = (int8_t) xyzRawData[sample * NUMBER_OF_CHANNELS_8BIT + X_INDEX];
+                    xyzCompact[Y_INDEX] = (int8_t) xyzRawData[sample * NUMBER_OF_CHANNELS_8BIT + Y_INDEX];
+                    xyzCompact[Z_INDEX] = (int8_t) xyzRawData[sample * NUMBER_OF_CHANNELS_8BIT + Z_INDEX];
+                    tcp_send_8(sensor->id, xyzCompact, timestamps[sample]);
+                }
+                else{
+                    tcp_send(sensor->id, xyzFormatted, timestamps[sample]);
+                }
+            #endif //TCP_SERVER
+
+
+
+            count++;
+        }
+
+        spsc_commit_read(&sensor->blockQueue);
+    }
+
+    return;
+}
+
+
+void kx132_trigger_mode(kx132_sensor_t *sensor){
+
+    main_config_t*      mainConfig      = sensor->config->mainConfig;
+    trigger_config_t*   triggerConfig   = sensor->config->triggerConfig;
+    trigger_data_t*     triggerData     = sensor->config->triggerData;
+
+    //-------------------------------------------------------------------
+    //--- Variable Declarations & Memory Allocation --------------------
+    //-------------------------------------------------------------------
+
+    kx132_block_t*  block           = NULL;
+    kx132_event_t*  event           = NULL;
+    pthread_t       threadSender;
+    int16_t         xyzFormatted    [NUMBER_OF_AXES];
+    ringbuffer_xyz_t xyzRingbuffer;                         ///< all axes, one write index, 8-Bit values in 8-Bit resolution
+    void*           xyzBuffer       = NULL;
+    ringbuffer_ts_t timestampRingbuffer;
+    uint64_t*       timestampBuffer = NULL;
+    rb_file_t       historyFile;
+    rb_pyramid_t    pyramid;
+    rb_pack_t       pack;
+
+    bool            compact         = (sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT);
+    bool            history         = (mainConfig->historyPath[0] != '\0');
+    bool            packed          = (mainConfig->packSize > 0);
+    uint32_t        samplesRestored = 0;
+    size_t          valueSize       = compact ? sizeof(int8_t) : sizeof(int16_t);
+
+    uint32_t        samplesRead     = 0;
+    uint16_t        samplesInBlock  = 0;
+    uint32_t        firstIndex      = 0;                                ///< ringbuffer index of first sample of block
+    uint32_t        ringIndex       = 0;
+    void*           xyzSpan         [NUMBER_OF_AXES];                   ///< values of samples spanStart - spanEnd in ringbuffer
+    uint16_t        spanStart       = 0;
+    uint16_t        spanEnd         = 0;
+    uint32_t        ringModulo      = mainConfig->bufferSize - 1;
+    bool            triggerDetected = false;
+
+
+    // history file holds minutes of samples, only the pages around the write index are in RAM, so it is not prefaulted
+    if(history){
+        if(!rb_file_open(&historyFile, mainConfig->historyPath, mainConfig->bufferSize, valueSize, mainConfig->bufferLayout)){
+            printf("[drv_kx132][error] History file could not be opened!\n");
+            goto stopReading;
+        }
+
+        xyzBuffer       = historyFile.xyzBuffer;
+        timestampBuffer = historyFile.timestampBuffer;
+    }
+    else{
+        // interleaved blocks start on a cache line, mirrored buffers are mapped twice per axis
+        xyzBuffer = rb_multi_alloc(mainConfig->bufferSize, valueSize, mainConfig->bufferLayout);
+
+        if(xyzBuffer == NULL){
+            printf("[drv_kx132][error] Buffer could not be allocated!\n");
+            goto stopReading;
+        }
+
+        // no page fault may happen when the ringbuffer is filled for the first time, both mappings of a mirrored buffer are touched
+        rt_prefault(xyzBuffer, rb_multi_bytes(mainConfig->bufferSize, valueSize, mainConfig->bufferLayout));
+
+        timestampBuffer = (uint64_t*) malloc(mainConfig->bufferSize * sizeof(uint64_t));
+
+        if(timestampBuffer == NULL){
+            printf("[drv_kx132][error] Timestamp buffer could not be allocated!\n");
+            goto freeBuffers;
+        }
+
+        rt_prefault(timestampBuffer, mainConfig->bufferSize * sizeof(uint64_t));
+    }
+
+    if(!rb_multi_init(&xyzRingbuffer, xyzBuffer, mainConfig->bufferSize, valueSize, mainConfig->bufferLayout)){
+        printf("[drv_kx132][error] Ringbuffer could not be initialized.\n");
+        goto freeBuffers;
+    }
+
+    if(!rb_ts_init(&timestampRingbuffer, timestampBuffer, mainConfig->bufferSize)){
+        printf("[drv_kx132][error] Timestamp ringbuffer could not be initialized.\n");
+        goto freeBuffers;
+    }
+
+    // samples of the last run are history of the first trigger, their timestamps are moved onto the clock of this run
+    if(history){
+        samplesRestored = rb_file_restore(&historyFile, &xyzRingbuffer, &timestampRingbuffer);
+        printf("[drv_kx132] %u samples recovered from history file %s.\n", samplesRestored, mainConfig->historyPath);
+    }
+
+    // compressed ring takes over the older part of every window, samples recovered from the history file are packed right away
+    if(packed){
+        if(!rb_pack_init(&pack, mainConfig->packSize, valueSize, xyzRingbuffer.index - samplesRestored)){
+            printf("[drv_kx132][error] Compressed history could not be allocated!\n");
+            goto freeBuffers;
+        }
+
+        rt_prefault(pack.buffer, pack.size);
+        rt_prefault(pack.blockOffsets, pack.blockCount * sizeof(uint32_t));
+        rb_pack_push(&pack, &xyzRingbuffer, &timestampRingbuffer);
+    }
+
+    // envelopes are small, they are kept in RAM even with a history file
+    if(mainConfig->envelope){
+        if(!rb_pyramid_init(&pyramid)){
+            printf("[drv_kx132][error] Envelopes could not be allocated!\n");
+            goto freePack;
+        }
+
+        for(uint8_t level = 0; level < RB_PYRAMID_LEVELS; level++){
+            rt_prefault(pyramid.level[level].entries, RB_PYRAMID_ENTRIES * sizeof(rb_envelope_t));
+        }
+
+        sensor->pyramid = &pyramid;
+    }
+
+    // an event slot only holds a view of the window, the samples are sent straight from the ringbuffers
+    if(!spsc_init(&sensor->eventQueue, PIPELINE_EVENT_SLOTS, sizeof(kx132_event_t))){
+        printf("[drv_kx132][error] Event queue could not be allocated.\n");
+        goto freeEnvelopes;
+    }
+
+    for(uint32_t slot = 0; slot < PIPELINE_EVENT_SLOTS; slot++){
+
+        event = (kx132_event_t*) spsc_slot(&sensor->eventQueue, slot);
+
+        event->xyzRingbuffer        = &xyzRingbuffer;
+        event->timestampRingbuffer  = &timestampRingbuffer;
+        event->pack                 = packed ? &pack : NULL;
+    }
+
+    // created by the processing thread, so it runs with default scheduling and not on the CPU of the reading thread
+    if(pthread_create(&threadSender, NULL, kx132_event_sender, sensor) != 0){
+        printf("[drv_kx132][error] Sending thread could not be created.\n");
+        goto freeEventQueue;
+    }
+
+    //-------------------------------------------------------------------
+    //--- Evaluation Loop  ----------------------------------------------
+    //-------------------------------------------------------------------
+
+    while((block = spsc_wait_slot(&sensor->blockQueue, PIPELINE_POLL_NS)) != NULL)
+    {
+        // thresholds were normalized again by the reading thread, a capture started before is incomplete
+        if(block->restart){
+            samplesRead     = 0;
+            triggerDetected = false;
+        }
+
+        samplesInBlock = block->numberOfSamples;
+
+        // sending thread still reads a window the block would overwrite, the block queue buffers meanwhile
+        kx132_guard_wait(sensor, &xyzRingbuffer, NULL, samplesInBlock);
+
+        // whole block is decoded straight into the ringbuffers, trigger detection reads it back from there
+        firstIndex = rb_push_raw_block(&xyzRingbuffer, block->rawBlock.data, samplesInBlock);
+        rb_ts_push_block(&timestampRingbuffer, block->timestamps, samplesInBlock);
+        spanEnd = 0;
+
+        if(history){
+            rb_file_sync(&historyFile, &xyzRingbuffer);
+        }
+
+        if(sensor->pyramid != NULL){
+            rb_pyramid_push(sensor->pyramid, &xyzRingbuffer, &timestampRingbuffer, samplesInBlock);
+        }
+
+        // blocks are packed before trigger detection, so a window taken in this block finds all of its older part packed
+        if(packed){
+            kx132_guard_wait(sensor, &xyzRingbuffer, &pack, 0);
+            rb_pack_push(&pack, &xyzRingbuffer, &timestampRingbuffer);
+        }
+
+        for(uint16_t sample = 0; sample < samplesInBlock; sample++){
+
+            // samples after trigger only need to be counted, until enough were collected
+            if(triggerDetected){
+
+                samplesRead++;
+
+                if(samplesRead < triggerConfig->triggerInfo->samplesAfterTrig){
+                    continue;
+                }
+
+                samplesRead     = 0;
+                triggerDetected = false;
+
+                // sending thread is still busy with all slots, the event is lost but reading goes on
+                // window is taken from the copy, the compressed ring shortens it to the history it still holds
+                event = (kx132_event_t*) spsc_write_slot(&sensor->eventQueue);
+                if(event != NULL){
+                    event->triggerInfo = *triggerConfig->triggerInfo;
+                }
+                if((event == NULL) || !(packed ? rb_pack_take(&pack, &xyzRingbuffer, &event->triggerInfo, &event->view, &event->packView) :
+                                                 rb_view_take(&xyzRingbuffer, &event->triggerInfo, &event->view))){
+                    pthread_mutex_lock(&sensor->sampleStatsMutex);
+                    sensor->sampleStats.eventsDropped++;
+                    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+                    continue;
+                }
+
+                event->type         = kx132_event_trigger;
+
+                for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                    event->normalizedData[axis] = triggerData->normalizedData[axis];
+                }
+
+                spsc_commit_write(&sensor->eventQueue);
+
+                continue; // jump back to evaluating data.
+            }
+
+
+            //-------------------------------------------------------------------
+            //---Trigger Detection  ----------------------------------------------
+            //-------------------------------------------------------------------
+
+            ringIndex = (firstIndex + sample) & ringModulo;
+
+            // values are read in place, one contiguous span of the block at a time
+            if(sample >= spanEnd){
+                spanStart   = sample;
+                spanEnd     = sample + rb_get_span(&xyzRingbuffer, ringIndex, samplesInBlock - sample, xyzSpan);
+            }
+
+            // 8-Bit samples are scaled like 16-Bit samples with empty low bytes
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                if(compact){
+                    xyzFormatted[axis] = (int16_t) (((int8_t*) xyzSpan[axis])[sample - spanStart] * 256);
+                }
+                else{
+                    xyzFormatted[axis] = ((int16_t*) xyzSpan[axis])[sample - spanStart];
+                }
+            }
+
+            triggerDetected = detectAllTriggers(xyzFormatted, triggerConfig, triggerData);
+
+            if(triggerDetected){
+
+                // samples before + after trigger cover the requested time at the real output data rate
+                if(block->sampleRateHz > 0){
+                    setTriggerSampleRate(triggerConfig->triggerInfo, block->sampleRateHz, sensor->outputDataRate);
+                }
+
+                // index of values that triggered the threshold for reading data from ringbuffer
+                triggerConfig->triggerInfo->triggerIndex = ringIndex;
+
+                // remaining samples of the current block already count as samples after trigger
+                continue;
+            }
+        }
+
+        // request waits for a free slot, it is queued behind the trigger events before it
+        if((atomic_load(&sensor->envelopeRequest) > 0) && ((event = (kx132_event_t*) spsc_write_slot(&sensor->eventQueue)) != NULL)){
+            event->type             = kx132_event_envelope;
+            event->envelopeSeconds  = atomic_exchange(&sensor->envelopeRequest, 0);
+            spsc_commit_write(&sensor->eventQueue);
+        }
+
+        // reading thread does not let the wake-up engine go back to sleep during a capture, it checks after the block is released
+        atomic_store(&sensor->capturing, triggerDetected);
+        spsc_commit_read(&sensor->blockQueue);
+    }
+
+
+    spsc_close(&sensor->eventQueue);
+    pthread_join(threadSender, NULL);
+
+    if(packed){
+        printf("[drv_kx132] Compressed history held %u samples in %u of %u KB, %.1f x fewer bytes than the ringbuffer.\n",
+                (pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT,
+                (pack.head - pack.blockOffsets[pack.oldestBlock & (pack.blockCount - 1)]) >> 10,
+                pack.size >> 10,
+                (double) ((pack.blocksWritten - pack.oldestBlock) << RB_PACK_BLOCK_SHIFT) * (NUMBER_OF_AXES * valueSize + sizeof(uint64_t)) /
+                (pack.head - pack.blockOffsets[pack.oldestBlock & (pack.blockCount - 1)] + 1));
+    }
+
+    //-------------------------------------------------------------------
+    //--- Cleanup, errors enter at what was set up last  ----------------
+    //-------------------------------------------------------------------
+
+freeEventQueue:
+    spsc_free(&sensor->eventQueue);
+
+freeEnvelopes:
+    if(sensor->pyramid != NULL){
+        sensor->pyramid = NULL;
+        rb_pyramid_free(&pyramid);
+    }
+
+freePack:
+    if(packed){
+        rb_pack_free(&pack);
+    }
+
+freeBuffers:
+    if(history){
+        rb_file_close(&historyFile, &xyzRingbuffer);
+    }
+    else{
+        rb_multi_free(xyzBuffer, mainConfig->bufferSize, valueSize, mainConfig->bufferLayout);
+        free(timestampBuffer);
+    }
+
+stopReading:
+    // nobody takes blocks after an error, reading thread has already stopped after a normal end
+    kx132_stop();
+
+    return;
+}
+
+
+static void kx132_guard_wait(kx132_sensor_t *sensor, ringbuffer_xyz_t *rb, rb_pack_t *pack, uint32_t numberOfSamples){
+
+    struct timespec guardPoll   = {.tv_sec = 0, .tv_nsec = PIPELINE_POLL_NS};
+    uint64_t        startNs     = 0;
+    uint64_t        stallNs     = 0;
+    bool            first       = false;
+
+    if((pack == NULL) ? rb_push_free(rb, numberOfSamples) : rb_pack_push_free(pack, rb)){
+        return;
+    }
+
+    startNs = ts_now_ns();
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    first = (sensor->sampleStats.guardStalls == 0);
+    sensor->sampleStats.guardStalls++;
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+
+    if(first){
+        printf("[drv_kx132][warning] Sending of sensor %d is too slow, evaluation waits for a window to be released and blocks queue up.\n", sensor->id);
+    }
+
+    while(!((pack == NULL) ? rb_push_free(rb, numberOfSamples) : rb_pack_push_free(pack, rb))){
+        nanosleep(&guardPoll, NULL);
+    }
+
+    stallNs = ts_now_ns() - startNs;
+
+    pthread_mutex_lock(&sensor->sampleStatsMutex);
+    sensor->sampleStats.guardStallNs += stallNs;
+    if(stallNs > sensor->sampleStats.longestGuardStallNs){
+        sensor->sampleStats.longestGuardStallNs = stallNs;
+    }
+    pthread_mutex_unlock(&sensor->sampleStatsMutex);
+}
+
+
+static void *kx132_event_sender(void *kx_sensor){
+
+    kx132_sensor_t*     sensor          = (kx132_sensor_t*) kx_sensor;
+    unit_config_t*      unitConfig      = &sensor->config->mainConfig->unitConfig;
+
+    kx132_event_t*      event           = NULL;
+    float               normalizedUnit  [NUMBER_OF_AXES];
+    bool                compact         = (sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT);
+    bool                physical        = (unitConfig->trigger != unit_counts);
+    rb_envelope_t*      envelopes       = NULL;
+    uint64_t            historySamples  = 0;
+    uint8_t             level           = 0;
+    uint32_t            entries         = 0;
+
+    // newest envelopes are copied out of the pyramid, so pushing never waits for the client
+    if(sensor->pyramid != NULL){
+        envelopes = (rb_envelope_t*) malloc(RB_PYRAMID_ENTRIES * sizeof(rb_envelope_t));
+
+        if(envelopes == NULL){
+            printf("[drv_kx132][error] Envelope buffer could not be allocated, envelopes are not sent.\n");
+        }
+    }
+
+    while((event = spsc_wait_slot(&sensor->eventQueue, PIPELINE_POLL_NS)) != NULL){
+
+        if(event->type == kx132_event_envelope){
+            #ifdef TCP_SERVER
+                if(envelopes != NULL){
+                    historySamples  = (uint64_t) (event->envelopeSeconds * getOutputDataRateHz(sensor->outputDataRate));
+                    level           = rb_pyramid_level(historySamples);
+                    historySamples >>= RB_PYRAMID_SHIFT * (level + 1);
+                    entries         = rb_pyramid_read(sensor->pyramid, level, (historySamples < RB_PYRAMID_ENTRIES) ? historySamples : RB_PYRAMID_ENTRIES, envelopes);
+
+                    // 8-Bit values are high bytes of 16-Bit counts
+                    tcp_send_envelopes(sensor->id, level, envelopes, entries, physical ? unitConfig->triggerScale * (compact ? 256 : 1) : 1);
+                }
+            #endif //TCP_SERVER
+
+            spsc_commit_read(&sensor->eventQueue);
+            continue;
+        }
+
+        #ifdef DEBUG_PRINT_TRIG_DATA
+            rb_span_t   span;
+            uint32_t    offset  = 0;
+
+            printf("-------------------------------\n");
+            printf("-------------------------------\n");
+            for(offset = 0; rb_view_span(event->xyzRingbuffer, event->timestampRingbuffer, &event->view, offset, &span) > 0; offset += span.numberOfSamples){
+                for(uint32_t u = 0; u < span.numberOfSamples; u++){
+                    printf("X:%6.d  |Y:%6.d  |Z:%6.d    --- #%d\n", 
+                            compact ? ((int8_t*) span.xyz[X_INDEX])[u] : ((int16_t*) span.xyz[X_INDEX])[u],
+                            compact ? ((int8_t*) span.xyz[Y_INDEX])[u] : ((int16_t*) span.xyz[Y_INDEX])[u],
+                            compact ? ((int8_t*) span.xyz[Z_INDEX])[u] : ((int16_t*) span.xyz[Z_INDEX])[u],
+                            offset + u);
+                }
+            }
+            printf("-------------------------------\n\n\n\n");
+        #endif //DEBUG_PRINT_TRIG_DATA
+
+
+        #ifdef TCP_SERVER
+            if(physical){
+                // window is converted while it is sent, a window of minutes of history is never held as floats
+                for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                    normalizedUnit[axis] = event->normalizedData[axis] * unitConfig->triggerScale;
+                }
+                tcp_send_trig_view_float(sensor->id, event->xyzRingbuffer, event->timestampRingbuffer, &event->view, event->pack, &event->packView, unitConfig->triggerScale, &event->triggerInfo, normalizedUnit);
+            }
+            else{
+                tcp_send_trig_view(sensor->id, event->xyzRingbuffer, event->timestampRingbuffer, &event->view, event->pack, &event->packView, &event->triggerInfo, event->normalizedData);
+            }
+        #endif //TCP_SERVER
+
+        // samples of the window may be overwritten from now on
+        rb_view_release(event->xyzRingbuffer);
+        if(event->pack != NULL){
+            rb_pack_release(event->pack);
+        }
+        spsc_commit_read(&sensor->eventQueue);
+    }
+
+    free(envelopes);
+
+    return NULL;
+}
+
+
+void kx132_buffer_trigger_mode(kx132_sensor_t *sensor){
+
+    trigger_config_t*   triggerConfig   = sensor->config->triggerConfig;
+    trigger_data_t*     triggerData     = sensor->config->triggerData;
+
+    //-------------------------------------------------------------------
+    //--- Variable Declarations  ----------------------------------------
+    //-------------------------------------------------------------------
+
+    kx132_block_t*  block           = NULL;
+    int16_t         xyzWindow       [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    int8_t          xyzWindow8      [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    int16_t*        xyzReadBuffer   [NUMBER_OF_AXES]    = {xyzWindow[X_INDEX],  xyzWindow[Y_INDEX],  xyzWindow[Z_INDEX]};
+    int8_t*         xyzReadBuffer8  [NUMBER_OF_AXES]    = {xyzWindow8[X_INDEX], xyzWindow8[Y_INDEX], xyzWindow8[Z_INDEX]};
+    float           xyzWindowUnit   [NUMBER_OF_AXES][KX132_BUF_MAX_SAMPLES_8BIT];
+    float*          xyzUnitBuffer   [NUMBER_OF_AXES]    = {xyzWindowUnit[X_INDEX], xyzWindowUnit[Y_INDEX], xyzWindowUnit[Z_INDEX]};
+    float           normalizedUnit  [NUMBER_OF_AXES];
+    trigger_info_t  windowInfo      = *triggerConfig->triggerInfo;
+
+    bool            compact         = (sensor->bytesPerSample == NUMBER_OF_CHANNELS_8BIT);
+    void**          xyzReadCounts   = compact ? (void**) xyzReadBuffer8 : (void**) xyzReadBuffer;
+    unit_config_t*  unitConfig      = &sensor->config->mainConfig->unitConfig;
+    bool            physical        = (unitConfig->trigger != unit_counts);
+    uint32_t        samplesBefore   = kx132_buffer_trigger_samples_before(sensor);
+    uint16_t        samplesInBlock  = 0;
+
+    //-------------------------------------------------------------------
+    //--- Sending Loop  -------------------------------------------------
+    //-------------------------------------------------------------------
+
+    while((block = spsc_wait_slot(&sensor->blockQueue, PIPELINE_POLL_NS)) != NULL)
+    {
+        samplesInBlock = block->numberOfSamples;
+
+        if(compact){
+            convertRawBlock8(block->rawBlock.data, samplesInBlock, xyzWindow8[X_INDEX], xyzWindow8[Y_INDEX], xyzWindow8[Z_INDEX]);
+        }
+        else{
+            convertRawBlock(block->rawBlock.data, samplesInBlock, xyzWindow[X_INDEX], xyzWindow[Y_INDEX], xyzWindow[Z_INDEX]);
+        }
+
+        // SMP_TH samples precede the trigger sample, unless the trigger event came sooner after arming
+        windowInfo.numberOfSamples      = samplesInBlock;
+        windowInfo.samplesBeforeTrig    = samplesBefore;
+        windowInfo.samplesAfterTrig     = samplesInBlock - samplesBefore - 1;
+
+        #ifdef TCP_SERVER
+            if(physical){
+                kx132_convert_to_unit(sensor, xyzReadCounts, samplesInBlock, unitConfig->triggerScale, xyzUnitBuffer);
+
+                for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                    normalizedUnit[axis] = triggerData->normalizedData[axis] * unitConfig->triggerScale;
+                }
+                tcp_send_trig_buffer_float(sensor->id, xyzUnitBuffer, block->timestamps, &windowInfo, normalizedUnit);
+            }
+            else if(compact){
+                tcp_send_trig_buffer_8(sensor->id, xyzReadBuffer8, block->timestamps, &windowInfo, triggerData->normalizedData);
+            }
+            else{
+                tcp_send_trig_buffer(sensor->id, xyzReadBuffer, block->timestamps, &windowInfo, triggerData->normalizedData);
+            }
+        #endif //TCP_SERVER
+
+        spsc_commit_read(&sensor->blockQueue);
+    }
+
+    return;
+}
+
+
+static uint8_t kx132_buffer_trigger_samples_before(kx132_sensor_t *sensor){
+
+    uint32_t samplesBefore = sensor->config->triggerConfig->triggerInfo->samplesBeforeTrig;
+
+    // trigger sample and at least one sample before it have to fit
+    if(samplesBefore >= sensor->bufferCapacity){
+        samplesBefore = sensor->bufferCapacity - 1;
+    }
+
+    return (uint8_t) samplesBefore;
+}
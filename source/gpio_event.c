@@ -0,0 +1,240 @@
+/**
+ * @file gpio_event.c
+ * @author awa
+ * @date 17-10-2026
+ *
+ * @brief Contains functions for waiting on edges of the INT1-PIN of KX132.
+ *
+ *  Edges are read through the Linux GPIO character device (uAPI v2), so the reading thread
+ *  sleeps in the kernel instead of polling INS2 over SPI. For running without hardware
+ *  a simulated source generates edges with a fixed period.
+ *
+ */
+
+#define _GNU_SOURCE     ///< needed for ppoll()
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+///\endcond
+
+#include <gpio_event.h>
+
+
+#define GPIO_CONSUMER_NAME      "kx132_int1"
+#define GPIO_EVENT_BATCH        16          ///< max number of edge events consumed with one read()
+
+#define NSEC_PER_SEC            1000000000
+#define NSEC_PER_USEC           1000
+
+
+//-------------------------------------------------------------------
+//--- Static Function Declarations  ---------------------------------
+//-------------------------------------------------------------------
+
+static bool     gpio_cdev_init      (gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs);
+static int32_t  gpio_cdev_wait      (gpio_event_t *event, uint32_t timeoutUs);
+static void     gpio_cdev_deinit    (gpio_event_t *event);
+
+static bool     gpio_sim_init       (gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs);
+static int32_t  gpio_sim_wait       (gpio_event_t *event, uint32_t timeoutUs);
+static void     gpio_sim_deinit     (gpio_event_t *event);
+
+
+//-------------------------------------------------------------------
+//--- Static Globals  -----------------------------------------------
+//-------------------------------------------------------------------
+
+static const gpio_event_source_t gpioCdevSource = {
+    .init   = gpio_cdev_init,
+    .wait   = gpio_cdev_wait,
+    .deinit = gpio_cdev_deinit,
+};
+
+static const gpio_event_source_t gpioSimSource = {
+    .init   = gpio_sim_init,
+    .wait   = gpio_sim_wait,
+    .deinit = gpio_sim_deinit,
+};
+
+
+//-------------------------------------------------------------------
+//--- Function Definitions  -----------------------------------------
+//-------------------------------------------------------------------
+
+bool gpio_event_init(gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs){
+
+    if(event->source == NULL){
+        switch (gpioConfig->source)
+        {
+            case gpio_source_cdev:
+                event->source = &gpioCdevSource;
+                break;
+
+            case gpio_source_sim:
+                event->source = &gpioSimSource;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return event->source->init(event, gpioConfig, eventPeriodNs);
+}
+
+
+int32_t gpio_event_wait(gpio_event_t *event, uint32_t timeoutUs){
+    if(event->source == NULL){
+        return -1;
+    }
+    return event->source->wait(event, timeoutUs);
+}
+
+
+void gpio_event_deinit(gpio_event_t *event){
+    if(event->source != NULL){
+        event->source->deinit(event);
+    }
+    event->source = NULL;
+}
+
+
+void gpio_event_set_source(gpio_event_t *event, const gpio_event_source_t *newSource, void *context){
+    event->source   = newSource;
+    event->context  = context;
+}
+
+
+//-------------------------------------------------------------------
+//--- GPIO Character Device  ----------------------------------------
+//-------------------------------------------------------------------
+
+static bool gpio_cdev_init(gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs){
+
+    struct gpio_v2_line_request lineRequest;
+
+    event->lineFd = -1;
+
+    int chipFd = open(gpioConfig->chipPath, O_RDONLY | O_CLOEXEC);
+    if(chipFd < 0){
+        printf("[gpio][error] Could not open %s.\n", gpioConfig->chipPath);
+        return false;
+    }
+
+    memset(&lineRequest, 0, sizeof(lineRequest));
+    strncpy(lineRequest.consumer, GPIO_CONSUMER_NAME, sizeof(lineRequest.consumer) - 1);
+
+    lineRequest.offsets[0]          = gpioConfig->line;
+    lineRequest.num_lines           = 1;
+    lineRequest.event_buffer_size   = GPIO_EVENT_BATCH;
+    lineRequest.config.flags        = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+
+    if(ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &lineRequest) < 0){
+        printf("[gpio][error] Could not request line %u of %s.\n", gpioConfig->line, gpioConfig->chipPath);
+        close(chipFd);
+        return false;
+    }
+
+    // line fd stays valid after closing the chip
+    close(chipFd);
+    event->lineFd = lineRequest.fd;
+
+    printf("[gpio] Waiting for INT1 on line %u of %s.\n", gpioConfig->line, gpioConfig->chipPath);
+    return true;
+}
+
+
+static int32_t gpio_cdev_wait(gpio_event_t *event, uint32_t timeoutUs){
+
+    struct gpio_v2_line_event   events      [GPIO_EVENT_BATCH];
+    struct pollfd               pollFd;
+    struct timespec             timeout;
+    ssize_t                     bytesRead   = 0;
+
+    pollFd.fd       = event->lineFd;
+    pollFd.events   = POLLIN;
+    pollFd.revents  = 0;
+
+    timeout.tv_sec  = timeoutUs / 1000000;
+    timeout.tv_nsec = (timeoutUs % 1000000) * NSEC_PER_USEC;
+
+    int ret = ppoll(&pollFd, 1, &timeout, NULL);
+    if(ret <= 0){
+        return ret;
+    }
+
+    // consume every queued edge, reading happens once for all of them
+    bytesRead = read(event->lineFd, events, sizeof(events));
+    if(bytesRead < 0){
+        return -1;
+    }
+
+    return (int32_t) (bytesRead / sizeof(struct gpio_v2_line_event));
+}
+
+
+static void gpio_cdev_deinit(gpio_event_t *event){
+    if(event->lineFd >= 0){
+        close(event->lineFd);
+    }
+    event->lineFd = -1;
+}
+
+
+//-------------------------------------------------------------------
+//--- Simulated Source  ---------------------------------------------
+//-------------------------------------------------------------------
+
+static bool gpio_sim_init(gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs){
+
+    if(eventPeriodNs == 0){
+        return false;
+    }
+
+    event->simPeriodNs = eventPeriodNs;
+    clock_gettime(CLOCK_MONOTONIC, &event->simNextEdge);
+
+    printf("[gpio] Simulating INT1 every %llu ns.\n", (unsigned long long) event->simPeriodNs);
+    return true;
+}
+
+
+static int32_t gpio_sim_wait(gpio_event_t *event, uint32_t timeoutUs){
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int64_t untilEdgeNs = (int64_t) (event->simNextEdge.tv_sec - now.tv_sec) * NSEC_PER_SEC + (event->simNextEdge.tv_nsec - now.tv_nsec);
+
+    if(untilEdgeNs > (int64_t) timeoutUs * NSEC_PER_USEC){
+        usleep(timeoutUs);
+        return 0;
+    }
+
+    if(untilEdgeNs > 0){
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &event->simNextEdge, NULL);
+    }
+
+    // schedule next edge on a fixed grid, so simulated edges do not drift
+    event->simNextEdge.tv_nsec += event->simPeriodNs;
+    while(event->simNextEdge.tv_nsec >= NSEC_PER_SEC){
+        event->simNextEdge.tv_nsec -= NSEC_PER_SEC;
+        event->simNextEdge.tv_sec++;
+    }
+
+    return 1;
+}
+
+
+static void gpio_sim_deinit(gpio_event_t *event){
+    event->simPeriodNs = 0;
+}
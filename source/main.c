@@ -15,8 +15,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <string.h>
 #include <pthread.h>
-#include <sys/resource.h>
 ///\endcond
 
 #include <regs_kx132.h>
@@ -28,6 +28,9 @@
 #include <trigger.h>
 #include <utility.h>
 #include <tcp.h>
+#include <gpio_event.h>
+#include <sim_kx132.h>
+#include <rt_thread.h>
 #include <debug_macros.h>
 
 
@@ -47,62 +50,107 @@ int main(uint16_t argc, char* argv[]){
     //-------------------------------------------------------------------
 
     // Declaration of variables for threading
-    pthread_t           threadMainLoop;
+    pthread_t           threadMainLoop      [KX132_MAX_SENSORS];
+    pthread_t           threadConsumer      [KX132_MAX_SENSORS];
     pthread_t           threadRuntimeConfig;
-
-    // Declaration of variables for hardware-, software- and trigger-config
-    kx132_config_t      kx132_config;
-    
-    main_config_t       mainConfig;
-    trigger_config_t    triggerConfig;
-    trigger_data_t      triggerData;
+    bool                consumerRunning     [KX132_MAX_SENSORS] = {false};
+    bool                mainLoopRunning     [KX132_MAX_SENSORS] = {false};
+    bool                runtimeConfigRunning = false;
+    bool                threadsFailed       = false;
+
+    // Declaration of variables for hardware-, software- and trigger-config, one set per sensor
+    kx132_config_t      kx132_config        [KX132_MAX_SENSORS];
+    kx132_sensor_t      sensors             [KX132_MAX_SENSORS];
+    sim_kx132_t         simulators          [KX132_MAX_SENSORS];
+    uint8_t             numberOfSensors     = 0;
+
+    main_config_t       mainConfig          [KX132_MAX_SENSORS];
+    trigger_config_t    triggerConfig       [KX132_MAX_SENSORS];
+    trigger_data_t      triggerData         [KX132_MAX_SENSORS];
     
-    offsetThreshold_t   offsetThreshold;
-    trigger_info_t      triggerInfo;
+    offsetThreshold_t   offsetThreshold     [KX132_MAX_SENSORS];
+    trigger_info_t      triggerInfo         [KX132_MAX_SENSORS];
     
-    uint16_t            offsetThresholds	[NUMBER_OF_AXES];
-    int32_t             positiveThresholds	[NUMBER_OF_AXES];
-    int32_t             negativeThresholds	[NUMBER_OF_AXES];
+    uint16_t            offsetThresholds	[KX132_MAX_SENSORS][NUMBER_OF_AXES];
+    int32_t             positiveThresholds	[KX132_MAX_SENSORS][NUMBER_OF_AXES];
+    int32_t             negativeThresholds	[KX132_MAX_SENSORS][NUMBER_OF_AXES];
 
-    int16_t             fixedThresholds		[NUMBER_OF_AXES];
-    int16_t             xyzNormalizedValues	[NUMBER_OF_AXES];
+    int16_t             fixedThresholds		[KX132_MAX_SENSORS][NUMBER_OF_AXES];
+    int16_t             xyzNormalizedValues	[KX132_MAX_SENSORS][NUMBER_OF_AXES];
 
-    kx132_config.mainConfig                     = &mainConfig;
-    kx132_config.triggerConfig                  = &triggerConfig;
-    kx132_config.triggerData                    = &triggerData;
+    memset(sensors,     0, sizeof(sensors));
+    memset(simulators,  0, sizeof(simulators));
 
-    offsetThreshold.offsetThresholdValues       = offsetThresholds;
-    offsetThreshold.positiveThresholdValues     = positiveThresholds;
-    offsetThreshold.negativeThresholdValues     = negativeThresholds;
+    for(uint8_t s = 0; s < KX132_MAX_SENSORS; s++){
+        kx132_config[s].mainConfig                  = &mainConfig[s];
+        kx132_config[s].triggerConfig               = &triggerConfig[s];
+        kx132_config[s].triggerData                 = &triggerData[s];
 
-    triggerData.fixedThresholds                 = fixedThresholds;
-    triggerData.normalizedData                  = xyzNormalizedValues;
-    triggerData.offsetThreshold                 = &offsetThreshold;
+        offsetThreshold[s].offsetThresholdValues    = offsetThresholds[s];
+        offsetThreshold[s].positiveThresholdValues  = positiveThresholds[s];
+        offsetThreshold[s].negativeThresholdValues  = negativeThresholds[s];
 
-    triggerConfig.triggerInfo                   = &triggerInfo;
+        triggerData[s].fixedThresholds              = fixedThresholds[s];
+        triggerData[s].normalizedData               = xyzNormalizedValues[s];
+        triggerData[s].offsetThreshold              = &offsetThreshold[s];
+
+        triggerConfig[s].triggerInfo                = &triggerInfo[s];
+
+        sensors[s].id                               = s;
+        sensors[s].config                           = &kx132_config[s];
+    }
 
 
     //-------------------------------------------------------------------
     //--- Initialiazing Functions  --------------------------------------
     //-------------------------------------------------------------------
 
-    kx132_config_init(argc, argv, &kx132_config);
-
-    if(!spi_init()){
-        printf("[main][error] SPI Init failed.\n");
+    numberOfSensors = kx132_config_init(argc, argv, kx132_config, KX132_MAX_SENSORS);
+    if(numberOfSensors == 0){
+        printf("[main][error] No sensor configured.\n");
         return -1;
     }
 
-    // make sure KX132 is in a defined state after eventual program restart
-    kx132_software_reset();
+    for(uint8_t s = 0; s < numberOfSensors; s++){
 
-    if(!kx132_init(&kx132_config)){
-        printf("[main][error] KX132 Accelerometer Init failed.\n");
-        return -1;
+        if(mainConfig[s].spiConfig.backend == spi_backend_sim){
+            if(!sim_kx132_configure(&simulators[s], &mainConfig[s].simConfig)){
+                printf("[main][error] Simulated KX132 config failed.\n");
+                return -1;
+            }
+
+            // every sensor on the simulated bus is its own simulated KX132
+            sensors[s].spiDevice.context = &simulators[s];
+
+            // simulated INT1 follows the interrupt engine of the simulated sensor
+            if(mainConfig[s].int1Config.source == gpio_source_sim){
+                gpio_event_set_source(&sensors[s].int1Event, &sim_kx132_int1_source, &simulators[s]);
+            }
+        }
+
+        if(!spi_init(&sensors[s].spiDevice, &mainConfig[s].spiConfig)){
+            printf("[main][error] SPI Init of sensor %d failed.\n", s);
+            return -1;
+        }
+
+        // make sure KX132 is in a defined state after eventual program restart
+        kx132_software_reset(&sensors[s]);
+
+        if(mainConfig[s].spiConfig.autoClock && !kx132_spi_calibrate(&sensors[s])){
+            printf("[main][error] SPI clock of sensor %d could not be calibrated.\n", s);
+            return -1;
+        }
+
+        if(!kx132_init(&sensors[s])){
+            printf("[main][error] KX132 Accelerometer Init of sensor %d failed.\n", s);
+            return -1;
+        }
     }
 
-    normalizeThresholds(mainConfig.readMode_hw, &triggerData);
-    setOffsetThresholds(&triggerData);
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        normalizeThresholds(&sensors[s]);
+        setOffsetThresholds(&triggerData[s]);
+    }
 
     #ifdef TCP_SERVER
     if(!tcp_server_init()){
@@ -115,28 +163,79 @@ int main(uint16_t argc, char* argv[]){
     //--- KX132 Communication - Main Program Loop  ----------------------
     //-------------------------------------------------------------------
 
-    pthread_create( &threadMainLoop, NULL, kx132_main_loop, &kx132_config);
+    // lock before creating threads, so their stacks are locked as well
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        if(mainConfig[s].rtConfig.lockMemory){
+            rt_lock_memory();
+            break;
+        }
+    }
+
+    // one reading thread per sensor, sensors on the same bus are serialized by the lock of the bus
+    // processing and sending happen in threads of their own with default scheduling, created here so they do not inherit real-time
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        if(pthread_create(&threadConsumer[s], NULL, kx132_consumer_loop, &sensors[s]) != 0){
+            printf("[main][error] Processing thread of sensor %d could not be created.\n", s);
+            threadsFailed = true;
+            break;
+        }
+        consumerRunning[s] = true;
+
+        if(rt_thread_create(&threadMainLoop[s], &mainConfig[s].rtConfig, kx132_main_loop, &sensors[s]) == rt_thread_failed){
+            printf("[main][error] Reading thread of sensor %d could not be created.\n", s);
+            // processing thread only returns once the queue is closed
+            spsc_close(&sensors[s].blockQueue);
+            threadsFailed = true;
+            break;
+        }
+        mainLoopRunning[s] = true;
+    }
 
     #ifdef TCP_SERVER
-        pthread_create( &threadRuntimeConfig, NULL, kx132_runtime_config, &kx132_config);
+        if(!threadsFailed){
+            if(pthread_create( &threadRuntimeConfig, NULL, kx132_runtime_config, NULL) != 0){
+                printf("[main][error] Runtime config thread could not be created.\n");
+                threadsFailed = true;
+            }
+            else{
+                runtimeConfigRunning = true;
+            }
+        }
     #endif //TCP_SERVER
 
-    pthread_join(threadMainLoop, NULL);
+    // threads already running are stopped, the client could not stop them without the runtime config
+    if(threadsFailed){
+        kx132_stop();
+    }
 
-    #ifdef TCP_SERVER
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        if(mainLoopRunning[s]){
+            pthread_join(threadMainLoop[s], NULL);
+        }
+        if(consumerRunning[s]){
+            pthread_join(threadConsumer[s], NULL);
+        }
+    }
+
+    if(runtimeConfigRunning){
         pthread_join(threadRuntimeConfig, NULL);
-    #endif //TCP_SERVER
+    }
 
 
 
     // turn KX132 off
-    kx132_software_reset();
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        kx132_software_reset(&sensors[s]);
+        gpio_event_deinit(&sensors[s].int1Event);
+    }
 
     #ifdef TCP_SERVER
     tcp_server_close();
     #endif
 
-    spi_deinit();
+    for(uint8_t s = 0; s < numberOfSensors; s++){
+        spi_deinit(&sensors[s].spiDevice);
+    }
 
     printf("\n");
     printf("---------------------------------\n");
@@ -144,6 +243,6 @@ int main(uint16_t argc, char* argv[]){
     printf("---------------------------------\n");
     printf("\n");
 
-    return 0;
+    return threadsFailed ? -1 : 0;
 }
 
@@ -9,15 +9,201 @@
  * 
  */
 
+#define _GNU_SOURCE     ///< needed for memfd_create() and sync_file_range()
+
 ///\cond
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 ///\endcond
 
 #include <ringbuffer.h>
 #include <macros_kx132.h>
 #include <trigger.h>
+#include <utility.h>
+
+
+/**
+ * @brief Returns the address of one value of a multi-axis ringbuffer.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param axis          axis of value
+ * @param localIndex    local index of sample
+ * @return uint8_t*     pointer to value
+ */
+static inline uint8_t *rb_multi_value(ringbuffer_xyz_t *rb, axis_t axis, uint32_t localIndex);
+
+
+/**
+ * @brief Returns how many samples from localIndex on are stored contiguously per axis.
+ * 
+ *  SoA only breaks at the end of the buffer, interleaved at the end of every block, mirrored never.
+ * 
+ * @param rb            pointer to ringbuffer
+ * @param localIndex    local index of first sample
+ * @param remaining     samples still to be copied
+ * @return uint32_t     samples in span, at most remaining
+ */
+static inline uint32_t rb_multi_span(ringbuffer_xyz_t *rb, uint32_t localIndex, uint32_t remaining);
+
+
+/**
+ * @brief Maps the axes of a multi-axis ringbuffer from a file, twice per axis for the mirrored layout.
+ * 
+ * @param fd            file holding the axes, X at offset, Y and Z follow
+ * @param offset        offset of X in file, multiple of page size
+ * @param size          samples per axis
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param layout        storage layout of the axes
+ * @param prot          protection of mappings
+ * @return uint8_t*     pointer to buffer of rb_multi_bytes() bytes, NULL if error
+ */
+static uint8_t *rb_map_axes(int fd, off_t offset, uint32_t size, uint8_t valueSize, rb_layout_t layout, int prot);
+
+
+/**
+ * @brief Returns the FNV-1a hash of all fields of a history file header before its checksum.
+ * 
+ * @param header        pointer to header
+ * @return uint32_t     checksum
+ */
+static uint32_t rb_file_checksum(const rb_file_header_t *header);
+
+
+/**
+ * @brief Sets the header of a history file to index and starts writing it back.
+ * 
+ * @param file          pointer to history file
+ * @param index         index (not wrapped), all samples before are on disk
+ */
+static void rb_file_write_header(rb_file_t *file, uint32_t index);
+
+
+/**
+ * @brief Returns CLOCK_REALTIME - CLOCK_MONOTONIC, the same in every run since the last boot.
+ * 
+ * @return int64_t      offset in nanoseconds
+ */
+static int64_t rb_file_realtime_offset_ns(void);
+
+
+/**
+ * @brief Calls sync_file_range() for the axes and timestamps of the samples from index from to index to.
+ * 
+ * @param file          pointer to history file
+ * @param from          index (not wrapped) of first sample
+ * @param to            index (not wrapped) after last sample, at most size samples after from are covered
+ * @param flags         flags of sync_file_range()
+ */
+static void rb_file_range(rb_file_t *file, uint32_t from, uint32_t to, unsigned int flags);
+
+
+/**
+ * @brief Starts the next envelope of a pyramid level.
+ * 
+ * @param level         pointer to level
+ */
+static void rb_pyramid_reset(rb_pyramid_level_t *level);
+
+
+/**
+ * @brief Adds values of one axis to the envelope accumulated by the first level of a pyramid.
+ * 
+ * @param first         pointer to first level
+ * @param axis          axis of values
+ * @param values        pointer to int16_t (int8_t if valueSize is sizeof(int8_t)) values
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t)
+ * @param numberOfValues number of values
+ */
+static inline void rb_pyramid_add(rb_pyramid_level_t *first, axis_t axis, const void *values, uint8_t valueSize, uint32_t numberOfValues);
+
+
+/**
+ * @brief Stores the accumulated envelope of a level in its ring and adds it to the level above.
+ * 
+ * @param pyramid       pointer to pyramid
+ * @param level         level, 0 for envelopes of 16 samples
+ */
+static void rb_pyramid_complete(rb_pyramid_t *pyramid, uint8_t level);
+
+
+/**
+ * @brief Hands out a view of samples of a multi-axis ringbuffer, the caller checked that a view is free.
+ * 
+ * @param rb                pointer to ringbuffer
+ * @param firstSample       index (not wrapped) of first sample
+ * @param numberOfSamples   samples in view, at most size of ringbuffer
+ * @param view              pointer to view
+ */
+static void rb_view_pin(ringbuffer_xyz_t *rb, uint32_t firstSample, uint32_t numberOfSamples, rb_view_t *view);
+
+
+/**
+ * @brief Drops samples from the front of a window, samples before trigger first, then the trigger and samples after it.
+ * 
+ *  The trigger stays numberOfSamples - samplesAfterTrig into the window, 0 once it was dropped.
+ * 
+ * @param triggerInfo   pointer to window
+ * @param missing       samples to drop, at most numberOfSamples
+ */
+static void rb_window_shorten(trigger_info_t *triggerInfo, uint32_t missing);
+
+
+/**
+ * @brief Encodes one block of all axes and timestamps.
+ * 
+ * @param xyz           values of every axis
+ * @param timestamps    timestamps of the samples
+ * @param out           pointer to at least RB_PACK_MAX_BYTES bytes
+ * @return uint32_t     bytes written
+ */
+static uint32_t rb_pack_encode(int32_t (*xyz)[RB_PACK_BLOCK_SAMPLES], const uint64_t *timestamps, uint8_t *out);
+
+
+/**
+ * @brief Decodes one block of all axes and timestamps.
+ * 
+ * @param in            pointer to block, followed by RB_PACK_SLACK_BYTES readable bytes
+ * @param valueSize     sizeof(int16_t) or sizeof(int8_t) of the values written
+ * @param xyz           pointer to 3 arrays of RB_PACK_BLOCK_SAMPLES values
+ * @param timestamps    pointer to array of RB_PACK_BLOCK_SAMPLES timestamps
+ */
+static void rb_pack_decode(const uint8_t *in, uint8_t valueSize, void **xyz, uint64_t *timestamps);
+
+
+/**
+ * @brief Writes values of the same width, least significant bit first.
+ * 
+ * @param out           pointer to output
+ * @param values        pointer to values, less than 2^width
+ * @param numberOfValues number of values
+ * @param width         bits per value (0 - 64)
+ * @return uint8_t*     pointer after last byte written
+ */
+static uint8_t *rb_pack_bits(uint8_t *out, const uint64_t *values, uint32_t numberOfValues, uint8_t width);
+
+
+/**
+ * @brief Reads values written by rb_pack_bits().
+ * 
+ * @param in            pointer to input, followed by RB_PACK_SLACK_BYTES readable bytes
+ * @param values        pointer to values
+ * @param numberOfValues number of values
+ * @param width         bits per value (0 - 64)
+ * @return const uint8_t* pointer after last byte read
+ */
+static const uint8_t *rb_unpack_bits(const uint8_t *in, uint64_t *values, uint32_t numberOfValues, uint8_t width);
+
 
 
 bool rb_init(ringbuffer_t *rb, int16_t *buffer, uint32_t size){
@@ -94,4 +280,1255 @@ void rb_read_chunk(ringbuffer_t *rb, int16_t *buffer, trigger_info_t *triggerInf
         localIndex &= rb->modulo;
         bufferIndex++;
     }
+}
+
+
+size_t rb_multi_bytes(uint32_t size, uint8_t valueSize, rb_layout_t layout){
+    return (size_t) NUMBER_OF_AXES * size * valueSize * ((layout == rb_layout_mirrored) ? 2 : 1);
+}
+
+
+void *rb_multi_alloc(uint32_t size, uint8_t valueSize, rb_layout_t layout){
+
+    size_t      axisBytes   = (size_t) size * valueSize;
+    long        pageSize    = sysconf(_SC_PAGESIZE);
+    uint8_t*    buffer      = NULL;
+    int         fd          = -1;
+
+    if(layout != rb_layout_mirrored){
+        return aligned_alloc(RB_CACHE_LINE, rb_multi_bytes(size, valueSize, layout));
+    }
+
+    if((pageSize <= 0) || ((axisBytes % pageSize) != 0)){
+        printf("[ringbuffer][error] ringbuffer of %u samples per axis can not be mirrored, pages of %ld bytes\n", size, pageSize);
+        return NULL;
+    }
+
+    // memory of all axes, X at offset 0, Y at axisBytes, Z at 2 * axisBytes
+    fd = memfd_create("kx132_ringbuffer", MFD_CLOEXEC);
+
+    if(fd < 0){
+        perror("[ringbuffer][error] memfd_create");
+        return NULL;
+    }
+
+    if(ftruncate(fd, NUMBER_OF_AXES * axisBytes) != 0){
+        perror("[ringbuffer][error] ftruncate");
+        close(fd);
+        return NULL;
+    }
+
+    buffer = rb_map_axes(fd, 0, size, valueSize, layout, PROT_READ | PROT_WRITE);
+
+    // mappings keep the memory alive
+    close(fd);
+
+    return buffer;
+}
+
+
+static uint8_t *rb_map_axes(int fd, off_t offset, uint32_t size, uint8_t valueSize, rb_layout_t layout, int prot){
+
+    size_t      axisBytes   = (size_t) size * valueSize;
+    size_t      bytes       = rb_multi_bytes(size, valueSize, layout);
+    uint8_t*    buffer      = NULL;
+    bool        mapped      = true;
+
+    // address space is reserved first, so the mappings of the axes can be placed back to back
+    buffer = mmap(NULL, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(buffer == MAP_FAILED){
+        perror("[ringbuffer][error] mmap");
+        return NULL;
+    }
+
+    if(layout == rb_layout_mirrored){
+        // X X' Y Y' Z Z', the second mapping of an axis continues its first one seamlessly
+        for(uint32_t mapping = 0; mapping < 2 * NUMBER_OF_AXES; mapping++){
+            mapped &= (mmap(&buffer[mapping * axisBytes], axisBytes, prot, MAP_SHARED | MAP_FIXED, fd, offset + (mapping / 2) * axisBytes) != MAP_FAILED);
+        }
+    }
+    else{
+        mapped = (mmap(buffer, bytes, prot, MAP_SHARED | MAP_FIXED, fd, offset) != MAP_FAILED);
+    }
+
+    if(!mapped){
+        perror("[ringbuffer][error] mmap");
+        munmap(buffer, bytes);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+
+void rb_multi_free(void *buffer, uint32_t size, uint8_t valueSize, rb_layout_t layout){
+
+    if(buffer == NULL){
+        return;
+    }
+
+    if(layout == rb_layout_mirrored){
+        munmap(buffer, rb_multi_bytes(size, valueSize, layout));
+    }
+    else{
+        free(buffer);
+    }
+}
+
+
+bool rb_multi_init(ringbuffer_xyz_t *rb, void *buffer, uint32_t size, uint8_t valueSize, rb_layout_t layout){
+
+    rb->buffer          = (uint8_t*) buffer;
+    rb->size            = size;
+    rb->modulo          = rb->size - 1;
+    rb->index           = 0;
+    rb->valueSize       = valueSize;
+    rb->layout          = layout;
+    rb->blockSamples    = RB_CACHE_LINE / valueSize;
+    rb->blockShift      = 0;
+    rb->viewsTaken      = 0;
+    atomic_init(&rb->viewsReleased, 0);
+
+    while((1u << rb->blockShift) < rb->blockSamples){
+        rb->blockShift++;
+    }
+
+    if((rb->size & (rb->size - 1)) != 0) {
+        printf("[ringbuffer][error] size of ringbuffer is not power of two\n");
+        return false;
+    }
+
+    if((valueSize != sizeof(int16_t)) && (valueSize != sizeof(int8_t))){
+        printf("[ringbuffer][error] values of %d bytes are not supported\n", valueSize);
+        return false;
+    }
+
+    if((layout == rb_layout_interleaved) && (rb->size < rb->blockSamples)){
+        printf("[ringbuffer][error] size of ringbuffer is smaller than one interleaved block\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+static inline uint8_t *rb_multi_value(ringbuffer_xyz_t *rb, axis_t axis, uint32_t localIndex){
+
+    uint32_t element = 0;
+
+    if(rb->layout == rb_layout_interleaved){
+        element = (((localIndex >> rb->blockShift) * NUMBER_OF_AXES + axis) << rb->blockShift) + (localIndex & (rb->blockSamples - 1));
+    }
+    else if(rb->layout == rb_layout_mirrored){
+        element = axis * 2 * rb->size + localIndex;
+    }
+    else{
+        element = axis * rb->size + localIndex;
+    }
+
+    return &rb->buffer[(size_t) element * rb->valueSize];
+}
+
+
+static inline uint32_t rb_multi_span(ringbuffer_xyz_t *rb, uint32_t localIndex, uint32_t remaining){
+
+    uint32_t span = rb->size - localIndex;
+
+    if(rb->layout == rb_layout_interleaved){
+        span = rb->blockSamples - (localIndex & (rb->blockSamples - 1));
+    }
+    else if(rb->layout == rb_layout_mirrored){
+        // reading on past the end of an axis lands in its second mapping, i.e. at index 0 again
+        span = rb->size;
+    }
+
+    return (span < remaining) ? span : remaining;
+}
+
+
+uint32_t rb_push_block(ringbuffer_xyz_t *rb, void **xyzData, uint32_t numberOfSamples){
+
+    uint32_t firstIndex     = rb->index & rb->modulo;
+    uint32_t localIndex     = firstIndex;
+    uint32_t done           = 0;
+    uint32_t span           = 0;
+
+    while(done < numberOfSamples){
+        span = rb_multi_span(rb, localIndex, numberOfSamples - done);
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            memcpy(rb_multi_value(rb, axis, localIndex), (uint8_t*) xyzData[axis] + (size_t) done * rb->valueSize, (size_t) span * rb->valueSize);
+        }
+
+        done       += span;
+        localIndex  = (localIndex + span) & rb->modulo;
+    }
+
+    rb->index += numberOfSamples;
+
+    return firstIndex;
+}
+
+
+uint32_t rb_push_raw_block(ringbuffer_xyz_t *rb, const uint8_t *xyzRawData, uint32_t numberOfSamples){
+
+    uint32_t firstIndex     = rb->index & rb->modulo;
+    uint32_t localIndex     = firstIndex;
+    uint32_t done           = 0;
+    uint32_t span           = 0;
+
+    // every contiguous span is decoded straight into place, interleaved blocks take one decoder call each
+    while(done < numberOfSamples){
+        span = rb_multi_span(rb, localIndex, numberOfSamples - done);
+
+        if(rb->valueSize == sizeof(int8_t)){
+            convertRawBlock8(&xyzRawData[done * NUMBER_OF_CHANNELS_8BIT], span,
+                             (int8_t*) rb_multi_value(rb, X_INDEX, localIndex),
+                             (int8_t*) rb_multi_value(rb, Y_INDEX, localIndex),
+                             (int8_t*) rb_multi_value(rb, Z_INDEX, localIndex));
+        }
+        else{
+            convertRawBlock(&xyzRawData[done * NUMBER_OF_CHANNELS], span,
+                            (int16_t*) rb_multi_value(rb, X_INDEX, localIndex),
+                            (int16_t*) rb_multi_value(rb, Y_INDEX, localIndex),
+                            (int16_t*) rb_multi_value(rb, Z_INDEX, localIndex));
+        }
+
+        done       += span;
+        localIndex  = (localIndex + span) & rb->modulo;
+    }
+
+    rb->index += numberOfSamples;
+
+    return firstIndex;
+}
+
+
+uint32_t rb_get_span(ringbuffer_xyz_t *rb, uint32_t localIndex, uint32_t numberOfSamples, void **xyzSpan){
+
+    localIndex &= rb->modulo;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        xyzSpan[axis] = rb_multi_value(rb, axis, localIndex);
+    }
+
+    return rb_multi_span(rb, localIndex, numberOfSamples);
+}
+
+
+void rb_read_block(ringbuffer_xyz_t *rb, void **xyzBuffer, trigger_info_t *triggerInfo){
+
+    uint32_t sumOfSamples = triggerInfo->numberOfSamples;
+
+    if(sumOfSamples > rb->size){
+        printf("[ringbuffer][warning] Sum of requested samples exceeds size of buffer.\n");
+        sumOfSamples = rb->size;
+    }
+
+    uint32_t bufferIndex    = 0;
+    uint32_t localIndex     = (triggerInfo->triggerIndex - triggerInfo->samplesBeforeTrig) & rb->modulo;
+    uint32_t span           = 0;
+
+    while(bufferIndex < sumOfSamples){
+        span = rb_multi_span(rb, localIndex, sumOfSamples - bufferIndex);
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            memcpy((uint8_t*) xyzBuffer[axis] + (size_t) bufferIndex * rb->valueSize, rb_multi_value(rb, axis, localIndex), (size_t) span * rb->valueSize);
+        }
+
+        bufferIndex    += span;
+        localIndex      = (localIndex + span) & rb->modulo;
+    }
+}
+
+
+bool rb_view_take(ringbuffer_xyz_t *rb, trigger_info_t *triggerInfo, rb_view_t *view){
+
+    uint32_t released       = atomic_load_explicit(&rb->viewsReleased, memory_order_acquire);
+    uint32_t firstSample    = 0;
+    uint32_t missing        = 0;
+
+    if(rb->viewsTaken - released == RB_MAX_VIEWS){
+        return false;
+    }
+
+    // trigger lies within the ringbuffer, the window may reach further back
+    firstSample = rb->index - ((rb->index - triggerInfo->triggerIndex) & rb->modulo) - triggerInfo->samplesBeforeTrig;
+
+    // a window reaching further back than the ringbuffer starts at its oldest sample, the header announces what is sent
+    if((int32_t) (rb->index - rb->size - firstSample) > 0){
+        missing = rb->index - rb->size - firstSample;
+        missing = (missing > triggerInfo->numberOfSamples) ? triggerInfo->numberOfSamples : missing;
+
+        firstSample += missing;
+        rb_window_shorten(triggerInfo, missing);
+    }
+
+    rb_view_pin(rb, firstSample, triggerInfo->numberOfSamples, view);
+
+    return true;
+}
+
+
+static void rb_window_shorten(trigger_info_t *triggerInfo, uint32_t missing){
+
+    uint32_t before = (missing > triggerInfo->samplesBeforeTrig) ? triggerInfo->samplesBeforeTrig : missing;
+
+    if(missing > before + 1){
+        triggerInfo->samplesAfterTrig -= missing - before - 1;
+    }
+    triggerInfo->samplesBeforeTrig  -= before;
+    triggerInfo->numberOfSamples    -= missing;
+}
+
+
+static void rb_view_pin(ringbuffer_xyz_t *rb, uint32_t firstSample, uint32_t numberOfSamples, rb_view_t *view){
+
+    view->numberOfSamples   = numberOfSamples;
+    view->localIndex        = firstSample & rb->modulo;
+
+    rb->viewFirst[rb->viewsTaken & (RB_MAX_VIEWS - 1)] = firstSample;
+    rb->viewsTaken++;
+}
+
+
+void rb_view_release(ringbuffer_xyz_t *rb){
+
+    uint32_t released = atomic_load_explicit(&rb->viewsReleased, memory_order_relaxed);
+
+    // all reads of the view happen before the writer sees it released
+    atomic_store_explicit(&rb->viewsReleased, released + 1, memory_order_release);
+}
+
+
+bool rb_push_free(ringbuffer_xyz_t *rb, uint32_t numberOfSamples){
+
+    uint32_t released   = atomic_load_explicit(&rb->viewsReleased, memory_order_acquire);
+
+    // a push of numberOfSamples overwrites every sample written more than size - numberOfSamples samples before the next one
+    for(uint32_t view = released; view != rb->viewsTaken; view++){
+        if(rb->index + numberOfSamples - rb->viewFirst[view & (RB_MAX_VIEWS - 1)] > rb->size){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+uint32_t rb_view_span(ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, uint32_t offset, rb_span_t *span){
+
+    uint32_t localIndex = (view->localIndex + offset) & rb->modulo;
+    uint32_t samples    = rb_get_span(rb, localIndex, view->numberOfSamples - offset, span->xyz);
+    uint32_t tsSamples  = rbTs->size - (localIndex & rbTs->modulo);
+
+    span->timestamps        = &rbTs->buffer[localIndex & rbTs->modulo];
+    span->numberOfSamples   = (samples < tsSamples) ? samples : tsSamples;
+
+    return span->numberOfSamples;
+}
+
+
+bool rb_file_open(rb_file_t *file, const char *path, uint32_t size, uint8_t valueSize, rb_layout_t layout){
+
+    long                pageSize        = sysconf(_SC_PAGESIZE);
+    size_t              axisBytes       = (size_t) size * valueSize;
+    size_t              axesBytes       = 0;
+    size_t              timestampBytes  = 0;
+    size_t              fileBytes       = 0;
+    struct stat         fileStat;
+    rb_file_header_t    header;
+    bool                valid           = false;
+    int                 error           = 0;
+
+    memset(file, 0, sizeof(rb_file_t));
+    file->fd        = -1;
+    file->size      = size;
+    file->valueSize = valueSize;
+    file->layout    = layout;
+
+    if((pageSize <= 0) || ((layout == rb_layout_mirrored) && ((axisBytes % pageSize) != 0))){
+        printf("[ringbuffer][error] ringbuffer of %u samples per axis can not be mirrored, pages of %ld bytes\n", size, pageSize);
+        return false;
+    }
+
+    // header page | X Y Z | timestamps, every part starts on a page
+    axesBytes               = (NUMBER_OF_AXES * axisBytes + pageSize - 1) / pageSize * pageSize;
+    timestampBytes          = ((size_t) size * sizeof(uint64_t) + pageSize - 1) / pageSize * pageSize;
+    file->axesOffset        = pageSize;
+    file->timestampOffset   = pageSize + axesBytes;
+    fileBytes               = file->timestampOffset + timestampBytes;
+
+    file->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if((file->fd < 0) || (fstat(file->fd, &fileStat) != 0)){
+        printf("[ringbuffer][error] History file %s could not be opened.\n", path);
+        goto closeFile;
+    }
+
+    // header of the last run is only used, if it is complete and describes the same ringbuffer
+    if((fileStat.st_size == (off_t) fileBytes) && (pread(file->fd, &header, sizeof(header), 0) == sizeof(header))){
+        valid = (header.magic       == RB_FILE_MAGIC) &&
+                (header.version     == RB_FILE_VERSION) &&
+                (header.size        == size) &&
+                (header.valueSize   == valueSize) &&
+                (header.layout      == (uint32_t) layout) &&
+                (header.checksum    == rb_file_checksum(&header));
+    }
+
+    if(!valid){
+        printf("[ringbuffer] History file %s is started again (%zu MB).\n", path, fileBytes >> 20);
+
+        // blocks are reserved, a full disk can't fail a write through the mapping later
+        error = (ftruncate(file->fd, fileBytes) != 0) ? errno : posix_fallocate(file->fd, 0, fileBytes);
+
+        if(error != 0){
+            printf("[ringbuffer][error] History file %s could not be allocated (%s).\n", path, strerror(error));
+            goto closeFile;
+        }
+    }
+
+    // PROT_NONE mappings are not populated by mlockall(MCL_FUTURE), they are unlocked before they become accessible
+    file->header            = mmap(NULL, pageSize, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    file->xyzBuffer         = rb_map_axes(file->fd, file->axesOffset, size, valueSize, layout, PROT_NONE);
+    file->timestampBuffer   = mmap(NULL, timestampBytes, PROT_NONE, MAP_SHARED, file->fd, file->timestampOffset);
+
+    if((file->header == MAP_FAILED) || (file->xyzBuffer == NULL) || (file->timestampBuffer == MAP_FAILED)){
+        printf("[ringbuffer][error] History file %s could not be mapped.\n", path);
+        goto unmapFile;
+    }
+
+    munlock(file->xyzBuffer, rb_multi_bytes(size, valueSize, layout));
+    munlock(file->timestampBuffer, timestampBytes);
+
+    mprotect(file->xyzBuffer, rb_multi_bytes(size, valueSize, layout), PROT_READ | PROT_WRITE);
+    mprotect(file->timestampBuffer, timestampBytes, PROT_READ | PROT_WRITE);
+
+    // samples are written strictly in order, pages behind the writer can be dropped early
+    madvise(file->xyzBuffer, rb_multi_bytes(size, valueSize, layout), MADV_SEQUENTIAL);
+    madvise(file->timestampBuffer, timestampBytes, MADV_SEQUENTIAL);
+
+    file->durable = valid ? header.index : 0;
+    file->written = file->durable;
+
+    if(!valid){
+        rb_file_write_header(file, 0);
+    }
+
+    return true;
+
+    // every part that was mapped is released again, the descriptor is not left to rb_file_close()
+unmapFile:
+    if(file->header != MAP_FAILED){
+        munmap(file->header, pageSize);
+    }
+
+    if(file->xyzBuffer != NULL){
+        munmap(file->xyzBuffer, rb_multi_bytes(size, valueSize, layout));
+    }
+
+    if(file->timestampBuffer != MAP_FAILED){
+        munmap(file->timestampBuffer, timestampBytes);
+    }
+
+    file->header            = NULL;
+    file->xyzBuffer         = NULL;
+    file->timestampBuffer   = NULL;
+
+closeFile:
+    if(file->fd >= 0){
+        close(file->fd);
+    }
+
+    file->fd = -1;
+
+    return false;
+}
+
+
+uint32_t rb_file_restore(rb_file_t *file, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs){
+
+    uint32_t    restored    = (file->durable < file->size) ? file->durable : file->size;
+    int64_t     shiftNs     = file->header->realtimeOffsetNs - rb_file_realtime_offset_ns();
+
+    rb->index   = file->durable;
+    rbTs->index = file->durable;
+
+    // within one boot the offset only moves by the jitter of reading two clocks or a step of CLOCK_REALTIME
+    if((restored == 0) || ((shiftNs < RB_FILE_REBOOT_NS) && (shiftNs > -RB_FILE_REBOOT_NS))){
+        return restored;
+    }
+
+    // CLOCK_MONOTONIC starts again with every boot, timestamps of the last run are moved onto this run's clock through CLOCK_REALTIME
+    for(uint32_t sample = file->durable - restored; sample != file->durable; sample++){
+        rbTs->buffer[sample & rbTs->modulo] += (uint64_t) shiftNs;
+    }
+
+    // moved timestamps first, header with the offset of this run last, same order as rb_file_sync()
+    rb_file_range(file, file->durable - restored, file->durable, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    rb_file_write_header(file, file->durable);
+
+    return restored;
+}
+
+
+void rb_file_sync(rb_file_t *file, ringbuffer_xyz_t *rb){
+
+    if(rb->index - file->written < RB_FILE_SYNC_SAMPLES){
+        return;
+    }
+
+    // samples started last time are on disk by now, unless the disk is slower than the sensor
+    rb_file_range(file, file->durable, file->written, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+
+    file->durable = file->written;
+    rb_file_write_header(file, file->durable);
+
+    rb_file_range(file, file->written, rb->index, SYNC_FILE_RANGE_WRITE);
+    file->written = rb->index;
+}
+
+
+void rb_file_close(rb_file_t *file, ringbuffer_xyz_t *rb){
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+
+    if(file->fd < 0){
+        return;
+    }
+
+    // samples first, header last, a crash in between still finds the last header valid
+    rb_file_range(file, file->durable, rb->index, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    fdatasync(file->fd);
+
+    rb_file_write_header(file, rb->index);
+    fdatasync(file->fd);
+
+    munmap(file->header, pageSize);
+    munmap(file->xyzBuffer, rb_multi_bytes(file->size, file->valueSize, file->layout));
+    munmap(file->timestampBuffer, ((size_t) file->size * sizeof(uint64_t) + pageSize - 1) / pageSize * pageSize);
+    close(file->fd);
+
+    file->fd = -1;
+}
+
+
+static uint32_t rb_file_checksum(const rb_file_header_t *header){
+
+    const uint8_t*  bytes   = (const uint8_t*) header;
+    uint32_t        hash    = 2166136261u;
+
+    for(size_t i = 0; i < offsetof(rb_file_header_t, checksum); i++){
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+static void rb_file_write_header(rb_file_t *file, uint32_t index){
+
+    file->header->magic             = RB_FILE_MAGIC;
+    file->header->version           = RB_FILE_VERSION;
+    file->header->size              = file->size;
+    file->header->valueSize         = file->valueSize;
+    file->header->layout            = file->layout;
+    file->header->index             = index;
+    file->header->reserved          = 0;
+    file->header->realtimeOffsetNs  = rb_file_realtime_offset_ns();
+    file->header->checksum          = rb_file_checksum(file->header);
+
+    sync_file_range(file->fd, 0, sizeof(rb_file_header_t), SYNC_FILE_RANGE_WRITE);
+}
+
+
+static int64_t rb_file_realtime_offset_ns(void){
+
+    struct timespec realtime;
+    struct timespec monotonic;
+
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+
+    return ((int64_t) realtime.tv_sec - monotonic.tv_sec) * 1000000000 + (realtime.tv_nsec - monotonic.tv_nsec);
+}
+
+
+static void rb_file_range(rb_file_t *file, uint32_t from, uint32_t to, unsigned int flags){
+
+    uint32_t    samples         = to - from;
+    uint32_t    localIndex      = 0;
+    uint32_t    piece           = 0;
+    uint32_t    blockSamples    = RB_CACHE_LINE / file->valueSize;
+    size_t      axisBytes       = (size_t) file->size * file->valueSize;
+    size_t      first           = 0;
+    size_t      last            = 0;
+
+    if(samples > file->size){
+        from    = to - file->size;
+        samples = file->size;
+    }
+
+    localIndex = from & (file->size - 1);
+
+    // samples wrapping around the end of the ringbuffer are two pieces in the file
+    while(samples > 0){
+        piece = file->size - localIndex;
+        if(piece > samples){
+            piece = samples;
+        }
+
+        if(file->layout == rb_layout_interleaved){
+            first   = (size_t) (localIndex / blockSamples) * NUMBER_OF_AXES * RB_CACHE_LINE;
+            last    = (size_t) ((localIndex + piece + blockSamples - 1) / blockSamples) * NUMBER_OF_AXES * RB_CACHE_LINE;
+            sync_file_range(file->fd, file->axesOffset + first, last - first, flags);
+        }
+        else{
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                sync_file_range(file->fd, file->axesOffset + axis * axisBytes + (size_t) localIndex * file->valueSize, (size_t) piece * file->valueSize, flags);
+            }
+        }
+
+        sync_file_range(file->fd, file->timestampOffset + (size_t) localIndex * sizeof(uint64_t), (size_t) piece * sizeof(uint64_t), flags);
+
+        samples    -= piece;
+        localIndex  = 0;
+    }
+}
+
+
+bool rb_pyramid_init(rb_pyramid_t *pyramid){
+
+    memset(pyramid, 0, sizeof(rb_pyramid_t));
+
+    for(uint8_t level = 0; level < RB_PYRAMID_LEVELS; level++){
+        pyramid->level[level].entries = aligned_alloc(RB_CACHE_LINE, RB_PYRAMID_ENTRIES * sizeof(rb_envelope_t));
+
+        if(pyramid->level[level].entries == NULL){
+            printf("[ringbuffer][error] Envelopes could not be allocated.\n");
+            rb_pyramid_free(pyramid);
+            return false;
+        }
+
+        rb_pyramid_reset(&pyramid->level[level]);
+    }
+
+    pthread_mutex_init(&pyramid->lock, NULL);
+
+    return true;
+}
+
+
+void rb_pyramid_free(rb_pyramid_t *pyramid){
+
+    for(uint8_t level = 0; level < RB_PYRAMID_LEVELS; level++){
+        free(pyramid->level[level].entries);
+        pyramid->level[level].entries = NULL;
+    }
+}
+
+
+void rb_pyramid_push(rb_pyramid_t *pyramid, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, uint32_t numberOfSamples){
+
+    rb_pyramid_level_t* first       = &pyramid->level[0];
+    uint32_t            index       = rb->index - numberOfSamples;
+    uint32_t            span        = 0;
+    uint32_t            piece       = 0;
+    void*               xyzSpan     [NUMBER_OF_AXES];
+
+    pthread_mutex_lock(&pyramid->lock);
+
+    while(numberOfSamples > 0){
+        span = rb_get_span(rb, index, numberOfSamples, xyzSpan);
+
+        // span is split where an envelope of the first level ends
+        for(uint32_t i = 0; i < span; i += piece){
+            piece = (1 << RB_PYRAMID_SHIFT) - first->count;
+            if(piece > span - i){
+                piece = span - i;
+            }
+
+            if(first->count == 0){
+                first->timestamp = rbTs->buffer[(index + i) & rbTs->modulo];
+            }
+
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                rb_pyramid_add(first, axis, (uint8_t*) xyzSpan[axis] + i * rb->valueSize, rb->valueSize, piece);
+            }
+
+            first->count += piece;
+
+            if(first->count == (1 << RB_PYRAMID_SHIFT)){
+                rb_pyramid_complete(pyramid, 0);
+            }
+        }
+
+        index           += span;
+        numberOfSamples -= span;
+    }
+
+    pthread_mutex_unlock(&pyramid->lock);
+}
+
+
+uint8_t rb_pyramid_level(uint64_t numberOfSamples){
+
+    for(uint8_t level = 0; level < RB_PYRAMID_LEVELS; level++){
+        if((numberOfSamples >> (RB_PYRAMID_SHIFT * (level + 1))) <= RB_PYRAMID_ENTRIES){
+            return level;
+        }
+    }
+
+    return RB_PYRAMID_LEVELS - 1;
+}
+
+
+uint32_t rb_pyramid_read(rb_pyramid_t *pyramid, uint8_t level, uint32_t numberOfEntries, rb_envelope_t *envelopes){
+
+    rb_pyramid_level_t* entries     = &pyramid->level[level];
+    uint32_t            first       = 0;
+    uint32_t            piece       = 0;
+
+    pthread_mutex_lock(&pyramid->lock);
+
+    if(numberOfEntries > RB_PYRAMID_ENTRIES){
+        numberOfEntries = RB_PYRAMID_ENTRIES;
+    }
+    if(numberOfEntries > entries->index){
+        numberOfEntries = entries->index;
+    }
+
+    // newest envelopes may wrap around the end of the ring
+    first = (entries->index - numberOfEntries) & (RB_PYRAMID_ENTRIES - 1);
+    piece = RB_PYRAMID_ENTRIES - first;
+    if(piece > numberOfEntries){
+        piece = numberOfEntries;
+    }
+
+    memcpy(envelopes, &entries->entries[first], piece * sizeof(rb_envelope_t));
+    memcpy(&envelopes[piece], entries->entries, (numberOfEntries - piece) * sizeof(rb_envelope_t));
+
+    pthread_mutex_unlock(&pyramid->lock);
+
+    return numberOfEntries;
+}
+
+
+static void rb_pyramid_reset(rb_pyramid_level_t *level){
+
+    level->count = 0;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        level->min[axis]        = INT16_MAX;
+        level->max[axis]        = INT16_MIN;
+        level->sum[axis]        = 0;
+        level->sumSquares[axis] = 0;
+    }
+}
+
+
+static inline void rb_pyramid_add(rb_pyramid_level_t *first, axis_t axis, const void *values, uint8_t valueSize, uint32_t numberOfValues){
+
+    int32_t     min         = first->min[axis];
+    int32_t     max         = first->max[axis];
+    int32_t     sum         = 0;
+    uint64_t    sumSquares  = 0;
+    int32_t     value       = 0;
+
+    // at most 16 values, sums stay in registers
+    if(valueSize == sizeof(int8_t)){
+        for(uint32_t i = 0; i < numberOfValues; i++){
+            value       = ((const int8_t*) values)[i];
+            min         = (value < min) ? value : min;
+            max         = (value > max) ? value : max;
+            sum        += value;
+            sumSquares += (uint64_t) (value * value);
+        }
+    }
+    else{
+        for(uint32_t i = 0; i < numberOfValues; i++){
+            value       = ((const int16_t*) values)[i];
+            min         = (value < min) ? value : min;
+            max         = (value > max) ? value : max;
+            sum        += value;
+            sumSquares += (uint64_t) (value * value);
+        }
+    }
+
+    first->min[axis]         = min;
+    first->max[axis]         = max;
+    first->sum[axis]        += sum;
+    first->sumSquares[axis] += sumSquares;
+}
+
+
+static void rb_pyramid_complete(rb_pyramid_t *pyramid, uint8_t level){
+
+    rb_pyramid_level_t* current     = &pyramid->level[level];
+    rb_envelope_t*      envelope    = &current->entries[current->index & (RB_PYRAMID_ENTRIES - 1)];
+    rb_pyramid_level_t* above       = NULL;
+    int64_t             samples     = (int64_t) 1 << (RB_PYRAMID_SHIFT * (level + 1));
+
+    envelope->timestamp = current->timestamp;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        envelope->min[axis]     = current->min[axis];
+        envelope->max[axis]     = current->max[axis];
+        envelope->mean[axis]    = (int16_t) (current->sum[axis] / samples);
+        envelope->rms[axis]     = (uint16_t) sqrt((double) current->sumSquares[axis] / samples);
+    }
+
+    current->index++;
+
+    // sums are passed on, mean and RMS of the level above are exact
+    if(level + 1 < RB_PYRAMID_LEVELS){
+        above = &pyramid->level[level + 1];
+
+        if(above->count == 0){
+            above->timestamp = current->timestamp;
+        }
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            above->min[axis]         = (current->min[axis] < above->min[axis]) ? current->min[axis] : above->min[axis];
+            above->max[axis]         = (current->max[axis] > above->max[axis]) ? current->max[axis] : above->max[axis];
+            above->sum[axis]        += current->sum[axis];
+            above->sumSquares[axis] += current->sumSquares[axis];
+        }
+
+        above->count++;
+
+        if(above->count == (1 << RB_PYRAMID_SHIFT)){
+            rb_pyramid_complete(pyramid, level + 1);
+        }
+    }
+
+    rb_pyramid_reset(current);
+}
+
+
+bool rb_pack_init(rb_pack_t *pack, uint32_t size, uint8_t valueSize, uint32_t firstSample){
+
+    memset(pack, 0, sizeof(rb_pack_t));
+
+    pack->size          = size;
+    pack->blockCount    = size / RB_PACK_BLOCK_BYTES;
+    pack->valueSize     = valueSize;
+    pack->firstSample   = (firstSample + RB_PACK_BLOCK_SAMPLES - 1) & ~(RB_PACK_BLOCK_SAMPLES - 1);
+
+    if((size < 2 * RB_PACK_MAX_BYTES) || ((size & (size - 1)) != 0)){
+        printf("[ringbuffer][error] Compressed ring of %u bytes is not a power of two of at least %u bytes.\n", size, 2 * RB_PACK_MAX_BYTES);
+        return false;
+    }
+
+    pack->buffer        = aligned_alloc(RB_CACHE_LINE, size);
+    pack->blockOffsets  = malloc(pack->blockCount * sizeof(uint32_t));
+
+    if((pack->buffer == NULL) || (pack->blockOffsets == NULL)){
+        printf("[ringbuffer][error] Compressed ring could not be allocated.\n");
+        rb_pack_free(pack);
+        return false;
+    }
+
+    atomic_init(&pack->viewsReleased, 0);
+
+    return true;
+}
+
+
+void rb_pack_free(rb_pack_t *pack){
+
+    free(pack->buffer);
+    free(pack->blockOffsets);
+
+    pack->buffer        = NULL;
+    pack->blockOffsets  = NULL;
+}
+
+
+bool rb_pack_push_free(rb_pack_t *pack, ringbuffer_xyz_t *rb){
+
+    uint32_t released   = atomic_load_explicit(&pack->viewsReleased, memory_order_acquire);
+    int32_t  pending    = (int32_t) (rb->index - pack->firstSample - (pack->blocksWritten << RB_PACK_BLOCK_SHIFT));
+    uint32_t blocks     = (pending > 0) ? (uint32_t) pending >> RB_PACK_BLOCK_SHIFT : 0;
+
+    // every block may need a whole block of padding at the end of the ring
+    for(uint32_t view = released; view != pack->viewsTaken; view++){
+        if((pack->blocksWritten + blocks - pack->viewBlock[view & (RB_MAX_VIEWS - 1)] > pack->blockCount) ||
+           (pack->head + blocks * 2 * (RB_PACK_MAX_BYTES + RB_PACK_SLACK_BYTES) - pack->viewHead[view & (RB_MAX_VIEWS - 1)] > pack->size)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+uint32_t rb_pack_push(rb_pack_t *pack, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs){
+
+    int32_t     xyz             [NUMBER_OF_AXES][RB_PACK_BLOCK_SAMPLES];
+    uint64_t    timestamps      [RB_PACK_BLOCK_SAMPLES];
+    void*       xyzSpan         [NUMBER_OF_AXES];
+    uint32_t    nextSample      = pack->firstSample + (pack->blocksWritten << RB_PACK_BLOCK_SHIFT);
+    uint32_t    blocks          = 0;
+    uint32_t    span            = 0;
+
+    // first block may not be complete yet, firstSample was rounded up
+    while((int32_t) (rb->index - nextSample) >= RB_PACK_BLOCK_SAMPLES){
+
+        // interleaved layout returns the block in spans of one cache line
+        for(uint32_t i = 0; i < RB_PACK_BLOCK_SAMPLES; i += span){
+            span = rb_get_span(rb, nextSample + i, RB_PACK_BLOCK_SAMPLES - i, xyzSpan);
+
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                for(uint32_t u = 0; u < span; u++){
+                    xyz[axis][i + u] = (rb->valueSize == sizeof(int8_t)) ? ((int8_t*) xyzSpan[axis])[u] : ((int16_t*) xyzSpan[axis])[u];
+                }
+            }
+        }
+
+        for(uint32_t i = 0; i < RB_PACK_BLOCK_SAMPLES; i++){
+            timestamps[i] = rbTs->buffer[(nextSample + i) & rbTs->modulo];
+        }
+
+        // a block is encoded in place, it starts over at the beginning of the ring if it might not fit before the end
+        if((pack->head & (pack->size - 1)) + RB_PACK_MAX_BYTES + RB_PACK_SLACK_BYTES > pack->size){
+            pack->head += pack->size - (pack->head & (pack->size - 1));
+        }
+
+        pack->blockOffsets[pack->blocksWritten & (pack->blockCount - 1)] = pack->head;
+        pack->head += rb_pack_encode(xyz, timestamps, &pack->buffer[pack->head & (pack->size - 1)]) + RB_PACK_SLACK_BYTES;
+        pack->blocksWritten++;
+
+        // blocks whose bytes or entry of the block table were overwritten are given up
+        while((pack->blocksWritten - pack->oldestBlock > pack->blockCount) ||
+              (pack->head - pack->blockOffsets[pack->oldestBlock & (pack->blockCount - 1)] > pack->size)){
+            pack->oldestBlock++;
+        }
+
+        nextSample += RB_PACK_BLOCK_SAMPLES;
+        blocks++;
+    }
+
+    return blocks;
+}
+
+
+bool rb_pack_take(rb_pack_t *pack, ringbuffer_xyz_t *rb, trigger_info_t *triggerInfo, rb_view_t *view, rb_pack_view_t *packView){
+
+    uint32_t released       = atomic_load_explicit(&pack->viewsReleased, memory_order_acquire);
+    uint32_t oldestSample   = pack->firstSample + (pack->oldestBlock << RB_PACK_BLOCK_SHIFT);
+    uint32_t nextSample     = pack->firstSample + (pack->blocksWritten << RB_PACK_BLOCK_SHIFT);
+    uint32_t firstSample    = 0;
+    uint32_t missing        = 0;
+    uint32_t packed         = 0;
+    uint32_t slot           = pack->viewsTaken & (RB_MAX_VIEWS - 1);
+
+    if((pack->viewsTaken - released == RB_MAX_VIEWS) ||
+       (rb->viewsTaken - atomic_load_explicit(&rb->viewsReleased, memory_order_acquire) == RB_MAX_VIEWS)){
+        return false;
+    }
+
+    // packing fell behind the ringbuffer, samples between both are gone and the ringbuffer holds the oldest one
+    if((int32_t) (rb->index - rb->size - nextSample) > 0){
+        oldestSample = rb->index - rb->size;
+    }
+
+    // trigger lies within the ringbuffer, the window may reach further back
+    firstSample = rb->index - ((rb->index - triggerInfo->triggerIndex) & rb->modulo) - triggerInfo->samplesBeforeTrig;
+
+    if((int32_t) (oldestSample - firstSample) > 0){
+        missing = oldestSample - firstSample;
+        missing = (missing > triggerInfo->numberOfSamples) ? triggerInfo->numberOfSamples : missing;
+
+        firstSample += missing;
+        rb_window_shorten(triggerInfo, missing);
+    }
+
+    if((int32_t) (nextSample - firstSample) > 0){
+        packed = nextSample - firstSample;
+        packed = (packed > triggerInfo->numberOfSamples) ? triggerInfo->numberOfSamples : packed;
+    }
+
+    packView->firstSample       = firstSample;
+    packView->numberOfSamples   = packed;
+
+    // an empty view only keeps the blocks written after it
+    pack->viewBlock[slot]   = (packed > 0) ? (firstSample - pack->firstSample) >> RB_PACK_BLOCK_SHIFT : pack->blocksWritten;
+    pack->viewHead[slot]    = (packed > 0) ? pack->blockOffsets[pack->viewBlock[slot] & (pack->blockCount - 1)] : pack->head;
+    pack->viewsTaken++;
+
+    // the rest starts at the oldest sample of the ringbuffer at most, so it always fits
+    rb_view_pin(rb, firstSample + packed, triggerInfo->numberOfSamples - packed, view);
+
+    return true;
+}
+
+
+void rb_pack_release(rb_pack_t *pack){
+
+    uint32_t released = atomic_load_explicit(&pack->viewsReleased, memory_order_relaxed);
+
+    // all reads of the view happen before the writer sees it released
+    atomic_store_explicit(&pack->viewsReleased, released + 1, memory_order_release);
+}
+
+
+uint32_t rb_pack_read(rb_pack_t *pack, rb_pack_view_t *packView, uint32_t offset, uint32_t numberOfSamples, void **xyz, uint64_t *timestamps){
+
+    int16_t     xyzBlock        [NUMBER_OF_AXES][RB_PACK_BLOCK_SAMPLES];
+    uint64_t    timestampBlock  [RB_PACK_BLOCK_SAMPLES];
+    void*       xyzDecoded      [NUMBER_OF_AXES];
+    uint64_t*   timestampDecoded;
+    uint32_t    sample          = packView->firstSample + offset - pack->firstSample;
+    uint32_t    inBlock         = 0;
+    uint32_t    piece           = 0;
+    uint32_t    done            = 0;
+    const uint8_t* block        = NULL;
+
+    if(offset >= packView->numberOfSamples){
+        return 0;
+    }
+    if(numberOfSamples > packView->numberOfSamples - offset){
+        numberOfSamples = packView->numberOfSamples - offset;
+    }
+
+    while(done < numberOfSamples){
+        block   = &pack->buffer[pack->blockOffsets[(sample >> RB_PACK_BLOCK_SHIFT) & (pack->blockCount - 1)] & (pack->size - 1)];
+        inBlock = sample & (RB_PACK_BLOCK_SAMPLES - 1);
+        piece   = RB_PACK_BLOCK_SAMPLES - inBlock;
+        if(piece > numberOfSamples - done){
+            piece = numberOfSamples - done;
+        }
+
+        // whole blocks are decoded in place, parts of a block are copied out of a decoded one
+        if(piece == RB_PACK_BLOCK_SAMPLES){
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                xyzDecoded[axis] = (uint8_t*) xyz[axis] + done * pack->valueSize;
+            }
+            timestampDecoded = &timestamps[done];
+        }
+        else{
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                xyzDecoded[axis] = xyzBlock[axis];
+            }
+            timestampDecoded = timestampBlock;
+        }
+
+        rb_pack_decode(block, pack->valueSize, xyzDecoded, timestampDecoded);
+
+        if(piece < RB_PACK_BLOCK_SAMPLES){
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                memcpy((uint8_t*) xyz[axis] + done * pack->valueSize, (uint8_t*) xyzBlock[axis] + inBlock * pack->valueSize, piece * pack->valueSize);
+            }
+            memcpy(&timestamps[done], &timestampBlock[inBlock], piece * sizeof(uint64_t));
+        }
+
+        done   += piece;
+        sample += piece;
+    }
+
+    return numberOfSamples;
+}
+
+
+static uint32_t rb_pack_encode(int32_t (*xyz)[RB_PACK_BLOCK_SAMPLES], const uint64_t *timestamps, uint8_t *out){
+
+    uint64_t    residuals   [RB_PACK_BLOCK_SAMPLES - 1];
+    uint64_t    widthMask   = 0;
+    uint8_t*    position    = out;
+    int16_t     first       = 0;
+    uint32_t    period      = 0;
+    int64_t     residual    = 0;
+
+    // first value | width | zig-zag deltas of every axis, the width is that of the largest delta
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        widthMask = 0;
+
+        for(uint32_t i = 1; i < RB_PACK_BLOCK_SAMPLES; i++){
+            residual         = xyz[axis][i] - xyz[axis][i - 1];
+            residuals[i - 1] = ((uint64_t) residual << 1) ^ (uint64_t) (residual >> 63);
+            widthMask       |= residuals[i - 1];
+        }
+
+        first = (int16_t) xyz[axis][0];
+        memcpy(position, &first, sizeof(int16_t));
+        position   += sizeof(int16_t);
+        *position   = (widthMask == 0) ? 0 : 64 - __builtin_clzll(widthMask);
+        position    = rb_pack_bits(position + 1, residuals, RB_PACK_BLOCK_SAMPLES - 1, *position);
+    }
+
+    // first timestamp | period | width | zig-zag deviations from first + i * period, the estimator keeps them small
+    // a clock stepped back leaves no period, the deviations alone still give every timestamp back
+    period      = (timestamps[RB_PACK_BLOCK_SAMPLES - 1] < timestamps[0]) ? 0 :
+                  (uint32_t) ((timestamps[RB_PACK_BLOCK_SAMPLES - 1] - timestamps[0]) / (RB_PACK_BLOCK_SAMPLES - 1));
+    widthMask   = 0;
+
+    for(uint32_t i = 1; i < RB_PACK_BLOCK_SAMPLES; i++){
+        residual         = (int64_t) (timestamps[i] - timestamps[0] - (uint64_t) i * period);
+        residuals[i - 1] = ((uint64_t) residual << 1) ^ (uint64_t) (residual >> 63);
+        widthMask       |= residuals[i - 1];
+    }
+
+    memcpy(position, &timestamps[0], sizeof(uint64_t));
+    position   += sizeof(uint64_t);
+    memcpy(position, &period, sizeof(uint32_t));
+    position   += sizeof(uint32_t);
+    *position   = (widthMask == 0) ? 0 : 64 - __builtin_clzll(widthMask);
+    position    = rb_pack_bits(position + 1, residuals, RB_PACK_BLOCK_SAMPLES - 1, *position);
+
+    return position - out;
+}
+
+
+static void rb_pack_decode(const uint8_t *in, uint8_t valueSize, void **xyz, uint64_t *timestamps){
+
+    uint64_t    residuals   [RB_PACK_BLOCK_SAMPLES - 1];
+    int16_t     first       = 0;
+    int32_t     value       = 0;
+    uint64_t    start       = 0;
+    uint32_t    period      = 0;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        memcpy(&first, in, sizeof(int16_t));
+        in = rb_unpack_bits(in + sizeof(int16_t) + 1, residuals, RB_PACK_BLOCK_SAMPLES - 1, in[sizeof(int16_t)]);
+
+        value = first;
+
+        if(valueSize == sizeof(int8_t)){
+            ((int8_t*) xyz[axis])[0] = (int8_t) value;
+            for(uint32_t i = 1; i < RB_PACK_BLOCK_SAMPLES; i++){
+                value += (int32_t) (residuals[i - 1] >> 1) ^ -(int32_t) (residuals[i - 1] & 1);
+                ((int8_t*) xyz[axis])[i] = (int8_t) value;
+            }
+        }
+        else{
+            ((int16_t*) xyz[axis])[0] = (int16_t) value;
+            for(uint32_t i = 1; i < RB_PACK_BLOCK_SAMPLES; i++){
+                value += (int32_t) (residuals[i - 1] >> 1) ^ -(int32_t) (residuals[i - 1] & 1);
+                ((int16_t*) xyz[axis])[i] = (int16_t) value;
+            }
+        }
+    }
+
+    memcpy(&start, in, sizeof(uint64_t));
+    memcpy(&period, in + sizeof(uint64_t), sizeof(uint32_t));
+    rb_unpack_bits(in + sizeof(uint64_t) + sizeof(uint32_t) + 1, residuals, RB_PACK_BLOCK_SAMPLES - 1, in[sizeof(uint64_t) + sizeof(uint32_t)]);
+
+    timestamps[0] = start;
+    for(uint32_t i = 1; i < RB_PACK_BLOCK_SAMPLES; i++){
+        timestamps[i] = start + (uint64_t) i * period + (uint64_t) ((int64_t) (residuals[i - 1] >> 1) ^ -(int64_t) (residuals[i - 1] & 1));
+    }
+}
+
+
+static uint8_t *rb_pack_bits(uint8_t *out, const uint64_t *values, uint32_t numberOfValues, uint8_t width){
+
+    uint64_t    bits        = 0;
+    uint32_t    pending     = 0;
+    uint8_t     low         = (width > 32) ? 32 : width;
+    uint64_t    lowMask     = ((uint64_t) 1 << low) - 1;
+
+    // values wider than 32 Bit are written as two parts, so at most 63 Bit are pending
+    for(uint32_t i = 0; i < numberOfValues; i++){
+        bits    |= (values[i] & lowMask) << pending;
+        pending += low;
+
+        if(pending >= 32){
+            memcpy(out, &bits, sizeof(uint32_t));
+            out     += sizeof(uint32_t);
+            bits   >>= 32;
+            pending -= 32;
+        }
+
+        if(width > 32){
+            bits    |= (values[i] >> 32) << pending;
+            pending += width - 32;
+
+            if(pending >= 32){
+                memcpy(out, &bits, sizeof(uint32_t));
+                out     += sizeof(uint32_t);
+                bits   >>= 32;
+                pending -= 32;
+            }
+        }
+    }
+
+    for(; pending > 0; pending = (pending > 8) ? pending - 8 : 0){
+        *out++   = (uint8_t) bits;
+        bits   >>= 8;
+    }
+
+    return out;
+}
+
+
+static const uint8_t *rb_unpack_bits(const uint8_t *in, uint64_t *values, uint32_t numberOfValues, uint8_t width){
+
+    uint64_t    word        = 0;
+    uint64_t    position    = 0;
+    uint8_t     low         = (width > 32) ? 32 : width;
+    uint64_t    lowMask     = ((uint64_t) 1 << low) - 1;
+    uint64_t    highMask    = ((uint64_t) 1 << (width - low)) - 1;
+
+    // every value is taken from the 8 bytes starting at its first byte
+    for(uint32_t i = 0; i < numberOfValues; i++){
+        memcpy(&word, &in[position >> 3], sizeof(uint64_t));
+        values[i]   = (word >> (position & 7)) & lowMask;
+        position   += low;
+
+        if(width > 32){
+            memcpy(&word, &in[position >> 3], sizeof(uint64_t));
+            values[i]  |= ((word >> (position & 7)) & highMask) << 32;
+            position   += width - low;
+        }
+    }
+
+    return &in[(position + 7) >> 3];
+}
+
+
+bool rb_ts_init(ringbuffer_ts_t *rb, uint64_t *buffer, uint32_t size){
+
+    rb->buffer  = buffer;
+    rb->size    = size;
+    rb->modulo  = rb->size - 1;
+    rb->index   = 0;
+
+    if((rb->size & (rb->size - 1)) != 0) {
+        printf("[ringbuffer][error] size of ringbuffer is not power of two\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+uint32_t rb_ts_push(ringbuffer_ts_t *rb, uint64_t timestamp){
+
+    uint32_t localIndex     = rb->index & rb->modulo;
+    rb->buffer[localIndex]  = timestamp;
+
+    rb->index++;
+
+    return localIndex;
+}
+
+
+uint32_t rb_ts_push_block(ringbuffer_ts_t *rb, const uint64_t *timestamps, uint32_t numberOfSamples){
+
+    uint32_t firstIndex     = rb->index & rb->modulo;
+    uint32_t firstSpan      = rb->size - firstIndex;
+
+    if(firstSpan > numberOfSamples){
+        firstSpan = numberOfSamples;
+    }
+
+    memcpy(&rb->buffer[firstIndex], timestamps, firstSpan * sizeof(uint64_t));
+    memcpy(rb->buffer, &timestamps[firstSpan], (numberOfSamples - firstSpan) * sizeof(uint64_t));
+
+    rb->index += numberOfSamples;
+
+    return firstIndex;
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+/**
+ * @file rt_thread.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Contains functions for running the acquisition thread in real-time.
+ * 
+ *  At 25.6 kHz the reading loop has 39 us per sample, a single page fault or a preemption
+ *  by the runtime-config thread is enough to lose samples. The acquisition thread can be
+ *  created with SCHED_FIFO and pinned to an (isolated) CPU, memory can be locked and buffers
+ *  prefaulted. The loop period is measured, so the effect of a setting can be proven.
+ * 
+ */
+
+#define _GNU_SOURCE     ///< needed for pthread_attr_setaffinity_np() and CPU_SET
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+///\endcond
+
+#include <rt_thread.h>
+
+
+#define RT_ISOLATED_CPUS_PATH   "/sys/devices/system/cpu/isolated"
+#define RT_CPU_LIST_LEN         64
+
+#define NSEC_PER_SEC            1000000000
+#define NSEC_PER_USEC           1000
+
+
+//-------------------------------------------------------------------
+//--- Static Function Declarations  ---------------------------------
+//-------------------------------------------------------------------
+
+/**
+ * @brief Checks if CPU is listed in /sys/devices/system/cpu/isolated (isolcpus=).
+ * 
+ * @param cpu           CPU number
+ * @return true         if CPU is isolated
+ * @return false        if CPU is not isolated or list could not be read
+ */
+static bool rt_cpu_isolated(int16_t cpu);
+
+
+/**
+ * @brief Returns the loop period below which the given percentage of periods lies.
+ * 
+ * @param jitter        pointer to loop period statistics
+ * @param percent       percentile (e.g. 99.9)
+ * @return uint32_t     loop period in us
+ */
+static uint32_t rt_jitter_percentile(rt_jitter_t *jitter, double percent);
+
+
+//-------------------------------------------------------------------
+//--- Function Definitions  -----------------------------------------
+//-------------------------------------------------------------------
+
+rt_thread_result_t rt_thread_create(pthread_t *thread, rt_config_t *rtConfig, void *(*routine)(void*), void *arg){
+
+    pthread_attr_t      attr;
+    struct sched_param  schedParam;
+    cpu_set_t           cpuSet;
+    int                 ret = 0;
+
+    if((rtConfig->priority == RT_PRIORITY_OFF) && (rtConfig->cpu == RT_CPU_ANY)){
+        ret = pthread_create(thread, NULL, routine, arg);
+
+        if(ret != 0){
+            printf("[rt][error] Could not create thread (%s).\n", strerror(ret));
+            return rt_thread_failed;
+        }
+        return rt_thread_configured;
+    }
+
+    pthread_attr_init(&attr);
+
+    if(rtConfig->priority != RT_PRIORITY_OFF){
+        memset(&schedParam, 0, sizeof(schedParam));
+        schedParam.sched_priority = rtConfig->priority;
+
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &schedParam);
+    }
+
+    if(rtConfig->cpu != RT_CPU_ANY){
+        CPU_ZERO(&cpuSet);
+        CPU_SET(rtConfig->cpu, &cpuSet);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpuSet), &cpuSet);
+
+        if(!rt_cpu_isolated(rtConfig->cpu)){
+            printf("[rt] CPU %d is not isolated, other tasks may still run on it (isolcpus=%d).\n", rtConfig->cpu, rtConfig->cpu);
+        }
+    }
+
+    ret = pthread_create(thread, &attr, routine, arg);
+    pthread_attr_destroy(&attr);
+
+    if(ret != 0){
+        // e.g. EPERM without CAP_SYS_NICE / RLIMIT_RTPRIO, keep running without real-time
+        printf("[rt][error] Could not create real-time thread (%s), using default scheduling.\n", strerror(ret));
+        ret = pthread_create(thread, NULL, routine, arg);
+
+        if(ret != 0){
+            printf("[rt][error] Could not create thread (%s).\n", strerror(ret));
+            return rt_thread_failed;
+        }
+        return rt_thread_fallback;
+    }
+
+    printf("[rt] Acquisition thread: SCHED_%s priority %d, CPU %d.\n",
+            (rtConfig->priority != RT_PRIORITY_OFF) ? "FIFO" : "OTHER",
+            rtConfig->priority,
+            rtConfig->cpu);
+
+    return rt_thread_configured;
+}
+
+
+bool rt_lock_memory(void){
+
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0){
+        printf("[rt][error] mlockall failed (%s).\n", strerror(errno));
+        return false;
+    }
+
+    printf("[rt] Memory locked.\n");
+    return true;
+}
+
+
+void rt_prefault(void *buffer, size_t len){
+
+    long            pageSize    = sysconf(_SC_PAGESIZE);
+    volatile char*  bytes       = (volatile char*) buffer;
+
+    if((buffer == NULL) || (pageSize <= 0)){
+        return;
+    }
+
+    // writing makes the kernel back the page with RAM, reading would only map the zero page
+    for(size_t offset = 0; offset < len; offset += pageSize){
+        bytes[offset] = bytes[offset];
+    }
+
+    if(len > 0){
+        bytes[len - 1] = bytes[len - 1];
+    }
+}
+
+
+void rt_jitter_reset(rt_jitter_t *jitter){
+
+    struct rusage usage;
+
+    memset(jitter, 0, sizeof(*jitter));
+    jitter->minNs = UINT64_MAX;
+
+    if(getrusage(RUSAGE_SELF, &usage) == 0){
+        jitter->minorFaults = usage.ru_minflt;
+        jitter->majorFaults = usage.ru_majflt;
+    }
+}
+
+
+void rt_jitter_record(rt_jitter_t *jitter){
+
+    struct timespec now;
+    uint64_t        periodNs    = 0;
+    uint64_t        periodUs    = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if(jitter->running){
+        periodNs = (uint64_t) (now.tv_sec - jitter->lastLoop.tv_sec) * NSEC_PER_SEC + now.tv_nsec - jitter->lastLoop.tv_nsec;
+        periodUs = periodNs / NSEC_PER_USEC;
+
+        jitter->count++;
+        jitter->sumNs += periodNs;
+
+        if(periodNs < jitter->minNs){
+            jitter->minNs = periodNs;
+        }
+        if(periodNs > jitter->maxNs){
+            jitter->maxNs = periodNs;
+        }
+
+        jitter->histogram[(periodUs < RT_JITTER_HIST_US) ? periodUs : RT_JITTER_HIST_US]++;
+    }
+
+    jitter->lastLoop = now;
+    jitter->running  = true;
+}
+
+
+void rt_jitter_pause(rt_jitter_t *jitter){
+    jitter->running = false;
+}
+
+
+void rt_jitter_print(rt_jitter_t *jitter){
+
+    struct rusage usage;
+
+    if(jitter->count == 0){
+        printf("[rt] No loop periods recorded.\n");
+        return;
+    }
+
+    printf("[rt] Loop period: %llu loops, min %.1f us, mean %.1f us, max %.1f us\n",
+            (unsigned long long) jitter->count,
+            jitter->minNs / 1000.0,
+            (double) jitter->sumNs / jitter->count / 1000.0,
+            jitter->maxNs / 1000.0);
+
+    printf("[rt]              p50 %u us, p99 %u us, p99.9 %u us, p99.99 %u us, > %u us: %u\n",
+            rt_jitter_percentile(jitter, 50.0),
+            rt_jitter_percentile(jitter, 99.0),
+            rt_jitter_percentile(jitter, 99.9),
+            rt_jitter_percentile(jitter, 99.99),
+            RT_JITTER_HIST_US,
+            jitter->histogram[RT_JITTER_HIST_US]);
+
+    if(getrusage(RUSAGE_SELF, &usage) == 0){
+        printf("[rt] Page faults since start of loop: %ld minor, %ld major\n",
+                usage.ru_minflt - jitter->minorFaults,
+                usage.ru_majflt - jitter->majorFaults);
+    }
+}
+
+
+static uint32_t rt_jitter_percentile(rt_jitter_t *jitter, double percent){
+
+    uint64_t    target  = (uint64_t) (jitter->count * percent / 100.0);
+    uint64_t    sum     = 0;
+
+    for(uint32_t us = 0; us <= RT_JITTER_HIST_US; us++){
+        sum += jitter->histogram[us];
+        if(sum > target){
+            return us;
+        }
+    }
+
+    return RT_JITTER_HIST_US;
+}
+
+
+static bool rt_cpu_isolated(int16_t cpu){
+
+    char    cpuList [RT_CPU_LIST_LEN];
+    int     first   = 0;
+    int     last    = 0;
+
+    FILE* file = fopen(RT_ISOLATED_CPUS_PATH, "r");
+    if(file == NULL){
+        return false;
+    }
+
+    if(fgets(cpuList, sizeof(cpuList), file) == NULL){
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    // list format: "2-3,5"
+    char *strPtr = strtok(cpuList, ",\n");
+    while(strPtr != NULL){
+        int count = sscanf(strPtr, "%d-%d", &first, &last);
+        if(count == 1){
+            last = first;
+        }
+        if((count >= 1) && (cpu >= first) && (cpu <= last)){
+            return true;
+        }
+        strPtr = strtok(NULL, ",\n");
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,921 @@
+/**
+ * @file sim_kx132.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Simulated KX132-Accelerometer.
+ * 
+ *  Holds the register map of the KX132 and produces samples at the configured output data rate,
+ *  so the whole program can run without sensor (-spi sim).
+ *  Every sample on the ODR-grid is produced in order: the newest one is visible in XOUT..ZOUT,
+ *  all of them go to the sample buffer (FIFO / stream mode) and raise DRDY / WMI / BFI.
+ *  INT1 is modelled as well (sim_kx132_int1_source), latched or pulsed as set in INC1.
+ *  The time of the sensor can run faster than real time (timeScale), for load-tests.
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+///\endcond
+
+#include <sim_kx132.h>
+#include <regs_kx132.h>
+#include <config_kx132.h>
+#include <macros_kx132.h>
+
+
+#define SIM_WHO_AM_I                0x3D
+#define SIM_COTR                    0x55
+
+#define SIM_CNTL1_PC1               0x80    ///< operating mode
+#define SIM_CNTL1_GSEL_MASK         0x18
+#define SIM_CNTL2_SRST              0x80    ///< software reset
+#define SIM_ODCNTL_OSA_MASK         0x0F
+#define SIM_INS2_BFI                0x40    ///< buffer full
+#define SIM_INS2_WMI                0x20    ///< watermark reached
+#define SIM_INS2_DRDY               0x10    ///< data ready
+#define SIM_INS2_WUFS               0x02    ///< wake-up
+#define SIM_INS3_WUFS               0x80    ///< wake-up
+#define SIM_INS3_BTS                0x40    ///< back-to-sleep
+#define SIM_STATUS_REG_WAKE         0x01    ///< wake state
+#define SIM_CNTL3_OWUF_MASK         0x07
+#define SIM_CNTL4_TH_MODE           0x40    ///< thresholds relative to last sample of engine
+#define SIM_CNTL4_WUF_EN            0x20
+#define SIM_CNTL4_BTS_EN            0x10
+#define SIM_BTSWUFTH_WUFTH_H_MASK   0x70
+#define SIM_BTSWUFTH_BTSTH_H_MASK   0x07
+#define SIM_WAKE_ODR_MIN_HZ         0.78125 ///< OWUF = 0, every step doubles the rate
+#define SIM_WAKE_MG_PER_COUNT       3.9
+#define SIM_INC1_IEN1               0x20    ///< INT1 enabled
+#define SIM_INC1_IEL1               0x08    ///< INT1 pulsed instead of latched
+#define SIM_BUF_CNTL2_BUFE          0x80    ///< sample buffer enabled
+#define SIM_BUF_CNTL2_BRES          0x40    ///< 16-Bit samples in buffer
+#define SIM_BUF_CNTL2_BM_MASK       0x03
+#define SIM_BUF_MODE_FIFO           0x00    ///< buffer stops accepting samples when full
+#define SIM_BUF_MODE_STREAM         0x01    ///< buffer discards oldest sample when full
+#define SIM_BUF_MODE_TRIGGER        0x02    ///< stream until trigger event, then SMP_TH samples are kept and filled until full
+#define SIM_BUF_STATUS2_LEV_H_MASK  0x03
+#define SIM_BUF_STATUS2_BUF_TRIG    0x80    ///< trigger event occurred
+#define SIM_ADP_CNTL1_OADP_MASK     0x0F
+#define SIM_ADP_CNTL1_RMS_AVC_MASK  0x70
+#define SIM_ADP_CNTL2_ADP_EN        0x80
+#define SIM_ADP_CNTL2_FLT2_BYP      0x10
+#define SIM_ADP_CNTL2_FLT1_BYP      0x08
+#define SIM_ADP_CNTL2_RMS_OSEL      0x02
+#define SIM_ADP_CNTL2_BUF_SEL       0x01
+#define SIM_ADP_LOW_PASS_WEIGHT     0.25        ///< simulated filter-1, coefficients are not evaluated
+#define SIM_ADP_HIGH_PASS_WEIGHT    (1.0 / 256) ///< simulated filter-2, removes gravity
+
+#define SIM_BUF_SAMPLES_16BIT       86
+#define SIM_SAMPLE_BYTES_16BIT      6
+#define SIM_SAMPLE_BYTES_8BIT       3
+
+#define SIM_COUNTS_PER_G_2G         16384   ///< 16-Bit counts for 1 g at +-2 g
+#define SIM_IMPULSE_DECAY_PERIODS   10.0    ///< impulse decays to 1 % within this many periods
+#define SIM_WAVEFORM_LINE_LEN       128
+#define SIM_WAVEFORM_MAX_COLUMNS    5       ///< index, t, x, y, z
+
+#define NSEC_PER_SEC                1000000000
+#define NSEC_PER_USEC               1000
+
+
+static const char           simManId[]          = "Kion";
+static const double         simAxisWeight       [NUMBER_OF_AXES] = {1.0, 0.5, 0.25};   ///< direction of excitation
+static const double         simAxisPhase        [NUMBER_OF_AXES] = {0.0, 2.0 * M_PI / 3.0, 4.0 * M_PI / 3.0};
+static uint32_t             simInstances        = 0;            ///< seeds the noise of every simulated KX132 differently
+
+
+//-------------------------------------------------------------------
+//--- Static Function Declarations  ---------------------------------
+//-------------------------------------------------------------------
+
+/**
+ * @brief Sets all registers to their power-on values and empties the sample buffer.
+ * 
+ */
+static void sim_kx132_reset(sim_kx132_t *sim);
+
+
+/**
+ * @brief Produces all samples which became due since the last call.
+ * 
+ */
+static void sim_kx132_update(sim_kx132_t *sim);
+
+
+/**
+ * @brief Calculates the next sample, writes it to the output registers and the sample buffer
+ *        and raises the interrupts.
+ * 
+ */
+static void sim_kx132_produce_sample(sim_kx132_t *sim);
+
+
+/**
+ * @brief Runs a sample through the simulated Advanced Data Path and updates the XADP registers at OADP.
+ * 
+ *  Filter-1 is a fixed low-pass and filter-2 a fixed high-pass, the coefficient registers are ignored.
+ * 
+ * @param xyzValue          raw sample
+ * @param adpValue          pointer to array where ADP output should be saved
+ * @return true             if a new ADP output was produced
+ * @return false            if the sample was decimated
+ */
+static bool sim_kx132_adp(sim_kx132_t *sim, int16_t* xyzValue, int16_t* adpValue);
+
+
+/**
+ * @brief Runs a sample through the simulated wake-up / back-to-sleep engine at OWUF.
+ * 
+ *  Direction mask INC2 and the pulse count mode are ignored, every axis counts.
+ * 
+ * @param xyzValue          raw sample
+ * @param countsPerG        counts of raw sample for 1 g at the current range
+ */
+static void sim_kx132_wake_engine(sim_kx132_t *sim, int16_t* xyzValue, double countsPerG);
+
+
+/**
+ * @brief Calculates the signal of one axis at the given sensor time.
+ * 
+ * @param axis              axis
+ * @param time              sensor time in seconds
+ * @return double           acceleration in g, without gravity and background noise
+ */
+static double sim_kx132_signal(sim_kx132_t *sim, axis_t axis, double time);
+
+
+/**
+ * @brief Returns a uniform random number in [-1, 1] (xorshift32, cheap enough to run at 25.6 kHz).
+ * 
+ */
+static double sim_kx132_random(sim_kx132_t *sim);
+
+
+/**
+ * @brief Pushes one sample to the sample buffer, according to buffer mode.
+ * 
+ * @param xyzValue          pointer to the values of all three axes
+ */
+static void sim_kx132_buffer_push(sim_kx132_t *sim, int16_t* xyzValue);
+
+
+/**
+ * @brief Freezes the history of the sample buffer in trigger mode, only SMP_TH samples before the event are kept.
+ * 
+ *  Triggered by wake-up, the TRIG-PIN is not simulated.
+ * 
+ */
+static void sim_kx132_buffer_trigger(sim_kx132_t *sim);
+
+
+/**
+ * @brief Returns the next byte of the oldest sample in the sample buffer and removes the sample
+ *        when all of its bytes were read.
+ * 
+ */
+static uint8_t sim_kx132_buffer_pop_byte(sim_kx132_t *sim);
+
+
+/**
+ * @brief Writes sample level in bytes to BUF_STATUS1/2 and sets WMI / BFI in INS2.
+ * 
+ */
+static void sim_kx132_buffer_status(sim_kx132_t *sim);
+
+
+/**
+ * @brief Raises INT1 for the given interrupt sources, if they are routed to INT1.
+ * 
+ * @param events            INS2-Bits of the interrupts which occurred
+ */
+static void sim_kx132_raise_int1(sim_kx132_t *sim, uint8_t events);
+
+
+/**
+ * @brief Loads the recorded waveform from file.
+ * 
+ * @param path              path of text file
+ * @return true             if at least one sample was loaded
+ * @return false            if error
+ */
+static bool sim_kx132_load_waveform(sim_kx132_t *sim, const char* path);
+
+
+/**
+ * @brief Calculates the absolute time of a sample on the ODR-grid.
+ * 
+ * @param sampleNumber      number of sample since sim->startTime
+ * @param sampleTime        pointer to timespec where time is saved
+ */
+static void sim_kx132_sample_time(sim_kx132_t *sim, uint64_t sampleNumber, struct timespec* sampleTime);
+
+
+static bool     sim_int1_init       (gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs);
+static int32_t  sim_int1_wait       (gpio_event_t *event, uint32_t timeoutUs);
+static void     sim_int1_deinit     (gpio_event_t *event);
+
+
+const gpio_event_source_t sim_kx132_int1_source = {
+    .init   = sim_int1_init,
+    .wait   = sim_int1_wait,
+    .deinit = sim_int1_deinit,
+};
+
+
+//-------------------------------------------------------------------
+//--- Function Definitions  -----------------------------------------
+//-------------------------------------------------------------------
+
+bool sim_kx132_configure(sim_kx132_t *sim, sim_kx132_config_t *newConfig){
+
+    sim->config = *newConfig;
+
+    if(sim->config.timeScale <= 0){
+        sim->config.timeScale = DEFAULT_SIM_TIME_SCALE;
+    }
+
+    if(sim->config.signal == sim_signal_file){
+        return sim_kx132_load_waveform(sim, sim->config.waveformPath);
+    }
+
+    return true;
+}
+
+
+bool sim_kx132_init(sim_kx132_t *sim){
+    sim_kx132_reset(sim);
+    sim->signalTime   = 0;
+    sim->signalSample = 0;
+    sim->noiseState   = 1 + 0x9E3779B9u * simInstances++;   // xorshift must not start at 0
+
+    printf("[sim_kx132] Simulated KX132 powered up (signal %d, time scale %.2f).\n", sim->config.signal, sim->config.timeScale);
+    return true;
+}
+
+
+void sim_kx132_deinit(sim_kx132_t *sim){
+    sim->regs[CNTL1_REG_ADDR] = 0;
+
+    free(sim->waveform);
+    sim->waveform         = NULL;
+    sim->waveformLength   = 0;
+}
+
+
+void sim_kx132_begin_transfer(sim_kx132_t *sim){
+    sim_kx132_update(sim);
+}
+
+
+uint8_t sim_kx132_read(sim_kx132_t *sim, kx132_reg_t reg){
+
+    uint8_t value = 0;
+
+    value = sim->regs[reg & (SIM_NUMBER_OF_REGS - 1)];
+
+    switch (reg)
+    {
+        case MAN_ID_REG_ADDR:
+            value           = simManId[sim->manIdIndex];
+            sim->manIdIndex   = (sim->manIdIndex + 1) % (sizeof(simManId) - 1);
+            break;
+
+        // reading output data releases Data-Ready
+        case ZOUT_H_REG_ADDR:
+            sim->regs[INS2_REG_ADDR] &= ~SIM_INS2_DRDY;
+            break;
+
+        // reading INT_REL releases Data-Ready, wake-up / back-to-sleep and latched INT1, WMI / BFI stay while the buffer is filled
+        case INT_REL_REG_ADDR:
+            sim->regs[INS2_REG_ADDR] &= ~(SIM_INS2_DRDY | SIM_INS2_WUFS);
+            sim->regs[INS3_REG_ADDR]  = 0;
+            sim->int1Latched          = false;
+            break;
+
+        case BUF_READ_REG_ADDR:
+            value = sim_kx132_buffer_pop_byte(sim);
+            break;
+
+        default:
+            break;
+    }
+
+    return value;
+}
+
+
+void sim_kx132_write(sim_kx132_t *sim, kx132_reg_t reg, uint8_t data){
+
+    switch (reg)
+    {
+        case CNTL1_REG_ADDR:
+            // sample clock starts when entering operating mode
+            if(!(sim->regs[CNTL1_REG_ADDR] & SIM_CNTL1_PC1) && (data & SIM_CNTL1_PC1)){
+                clock_gettime(CLOCK_MONOTONIC, &sim->startTime);
+                sim->samplesProduced = 0;
+
+                // filters of ADP start settling again
+                memset(sim->adpLowPass,     0, sizeof(sim->adpLowPass));
+                memset(sim->adpMean,        0, sizeof(sim->adpMean));
+                memset(sim->adpMeanSquare,  0, sizeof(sim->adpMeanSquare));
+                sim->adpDecimation = 0;
+
+                // wake-up engine starts asleep
+                sim->regs[STATUS_REG_REG_ADDR] &= ~SIM_STATUS_REG_WAKE;
+                sim->wakeReferenceValid = false;
+                sim->wakeDecimation     = 0;
+                sim->wakeCounter        = 0;
+            }
+            sim->regs[CNTL1_REG_ADDR] = data;
+            break;
+
+        case CNTL2_REG_ADDR:
+            if(data & SIM_CNTL2_SRST){
+                sim_kx132_reset(sim);
+                return;
+            }
+            sim->regs[CNTL2_REG_ADDR] = data;
+            break;
+
+        case ODCNTL_REG_ADDR:
+            // new ODR-grid starts now
+            sim_kx132_update(sim);
+            clock_gettime(CLOCK_MONOTONIC, &sim->startTime);
+            sim->samplesProduced      = 0;
+            sim->regs[ODCNTL_REG_ADDR] = data;
+            break;
+
+        case BUF_CNTL2_REG_ADDR:
+            // changing resolution invalidates the stored samples
+            if((sim->regs[BUF_CNTL2_REG_ADDR] ^ data) & SIM_BUF_CNTL2_BRES){
+                sim->bufferCount  = 0;
+                sim->bufferByte   = 0;
+            }
+            sim->regs[BUF_CNTL2_REG_ADDR] = data;
+            sim_kx132_buffer_status(sim);
+            break;
+
+        case BUF_CNTL1_REG_ADDR:
+            sim->regs[BUF_CNTL1_REG_ADDR] = data;
+            sim_kx132_buffer_status(sim);
+            break;
+
+        // any write clears the sample buffer
+        case BUF_CLEAR_REG_ADDR:
+            sim->bufferHead         = 0;
+            sim->bufferCount        = 0;
+            sim->bufferByte         = 0;
+            sim->bufferTriggered    = false;
+            sim_kx132_buffer_status(sim);
+            break;
+
+        // read-only registers
+        case MAN_ID_REG_ADDR:
+        case PART_ID_REG_ADDR:
+        case WHO_AM_I_REG_ADDR:
+        case INS1_REG_ADDR:
+        case INS2_REG_ADDR:
+        case INS3_REG_ADDR:
+        case STATUS_REG_REG_ADDR:
+        case BUF_STATUS1_REG_ADDR:
+        case BUF_STATUS2_REG_ADDR:
+        case BUF_READ_REG_ADDR:
+            break;
+
+        default:
+            sim->regs[reg & (SIM_NUMBER_OF_REGS - 1)] = data;
+            break;
+    }
+}
+
+
+static void sim_kx132_reset(sim_kx132_t *sim){
+
+    memset(sim->regs, 0, sizeof(sim->regs));
+
+    sim->regs[COTR_REG_ADDR]      = SIM_COTR;
+    sim->regs[WHO_AM_I_REG_ADDR]  = SIM_WHO_AM_I;
+    sim->regs[ODCNTL_REG_ADDR]    = odr_50_Hz;
+
+    sim->samplesProduced          = 0;
+    sim->manIdIndex               = 0;
+
+    sim->bufferHead               = 0;
+    sim->bufferCount              = 0;
+    sim->bufferByte               = 0;
+    sim->bufferTriggered          = false;
+
+    sim->int1Latched              = false;
+    sim->int1Edges                = 0;
+}
+
+
+static void sim_kx132_update(sim_kx132_t *sim){
+
+    struct timespec now;
+    double          elapsedNs       = 0;
+    uint64_t        samplesDue      = 0;
+    double          outputDataRate  = 0;
+
+    if(!(sim->regs[CNTL1_REG_ADDR] & SIM_CNTL1_PC1)){
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    elapsedNs       = (double) (now.tv_sec - sim->startTime.tv_sec) * NSEC_PER_SEC + (now.tv_nsec - sim->startTime.tv_nsec);
+    outputDataRate  = getOutputDataRateHz(sim->regs[ODCNTL_REG_ADDR] & SIM_ODCNTL_OSA_MASK);
+    samplesDue      = (uint64_t) (elapsedNs * sim->config.timeScale * outputDataRate / NSEC_PER_SEC);
+
+    // every sample on the grid is produced, the buffer sees all of them
+    while(sim->samplesProduced < samplesDue){
+        sim_kx132_produce_sample(sim);
+        sim->samplesProduced++;
+    }
+}
+
+
+static void sim_kx132_produce_sample(sim_kx132_t *sim){
+
+    int16_t     xyzValue    [NUMBER_OF_AXES];
+    int16_t     adpValue    [NUMBER_OF_AXES];
+    bool        adpEnabled  = sim->regs[ADP_CNTL2_REG_ADDR] & SIM_ADP_CNTL2_ADP_EN;
+    bool        adpReady    = false;
+    uint8_t     gSelect     = (sim->regs[CNTL1_REG_ADDR] & SIM_CNTL1_GSEL_MASK) >> 3;
+    double      countsPerG  = SIM_COUNTS_PER_G_2G >> gSelect;
+    double      value       = 0;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+
+        if((sim->config.signal == sim_signal_file) && (sim->waveformLength > 0)){
+            // recorded waveform is already in counts and contains gravity
+            value = sim->waveform[(sim->signalSample % sim->waveformLength) * NUMBER_OF_AXES + axis];
+        }
+        else{
+            value = sim_kx132_signal(sim, axis, sim->signalTime) * countsPerG;
+
+            if(axis == Z_INDEX){
+                value += countsPerG;
+            }
+        }
+
+        value += sim_kx132_random(sim) * sim->config.noiseG * countsPerG;
+
+        if(value > INT16_MAX){
+            value = INT16_MAX;
+        }
+        else if(value < INT16_MIN){
+            value = INT16_MIN;
+        }
+
+        xyzValue[axis] = (int16_t) lrint(value);
+    }
+
+    sim->signalTime += 1.0 / getOutputDataRateHz(sim->regs[ODCNTL_REG_ADDR] & SIM_ODCNTL_OSA_MASK);
+    sim->signalSample++;
+
+    sim->regs[XOUT_L_REG_ADDR] = xyzValue[X_INDEX] & 0xFF;
+    sim->regs[XOUT_H_REG_ADDR] = (xyzValue[X_INDEX] >> 8) & 0xFF;
+    sim->regs[YOUT_L_REG_ADDR] = xyzValue[Y_INDEX] & 0xFF;
+    sim->regs[YOUT_H_REG_ADDR] = (xyzValue[Y_INDEX] >> 8) & 0xFF;
+    sim->regs[ZOUT_L_REG_ADDR] = xyzValue[Z_INDEX] & 0xFF;
+    sim->regs[ZOUT_H_REG_ADDR] = (xyzValue[Z_INDEX] >> 8) & 0xFF;
+
+    sim->regs[INS2_REG_ADDR] |= SIM_INS2_DRDY;
+
+    if(adpEnabled){
+        adpReady = sim_kx132_adp(sim, xyzValue, adpValue);
+    }
+
+    if(sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BUFE){
+        if(adpEnabled && (sim->regs[ADP_CNTL2_REG_ADDR] & SIM_ADP_CNTL2_BUF_SEL)){
+            if(adpReady){
+                sim_kx132_buffer_push(sim, adpValue);
+            }
+        }
+        else{
+            sim_kx132_buffer_push(sim, xyzValue);
+        }
+    }
+
+    sim_kx132_wake_engine(sim, xyzValue, countsPerG);
+
+    sim_kx132_raise_int1(sim, sim->regs[INS2_REG_ADDR] & (SIM_INS2_DRDY | SIM_INS2_WMI | SIM_INS2_BFI));
+}
+
+
+static bool sim_kx132_adp(sim_kx132_t *sim, int16_t* xyzValue, int16_t* adpValue){
+
+    uint8_t     adpCntl1        = sim->regs[ADP_CNTL1_REG_ADDR];
+    uint8_t     adpCntl2        = sim->regs[ADP_CNTL2_REG_ADDR];
+    double      rmsAverage      = 2 << ((adpCntl1 & SIM_ADP_CNTL1_RMS_AVC_MASK) >> 4);
+    double      ratio           = getOutputDataRateHz(sim->regs[ODCNTL_REG_ADDR] & SIM_ODCNTL_OSA_MASK) /
+                                  getOutputDataRateHz(adpCntl1 & SIM_ADP_CNTL1_OADP_MASK);
+    uint32_t    decimation      = (ratio > 1.0) ? (uint32_t) lrint(ratio) : 1;
+    double      value           = 0;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+
+        value = xyzValue[axis];
+
+        if(!(adpCntl2 & SIM_ADP_CNTL2_FLT1_BYP)){
+            sim->adpLowPass[axis]  += (value - sim->adpLowPass[axis]) * SIM_ADP_LOW_PASS_WEIGHT;
+            value                   = sim->adpLowPass[axis];
+        }
+
+        if(!(adpCntl2 & SIM_ADP_CNTL2_FLT2_BYP)){
+            sim->adpMean[axis]     += (value - sim->adpMean[axis]) * SIM_ADP_HIGH_PASS_WEIGHT;
+            value                  -= sim->adpMean[axis];
+        }
+
+        sim->adpMeanSquare[axis]   += (value * value - sim->adpMeanSquare[axis]) / rmsAverage;
+
+        if(adpCntl2 & SIM_ADP_CNTL2_RMS_OSEL){
+            value = sqrt(sim->adpMeanSquare[axis]);
+        }
+
+        if(value > INT16_MAX){
+            value = INT16_MAX;
+        }
+        else if(value < INT16_MIN){
+            value = INT16_MIN;
+        }
+
+        adpValue[axis] = (int16_t) lrint(value);
+    }
+
+    sim->adpDecimation++;
+    if(sim->adpDecimation < decimation){
+        return false;
+    }
+    sim->adpDecimation = 0;
+
+    sim->regs[XADP_L_REG_ADDR] = adpValue[X_INDEX] & 0xFF;
+    sim->regs[XADP_H_REG_ADDR] = (adpValue[X_INDEX] >> 8) & 0xFF;
+    sim->regs[YADP_L_REG_ADDR] = adpValue[Y_INDEX] & 0xFF;
+    sim->regs[YADP_H_REG_ADDR] = (adpValue[Y_INDEX] >> 8) & 0xFF;
+    sim->regs[ZADP_L_REG_ADDR] = adpValue[Z_INDEX] & 0xFF;
+    sim->regs[ZADP_H_REG_ADDR] = (adpValue[Z_INDEX] >> 8) & 0xFF;
+
+    return true;
+}
+
+
+static void sim_kx132_wake_engine(sim_kx132_t *sim, int16_t* xyzValue, double countsPerG){
+
+    uint8_t     cntl4           = sim->regs[CNTL4_REG_ADDR];
+    bool        awake           = sim->regs[STATUS_REG_REG_ADDR] & SIM_STATUS_REG_WAKE;
+    double      engineRate      = SIM_WAKE_ODR_MIN_HZ * (1 << (sim->regs[CNTL3_REG_ADDR] & SIM_CNTL3_OWUF_MASK));
+    double      decimation      = getOutputDataRateHz(sim->regs[ODCNTL_REG_ADDR] & SIM_ODCNTL_OSA_MASK) / engineRate;
+    double      countsPerStep   = countsPerG * SIM_WAKE_MG_PER_COUNT / 1000;
+    uint16_t    wakeThreshold   = sim->regs[WUFTH_REG_ADDR] | ((sim->regs[BTSWUFTH_REG_ADDR] & SIM_BTSWUFTH_WUFTH_H_MASK) << 4);
+    uint16_t    sleepThreshold  = sim->regs[BTSTH_REG_ADDR] | ((sim->regs[BTSWUFTH_REG_ADDR] & SIM_BTSWUFTH_BTSTH_H_MASK) << 8);
+    double      maxDelta        = 0;
+    double      delta           = 0;
+
+    if(!(cntl4 & (SIM_CNTL4_WUF_EN | SIM_CNTL4_BTS_EN))){
+        return;
+    }
+
+    sim->wakeDecimation++;
+    if(sim->wakeDecimation < decimation){
+        return;
+    }
+    sim->wakeDecimation = 0;
+
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        delta = xyzValue[axis];
+        if(cntl4 & SIM_CNTL4_TH_MODE){
+            delta -= sim->wakeReferenceValid ? sim->wakeReference[axis] : xyzValue[axis];
+        }
+        if(fabs(delta) > maxDelta){
+            maxDelta = fabs(delta);
+        }
+        sim->wakeReference[axis] = xyzValue[axis];
+    }
+    sim->wakeReferenceValid = true;
+
+    if(!awake && (cntl4 & SIM_CNTL4_WUF_EN)){
+        sim->wakeCounter = (maxDelta > wakeThreshold * countsPerStep) ? sim->wakeCounter + 1 : 0;
+
+        if((sim->wakeCounter > 0) && (sim->wakeCounter >= sim->regs[WUFC_REG_ADDR])){
+            sim->wakeCounter                 = 0;
+            sim->regs[STATUS_REG_REG_ADDR]  |= SIM_STATUS_REG_WAKE;
+            sim->regs[INS3_REG_ADDR]        |= SIM_INS3_WUFS;
+            sim->regs[INS2_REG_ADDR]        |= SIM_INS2_WUFS;
+            sim_kx132_buffer_trigger(sim);
+            sim_kx132_raise_int1(sim, SIM_INS2_WUFS);
+        }
+    }
+    else if(awake && (cntl4 & SIM_CNTL4_BTS_EN)){
+        sim->wakeCounter = (maxDelta < sleepThreshold * countsPerStep) ? sim->wakeCounter + 1 : 0;
+
+        if((sim->wakeCounter > 0) && (sim->wakeCounter >= sim->regs[BTSC_REG_ADDR])){
+            sim->wakeCounter                 = 0;
+            sim->regs[STATUS_REG_REG_ADDR]  &= ~SIM_STATUS_REG_WAKE;
+            sim->regs[INS3_REG_ADDR]        |= SIM_INS3_BTS;
+        }
+    }
+}
+
+
+static double sim_kx132_signal(sim_kx132_t *sim, axis_t axis, double time){
+
+    double sinceImpulse = 0;
+    double decay        = 0;
+    double gaussian     = 0;
+
+    switch (sim->config.signal)
+    {
+        case sim_signal_sine:
+            return simAxisWeight[axis] * sim->config.amplitudeG * sin(2.0 * M_PI * sim->config.frequencyHz * time + simAxisPhase[axis]);
+
+        case sim_signal_noise:
+            // Box-Muller, one value per call is enough here
+            gaussian = sqrt(-2.0 * log((sim_kx132_random(sim) + 1.0001) / 2.0001)) * cos(M_PI * sim_kx132_random(sim));
+            return sim->config.amplitudeG * gaussian;
+
+        case sim_signal_impulse:
+            sinceImpulse    = fmod(time, sim->config.impulsePeriodS);
+            decay           = sim->config.frequencyHz * log(100.0) / SIM_IMPULSE_DECAY_PERIODS;
+            return simAxisWeight[axis] * sim->config.amplitudeG * exp(-decay * sinceImpulse) * sin(2.0 * M_PI * sim->config.frequencyHz * sinceImpulse);
+
+        default:
+            return 0;
+    }
+}
+
+
+static double sim_kx132_random(sim_kx132_t *sim){
+    sim->noiseState ^= sim->noiseState << 13;
+    sim->noiseState ^= sim->noiseState >> 17;
+    sim->noiseState ^= sim->noiseState << 5;
+
+    return (double) sim->noiseState / UINT32_MAX * 2.0 - 1.0;
+}
+
+
+static void sim_kx132_buffer_push(sim_kx132_t *sim, int16_t* xyzValue){
+
+    uint16_t capacity   = (sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BRES) ? SIM_BUF_SAMPLES_16BIT : SIM_BUF_SAMPLES_8BIT;
+    uint8_t  bufferMode = sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BM_MASK;
+
+    if(sim->bufferCount >= capacity){
+        if((bufferMode == SIM_BUF_MODE_FIFO) || ((bufferMode == SIM_BUF_MODE_TRIGGER) && sim->bufferTriggered)){
+            return;
+        }
+
+        // stream mode and trigger mode before the event discard oldest sample
+        sim->bufferHead   = (sim->bufferHead + 1) % capacity;
+        sim->bufferCount--;
+        sim->bufferByte   = 0;
+    }
+
+    memcpy(sim->buffer[(sim->bufferHead + sim->bufferCount) % capacity], xyzValue, sizeof(sim->buffer[0]));
+    sim->bufferCount++;
+
+    sim_kx132_buffer_status(sim);
+}
+
+
+static void sim_kx132_buffer_trigger(sim_kx132_t *sim){
+
+    uint16_t capacity           = (sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BRES) ? SIM_BUF_SAMPLES_16BIT : SIM_BUF_SAMPLES_8BIT;
+    uint16_t samplesBeforeTrig  = sim->regs[BUF_CNTL1_REG_ADDR];
+
+    if(!(sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BUFE)
+        || ((sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BM_MASK) != SIM_BUF_MODE_TRIGGER)
+        || sim->bufferTriggered){
+        return;
+    }
+
+    while(sim->bufferCount > samplesBeforeTrig){
+        sim->bufferHead   = (sim->bufferHead + 1) % capacity;
+        sim->bufferCount--;
+        sim->bufferByte   = 0;
+    }
+
+    sim->bufferTriggered = true;
+    sim_kx132_buffer_status(sim);
+}
+
+
+static uint8_t sim_kx132_buffer_pop_byte(sim_kx132_t *sim){
+
+    bool        resolution16    = sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BRES;
+    uint16_t    capacity        = resolution16 ? SIM_BUF_SAMPLES_16BIT : SIM_BUF_SAMPLES_8BIT;
+    uint8_t     sampleBytes     = resolution16 ? SIM_SAMPLE_BYTES_16BIT : SIM_SAMPLE_BYTES_8BIT;
+    int16_t*    sample          = sim->buffer[sim->bufferHead];
+    uint8_t     value           = 0;
+
+    if(sim->bufferCount == 0){
+        return 0;
+    }
+
+    // 16-Bit: XL, XH, YL, YH, ZL, ZH / 8-Bit: XH, YH, ZH
+    if(resolution16){
+        value = (sample[sim->bufferByte / 2] >> ((sim->bufferByte % 2) * 8)) & 0xFF;
+    }
+    else{
+        value = (sample[sim->bufferByte] >> 8) & 0xFF;
+    }
+
+    sim->bufferByte++;
+
+    if(sim->bufferByte == sampleBytes){
+        sim->bufferHead   = (sim->bufferHead + 1) % capacity;
+        sim->bufferCount--;
+        sim->bufferByte   = 0;
+    }
+
+    sim_kx132_buffer_status(sim);
+
+    return value;
+}
+
+
+static void sim_kx132_buffer_status(sim_kx132_t *sim){
+
+    bool        resolution16    = sim->regs[BUF_CNTL2_REG_ADDR] & SIM_BUF_CNTL2_BRES;
+    uint16_t    capacity        = resolution16 ? SIM_BUF_SAMPLES_16BIT : SIM_BUF_SAMPLES_8BIT;
+    uint8_t     sampleBytes     = resolution16 ? SIM_SAMPLE_BYTES_16BIT : SIM_SAMPLE_BYTES_8BIT;
+    uint16_t    levelBytes      = sim->bufferCount * sampleBytes - sim->bufferByte;
+    uint16_t    watermark       = sim->regs[BUF_CNTL1_REG_ADDR];
+
+    sim->regs[BUF_STATUS1_REG_ADDR]   = levelBytes & 0xFF;
+    sim->regs[BUF_STATUS2_REG_ADDR]   = ((levelBytes >> 8) & SIM_BUF_STATUS2_LEV_H_MASK) | (sim->bufferTriggered ? SIM_BUF_STATUS2_BUF_TRIG : 0x00);
+
+    sim->regs[INS2_REG_ADDR] &= ~(SIM_INS2_WMI | SIM_INS2_BFI);
+
+    if((watermark > 0) && (sim->bufferCount >= watermark)){
+        sim->regs[INS2_REG_ADDR] |= SIM_INS2_WMI;
+    }
+    if(sim->bufferCount >= capacity){
+        sim->regs[INS2_REG_ADDR] |= SIM_INS2_BFI;
+    }
+}
+
+
+static void sim_kx132_raise_int1(sim_kx132_t *sim, uint8_t events){
+
+    uint8_t routed = events & sim->regs[INC4_REG_ADDR];
+
+    if(!(sim->regs[INC1_REG_ADDR] & SIM_INC1_IEN1) || !routed){
+        return;
+    }
+
+    // pulsed: every interrupt is an edge / latched: line stays high until INT_REL is read
+    if(sim->regs[INC1_REG_ADDR] & SIM_INC1_IEL1){
+        sim->int1Edges++;
+    }
+    else if(!sim->int1Latched){
+        sim->int1Latched = true;
+        sim->int1Edges++;
+    }
+}
+
+
+static bool sim_kx132_load_waveform(sim_kx132_t *sim, const char* path){
+
+    char        line    [SIM_WAVEFORM_LINE_LEN];
+    double      numbers [SIM_WAVEFORM_MAX_COLUMNS];
+    int         count   = 0;
+    char*       end     = NULL;
+    uint32_t    size    = 0;
+    int16_t*    resized = NULL;
+
+    FILE* file = fopen(path, "r");
+    if(file == NULL){
+        printf("[sim_kx132][error] Could not open waveform %s.\n", path);
+        return false;
+    }
+
+    free(sim->waveform);
+    sim->waveform         = NULL;
+    sim->waveformLength   = 0;
+
+    while(fgets(line, sizeof(line), file) != NULL){
+
+        // "x, y, z" or "index, t, x, y, z" like written by the GUI, lines with text are skipped
+        count = 0;
+        for(char *strPtr = strtok(line, ", \t\r\n"); strPtr != NULL; strPtr = strtok(NULL, ", \t\r\n")){
+            numbers[count % SIM_WAVEFORM_MAX_COLUMNS] = strtod(strPtr, &end);
+            if(*end != '\0'){
+                count = 0;
+                break;
+            }
+            count++;
+        }
+
+        if((count < NUMBER_OF_AXES) || (count > SIM_WAVEFORM_MAX_COLUMNS)){
+            continue;
+        }
+
+        if(sim->waveformLength == size){
+            size    = (size == 0) ? 1024 : size * 2;
+            resized = realloc(sim->waveform, size * NUMBER_OF_AXES * sizeof(int16_t));
+            if(resized == NULL){
+                printf("[sim_kx132][error] Not enough memory for waveform.\n");
+                fclose(file);
+                return false;
+            }
+            sim->waveform = resized;
+        }
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            sim->waveform[sim->waveformLength * NUMBER_OF_AXES + axis] = (int16_t) lrint(numbers[count - NUMBER_OF_AXES + axis]);
+        }
+        sim->waveformLength++;
+    }
+
+    fclose(file);
+
+    if(sim->waveformLength == 0){
+        printf("[sim_kx132][error] No samples in waveform %s.\n", path);
+        return false;
+    }
+
+    printf("[sim_kx132] Loaded %u samples from %s.\n", sim->waveformLength, path);
+    return true;
+}
+
+
+static void sim_kx132_sample_time(sim_kx132_t *sim, uint64_t sampleNumber, struct timespec* sampleTime){
+
+    double outputDataRate   = getOutputDataRateHz(sim->regs[ODCNTL_REG_ADDR] & SIM_ODCNTL_OSA_MASK);
+    double offsetNs         = sampleNumber * NSEC_PER_SEC / (outputDataRate * sim->config.timeScale);
+    uint64_t nsec           = sim->startTime.tv_nsec + (uint64_t) ceil(offsetNs);
+
+    sampleTime->tv_sec      = sim->startTime.tv_sec + nsec / NSEC_PER_SEC;
+    sampleTime->tv_nsec     = nsec % NSEC_PER_SEC;
+}
+
+
+//-------------------------------------------------------------------
+//--- Simulated INT1  -----------------------------------------------
+//-------------------------------------------------------------------
+
+static bool sim_int1_init(gpio_event_t *event, gpio_config_t *gpioConfig, uint64_t eventPeriodNs){
+
+    if(event->context == NULL){
+        printf("[gpio][error] No simulated KX132 attached to INT1.\n");
+        return false;
+    }
+
+    printf("[gpio] Using INT1 of simulated KX132.\n");
+    return true;
+}
+
+
+static int32_t sim_int1_wait(gpio_event_t *event, uint32_t timeoutUs){
+
+    sim_kx132_t*    sim = event->context;
+    struct timespec now;
+    struct timespec deadline;
+    struct timespec nextSample;
+    int32_t         edges = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    deadline.tv_sec     = now.tv_sec + timeoutUs / 1000000;
+    deadline.tv_nsec    = now.tv_nsec + (timeoutUs % 1000000) * NSEC_PER_USEC;
+    if(deadline.tv_nsec >= NSEC_PER_SEC){
+        deadline.tv_nsec -= NSEC_PER_SEC;
+        deadline.tv_sec++;
+    }
+
+    while(true){
+        sim_kx132_update(sim);
+
+        if(sim->int1Edges > 0){
+            edges           = sim->int1Edges;
+            sim->int1Edges    = 0;
+            return edges;
+        }
+
+        // sleep until the next sample is produced, the only point in time INT1 can change
+        sim_kx132_sample_time(sim, sim->samplesProduced + 1, &nextSample);
+
+        if(!(sim->regs[CNTL1_REG_ADDR] & SIM_CNTL1_PC1)
+            || (nextSample.tv_sec > deadline.tv_sec)
+            || ((nextSample.tv_sec == deadline.tv_sec) && (nextSample.tv_nsec > deadline.tv_nsec))){
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+            return 0;
+        }
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextSample, NULL);
+    }
+}
+
+
+static void sim_int1_deinit(gpio_event_t *event){
+    sim_kx132_t* sim = event->context;
+    sim->int1Edges = 0;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+ * @file spi_bcm2835.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief SPI backend using libbcm2835.
+ * 
+ *  Accesses the SPI0 peripheral of the RaspberryPi directly. Only compiled with libbcm2835
+ *  if SPI_BACKEND_BCM2835 is defined (see Makefile), otherwise init fails.
+ *  Devices on CS0 and CS1 share the peripheral, chip select and clock are switched per transfer.
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef SPI_BACKEND_BCM2835
+#include <bcm2835.h>
+#endif //SPI_BACKEND_BCM2835
+///\endcond
+
+#include <spi_wrapper.h>
+
+
+#define BCM2835_CORE_FREQ_HZ                400000000   ///< RPi core_freq and core_freq_min in /boot/coinfig.txt both set to 400 MHz
+#define BCM2835_SPI_MIN_CLK_DIVIDER         2           ///< divider has to be even
+#define BCM2835_SPI_BUS                     0           ///< only SPI0 is supported, SPI1 / SPI2 are auxiliary peripherals
+
+
+static bool     bcm2835_backend_init        (spi_device_t *device);
+static void     bcm2835_backend_deinit      (spi_device_t *device);
+static void     bcm2835_backend_transfer    (spi_device_t *device, uint8_t *buffer, uint32_t len);
+static void     bcm2835_backend_batch       (spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments);
+static uint32_t bcm2835_backend_set_clock   (spi_device_t *device, uint32_t clockHz);
+
+
+const spi_backend_t spi_backend_bcm2835_ops = {
+    .name           = "bcm2835",
+    .init           = bcm2835_backend_init,
+    .deinit         = bcm2835_backend_deinit,
+    .transfer       = bcm2835_backend_transfer,
+    .transfer_batch = bcm2835_backend_batch,
+    .set_clock      = bcm2835_backend_set_clock,
+};
+
+
+#ifdef SPI_BACKEND_BCM2835
+
+static uint8_t  bcm2835Devices          = 0;        ///< library is opened for the first and closed after the last device
+static uint8_t  activeChipSelect        = 0;        ///< chip select of last transfer
+static uint32_t activeClockDivider      = 0;        ///< clock divider of last transfer
+
+
+/**
+ * @brief Switches chip select and clock to the device, if the last transfer was to another device.
+ * 
+ * @note Called while holding the bus.
+ * 
+ * @param device    pointer to device
+ */
+static void bcm2835_backend_select(spi_device_t *device);
+
+
+static bool bcm2835_backend_init(spi_device_t *device){
+
+    spi_config_t *spiConfig = &device->config;
+
+    if(spiConfig->bus != BCM2835_SPI_BUS){
+        printf("[spi][error] bcm2835 only supports SPI0, use -spi spidev for bus %u.\n", spiConfig->bus);
+        return false;
+    }
+
+    bcm2835_backend_set_clock(device, spiConfig->clockHz);
+
+    if(bcm2835Devices == 0){
+        if (!bcm2835_init()){
+            return false;
+        }
+
+        if (!bcm2835_spi_begin()){
+            return false;
+        }
+
+        bcm2835_spi_setBitOrder         (BCM2835_SPI_BIT_ORDER_MSBFIRST);
+        bcm2835_spi_setDataMode         (BCM2835_SPI_MODE0);
+        activeClockDivider = 0;
+    }
+
+    bcm2835_spi_setChipSelectPolarity   (spiConfig->chipSelect ? BCM2835_SPI_CS1 : BCM2835_SPI_CS0, LOW);
+    bcm2835_backend_select(device);
+
+    bcm2835Devices++;
+    return true;
+}
+
+
+static void bcm2835_backend_deinit(spi_device_t *device){
+    bcm2835Devices--;
+    if(bcm2835Devices == 0){
+        bcm2835_spi_end();
+        bcm2835_close();
+    }
+}
+
+
+static uint32_t bcm2835_backend_set_clock(spi_device_t *device, uint32_t clockHz){
+
+    // core clock is divided by an even divider, round up so the clock is never faster than requested
+    uint32_t clockDivider = (BCM2835_CORE_FREQ_HZ + clockHz - 1) / clockHz;
+    clockDivider = (clockDivider + 1) & ~1u;
+
+    if(clockDivider < BCM2835_SPI_MIN_CLK_DIVIDER){
+        clockDivider = BCM2835_SPI_MIN_CLK_DIVIDER;
+    }
+
+    // switched by bcm2835_backend_select() before the next transfer
+    device->clockDivider    = clockDivider;
+    device->config.clockHz  = BCM2835_CORE_FREQ_HZ / clockDivider;
+
+    return device->config.clockHz;
+}
+
+
+static void bcm2835_backend_select(spi_device_t *device){
+
+    if(device->config.chipSelect != activeChipSelect){
+        bcm2835_spi_chipSelect(device->config.chipSelect ? BCM2835_SPI_CS1 : BCM2835_SPI_CS0);
+        activeChipSelect = device->config.chipSelect;
+    }
+
+    if(device->clockDivider != activeClockDivider){
+        bcm2835_spi_setClockDivider(device->clockDivider);
+        activeClockDivider = device->clockDivider;
+    }
+}
+
+
+static void bcm2835_backend_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len){
+    bcm2835_backend_select(device);
+    bcm2835_spi_transfern((char*) buffer, len);
+}
+
+
+static void bcm2835_backend_batch(spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments){
+    bcm2835_backend_select(device);
+
+    // no syscalls involved, segments are transferred back to back with a chip-select cycle in between
+    for(uint8_t i = 0; i < numberOfSegments; i++){
+        bcm2835_spi_transfern((char*) segments[i].buffer, segments[i].len);
+    }
+}
+
+#else
+
+static bool bcm2835_backend_init(spi_device_t *device){
+    printf("[spi][error] Built without libbcm2835. Rebuild with BCM2835=1 or use -spi spidev / -spi sim.\n");
+    return false;
+}
+
+
+static void bcm2835_backend_deinit(spi_device_t *device){
+}
+
+
+static void bcm2835_backend_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len){
+}
+
+
+static void bcm2835_backend_batch(spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments){
+}
+
+
+static uint32_t bcm2835_backend_set_clock(spi_device_t *device, uint32_t clockHz){
+    return 0;
+}
+
+#endif //SPI_BACKEND_BCM2835
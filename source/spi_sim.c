@@ -0,0 +1,140 @@
+/**
+ * @file spi_sim.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief SPI backend talking to the in-process simulated KX132.
+ * 
+ *  Decodes SPI frames the same way the KX132 does: the first byte holds the register address
+ *  and the read-bit, every following byte reads/writes the next register through auto-increment.
+ *  Every device talks to its own simulated KX132 (device->context).
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+///\endcond
+
+#include <spi_wrapper.h>
+#include <sim_kx132.h>
+
+
+#define SIM_READ_BIT            0x80
+#define SIM_REG_ADDR_MASK       0x7F
+#define SIM_BITS_PER_BYTE       8
+
+
+static uint32_t linkNoiseState      = 0x2545F491;   ///< xorshift state for bit errors of an overclocked link
+
+
+static bool     sim_backend_init            (spi_device_t *device);
+static void     sim_backend_deinit          (spi_device_t *device);
+static void     sim_backend_transfer        (spi_device_t *device, uint8_t *buffer, uint32_t len);
+static void     sim_backend_batch           (spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments);
+static uint32_t sim_backend_set_clock       (spi_device_t *device, uint32_t clockHz);
+
+
+/**
+ * @brief Flips a random bit of a read byte, the faster the clock is above the max SPI clock, the more likely.
+ * 
+ * @param device    pointer to device
+ * @param data      read byte
+ * @return uint8_t  read byte, possibly corrupted
+ */
+static uint8_t  sim_backend_link_error      (spi_device_t *device, uint8_t data);
+
+
+const spi_backend_t spi_backend_sim_ops = {
+    .name           = "sim",
+    .init           = sim_backend_init,
+    .deinit         = sim_backend_deinit,
+    .transfer       = sim_backend_transfer,
+    .transfer_batch = sim_backend_batch,
+    .set_clock      = sim_backend_set_clock,
+};
+
+
+static bool sim_backend_init(spi_device_t *device){
+
+    if(device->context == NULL){
+        printf("[spi][error] No simulated KX132 on bus %u, CS%u.\n", device->config.bus, device->config.chipSelect);
+        return false;
+    }
+
+    return sim_kx132_init(device->context);
+}
+
+
+static void sim_backend_deinit(spi_device_t *device){
+    sim_kx132_deinit(device->context);
+}
+
+
+static void sim_backend_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len){
+
+    sim_kx132_t* sim = device->context;
+
+    if(len == 0){
+        return;
+    }
+
+    bool        readAccess  = buffer[0] & SIM_READ_BIT;
+    kx132_reg_t reg         = buffer[0] & SIM_REG_ADDR_MASK;
+
+    buffer[0] = 0;
+
+    sim_kx132_begin_transfer(sim);
+
+    for(uint32_t i = 1; i < len; i++){
+        if(readAccess){
+            buffer[i] = sim_backend_link_error(device, sim_kx132_read(sim, reg));
+        }
+        else{
+            sim_kx132_write(sim, reg, buffer[i]);
+        }
+
+        // BUF_READ and MAN_ID do not auto-increment, consecutive reads drain the sample buffer / return "Kion"
+        if((reg != BUF_READ_REG_ADDR) && (reg != MAN_ID_REG_ADDR)){
+            reg = (reg + 1) & SIM_REG_ADDR_MASK;
+        }
+    }
+}
+
+
+static void sim_backend_batch(spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments){
+    for(uint8_t i = 0; i < numberOfSegments; i++){
+        sim_backend_transfer(device, segments[i].buffer, segments[i].len);
+    }
+}
+
+
+static uint32_t sim_backend_set_clock(spi_device_t *device, uint32_t clockHz){
+    device->config.clockHz = clockHz;
+    return clockHz;
+}
+
+
+static uint8_t sim_backend_link_error(spi_device_t *device, uint8_t data){
+
+    sim_kx132_t*    sim         = device->context;
+    double          errorRate   = 0;
+
+    if(device->config.clockHz <= sim->config.maxSpiClockHz){
+        return data;
+    }
+
+    // 25 % above the max clock every byte is corrupted
+    errorRate = 4.0 * ((double) device->config.clockHz / sim->config.maxSpiClockHz - 1.0);
+
+    linkNoiseState ^= linkNoiseState << 13;
+    linkNoiseState ^= linkNoiseState >> 17;
+    linkNoiseState ^= linkNoiseState << 5;
+
+    if((double) linkNoiseState / UINT32_MAX < errorRate){
+        data ^= 1 << (linkNoiseState % SIM_BITS_PER_BYTE);
+    }
+
+    return data;
+}
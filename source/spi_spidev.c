@@ -0,0 +1,132 @@
+/**
+ * @file spi_spidev.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief SPI backend using the Linux spidev driver.
+ * 
+ *  Transfers go through SPI_IOC_MESSAGE, so the kernel SPI controller driver (and its DMA)
+ *  is used instead of accessing the peripheral directly. Works on any board with spidev.
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+///\endcond
+
+#include <spi_wrapper.h>
+
+
+#define SPIDEV_BITS_PER_WORD    8
+
+
+static bool     spidev_backend_init         (spi_device_t *device);
+static void     spidev_backend_deinit       (spi_device_t *device);
+static void     spidev_backend_transfer     (spi_device_t *device, uint8_t *buffer, uint32_t len);
+static void     spidev_backend_batch        (spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments);
+static uint32_t spidev_backend_set_clock    (spi_device_t *device, uint32_t clockHz);
+
+
+const spi_backend_t spi_backend_spidev_ops = {
+    .name           = "spidev",
+    .init           = spidev_backend_init,
+    .deinit         = spidev_backend_deinit,
+    .transfer       = spidev_backend_transfer,
+    .transfer_batch = spidev_backend_batch,
+    .set_clock      = spidev_backend_set_clock,
+};
+
+
+static bool spidev_backend_init(spi_device_t *device){
+
+    spi_config_t*   spiConfig   = &device->config;
+    uint8_t         mode        = SPI_MODE_0;
+    uint8_t         bitsPerWord = SPIDEV_BITS_PER_WORD;
+
+    // every chip select of every bus is its own spidev device, the kernel serializes transfers on a bus
+    device->fd = open(spiConfig->devicePath, O_RDWR | O_CLOEXEC);
+    if(device->fd < 0){
+        printf("[spi][error] Could not open %s.\n", spiConfig->devicePath);
+        return false;
+    }
+
+    if( (ioctl(device->fd, SPI_IOC_WR_MODE,          &mode)                 < 0) ||
+        (ioctl(device->fd, SPI_IOC_WR_BITS_PER_WORD, &bitsPerWord)          < 0) ||
+        (ioctl(device->fd, SPI_IOC_WR_MAX_SPEED_HZ,  &spiConfig->clockHz)   < 0) ){
+        printf("[spi][error] Could not configure %s.\n", spiConfig->devicePath);
+        close(device->fd);
+        device->fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+
+static void spidev_backend_deinit(spi_device_t *device){
+    if(device->fd >= 0){
+        close(device->fd);
+    }
+    device->fd = -1;
+}
+
+
+static void spidev_backend_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len){
+
+    struct spi_ioc_transfer transfer;
+    memset(&transfer, 0, sizeof(transfer));
+
+    // spidev copies tx before filling rx, so one buffer can be used for both directions
+    transfer.tx_buf         = (uintptr_t) buffer;
+    transfer.rx_buf         = (uintptr_t) buffer;
+    transfer.len            = len;
+    transfer.speed_hz       = device->config.clockHz;
+    transfer.bits_per_word  = SPIDEV_BITS_PER_WORD;
+
+    if(ioctl(device->fd, SPI_IOC_MESSAGE(1), &transfer) < 0){
+        printf("[spi][error] SPI_IOC_MESSAGE failed.\n");
+    }
+}
+
+
+static void spidev_backend_batch(spi_device_t *device, spi_segment_t *segments, uint8_t numberOfSegments){
+
+    struct spi_ioc_transfer transfers[SPI_BATCH_MAX_SEGMENTS];
+    memset(transfers, 0, sizeof(transfers));
+
+    for(uint8_t i = 0; i < numberOfSegments; i++){
+        transfers[i].tx_buf         = (uintptr_t) segments[i].buffer;
+        transfers[i].rx_buf         = (uintptr_t) segments[i].buffer;
+        transfers[i].len            = segments[i].len;
+        transfers[i].speed_hz       = device->config.clockHz;
+        transfers[i].bits_per_word  = SPIDEV_BITS_PER_WORD;
+
+        // deselect between segments, every register access needs its own chip-select cycle
+        transfers[i].cs_change      = (i < (numberOfSegments - 1));
+    }
+
+    // all segments in one syscall
+    if(ioctl(device->fd, SPI_IOC_MESSAGE(numberOfSegments), transfers) < 0){
+        printf("[spi][error] SPI_IOC_MESSAGE failed.\n");
+    }
+}
+
+
+static uint32_t spidev_backend_set_clock(spi_device_t *device, uint32_t clockHz){
+
+    // every transfer passes its speed, the max speed is only the default of the device
+    if(ioctl(device->fd, SPI_IOC_WR_MAX_SPEED_HZ, &clockHz) < 0){
+        printf("[spi][error] Could not set SPI clock of %s.\n", device->config.devicePath);
+        return device->config.clockHz;
+    }
+
+    device->config.clockHz = clockHz;
+    return clockHz;
+}
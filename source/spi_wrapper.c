@@ -14,14 +14,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-#include <bcm2835.h>
+#include <pthread.h>
 ///\endcond
 
 #include <regs_kx132.h>
 #include <spi_wrapper.h>
 
 
-#define BCM2835_SPI_CUSTOM_CLK_DIVIDER_40   40      ///< RPi core_freq and core_freq_min in /boot/coinfig.txt both set to 400 MHz
 #define READ_SPI                            0x80    ///< Reading from KX132-Register requires sending the register number combined with the read-command 0x80 through an OR
 #define WRITE_SPI                           0x00    ///< Writing to KX132-Register does not require any extra command. Only here for clarity.
 
@@ -30,57 +29,236 @@
                                                     ///<  [reg-address + value1 + value2 + ... + value6]
 
 
-bool spi_init(void){
+static spi_bus_t spiBuses[SPI_MAX_BUSES];          ///< devices with the same bus number share the lock
 
-    if (!bcm2835_init()){
+
+/**
+ * @brief Executes one full-duplex transfer while holding the bus.
+ * 
+ * @param device    pointer to device
+ * @param buffer    address byte + data, received bytes overwrite sent bytes
+ * @param len       number of bytes incl. address byte
+ */
+static void spi_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len);
+
+
+bool spi_init(spi_device_t *device, spi_config_t *spiConfig){
+
+    pthread_mutexattr_t lockAttr;
+
+    if((spiConfig->bus >= SPI_MAX_BUSES) || (spiConfig->chipSelect >= SPI_MAX_CHIP_SELECTS)){
+        printf("[spi][error] No SPI bus %u / CS%u.\n", spiConfig->bus, spiConfig->chipSelect);
+        return false;
+    }
+
+    switch (spiConfig->backend)
+    {
+        case spi_backend_bcm2835:
+            device->backend = &spi_backend_bcm2835_ops;
+            break;
+
+        case spi_backend_spidev:
+            device->backend = &spi_backend_spidev_ops;
+            break;
+
+        case spi_backend_sim:
+            device->backend = &spi_backend_sim_ops;
+            break;
+
+        default:
+            printf("[spi][error] Unknown SPI backend.\n");
+            return false;
+    }
+
+    device->config  = *spiConfig;
+    device->bus     = &spiBuses[spiConfig->bus];
+
+    if(!device->backend->init(device)){
+        printf("[spi][error] SPI backend %s could not be initialized.\n", device->backend->name);
+        device->backend = NULL;
         return false;
     }
 
-    bcm2835_spi_begin                   ();
-    bcm2835_spi_setBitOrder             (BCM2835_SPI_BIT_ORDER_MSBFIRST);
-    bcm2835_spi_setDataMode             (BCM2835_SPI_MODE0);
-    bcm2835_spi_setClockDivider         (BCM2835_SPI_CUSTOM_CLK_DIVIDER_40);
-    bcm2835_spi_chipSelect              (BCM2835_SPI_CS0);
-    bcm2835_spi_setChipSelectPolarity   (BCM2835_SPI_CS0, LOW);
+    // a real-time thread waiting for the bus lends its priority to the thread holding it
+    if(device->bus->devices == 0){
+        pthread_mutexattr_init          (&lockAttr);
+        pthread_mutexattr_setprotocol   (&lockAttr, PTHREAD_PRIO_INHERIT);
+        pthread_mutex_init              (&device->bus->lock, &lockAttr);
+        pthread_mutexattr_destroy       (&lockAttr);
+    }
+    device->bus->devices++;
 
+    printf("[spi] Using SPI backend %s, bus %u, CS%u.\n", device->backend->name, spiConfig->bus, spiConfig->chipSelect);
     return true;
 }
 
 
-void spi_deinit(void){
-    bcm2835_spi_end();
+void spi_deinit(spi_device_t *device){
+    if(device->backend == NULL){
+        return;
+    }
+
+    device->backend->deinit(device);
+    device->backend = NULL;
+
+    device->bus->devices--;
+    if(device->bus->devices == 0){
+        pthread_mutex_destroy(&device->bus->lock);
+    }
+}
+
+
+uint32_t spi_set_clock(spi_device_t *device, uint32_t clockHz){
+
+    uint32_t actualClockHz = 0;
+
+    pthread_mutex_lock      (&device->bus->lock);
+    actualClockHz = device->backend->set_clock(device, clockHz);
+    pthread_mutex_unlock    (&device->bus->lock);
+
+    return actualClockHz;
+}
+
+
+static void spi_transfer(spi_device_t *device, uint8_t *buffer, uint32_t len){
+    pthread_mutex_lock      (&device->bus->lock);
+    device->backend->transfer(device, buffer, len);
+    pthread_mutex_unlock    (&device->bus->lock);
 }
 
 
-void spi_write(kx132_reg_t reg, uint8_t data){
+void spi_write(spi_device_t *device, kx132_reg_t reg, uint8_t data){
 
     uint8_t buffer[2];
     buffer[0] = reg | WRITE_SPI;
     buffer[1] = data;
 
-    bcm2835_spi_transfern(buffer, 2);
+    spi_transfer(device, buffer, 2);
     return;
 }
 
 
-void spi_read(kx132_reg_t reg, uint8_t* data){
+void spi_read(spi_device_t *device, kx132_reg_t reg, uint8_t* data){
 
     uint8_t buffer[2];
     buffer[0] = reg | READ_SPI;
 
-    bcm2835_spi_transfern(buffer,2);
+    spi_transfer(device, buffer, 2);
     *data = buffer[1];
     return;
 }
 
 
-void spi_read_burst(kx132_reg_t reg, uint8_t* data, uint16_t len){ 
+void spi_read_burst(spi_device_t *device, kx132_reg_t reg, uint8_t* data, uint16_t len){ 
 
     uint8_t buffer[len + SPI_READ_EXTRA_BYTE]; // 
     buffer[0] = reg | READ_SPI;
 
-    bcm2835_spi_transfern(buffer, (len + SPI_READ_EXTRA_BYTE) );
+    spi_transfer(device, buffer, (len + SPI_READ_EXTRA_BYTE) );
     
     memcpy(data, &buffer[1], len);
 
+}
+
+
+void spi_read_frame(spi_device_t *device, kx132_reg_t reg, uint8_t* frame, uint16_t len){
+    frame[0] = reg | READ_SPI;
+    spi_transfer(device, frame, (len + SPI_READ_EXTRA_BYTE) );
+}
+
+
+void spi_batch_clear(spi_batch_t *batch){
+    batch->bytesUsed        = 0;
+    batch->numberOfSegments = 0;
+}
+
+
+bool spi_batch_read(spi_batch_t *batch, kx132_reg_t reg, uint8_t* data, uint16_t len){
+
+    uint16_t frameLen = len + SPI_READ_EXTRA_BYTE;
+
+    if( (batch->numberOfSegments >= SPI_BATCH_MAX_SEGMENTS) || ((batch->bytesUsed + frameLen) > SPI_BATCH_MAX_BYTES) ){
+        printf("[spi][error] SPI batch is full.\n");
+        return false;
+    }
+
+    uint8_t *frame = &batch->frames[batch->bytesUsed];
+    frame[0] = reg | READ_SPI;
+
+    batch->segments[batch->numberOfSegments].buffer     = frame;
+    batch->segments[batch->numberOfSegments].len        = frameLen;
+    batch->destinations[batch->numberOfSegments]        = data;
+    batch->commands[batch->numberOfSegments][0]         = frame[0];
+
+    batch->bytesUsed += frameLen;
+    batch->numberOfSegments++;
+
+    return true;
+}
+
+
+bool spi_batch_read_frame(spi_batch_t *batch, kx132_reg_t reg, uint8_t* frame, uint16_t len){
+
+    if(batch->numberOfSegments >= SPI_BATCH_MAX_SEGMENTS){
+        printf("[spi][error] SPI batch is full.\n");
+        return false;
+    }
+
+    frame[0] = reg | READ_SPI;
+
+    batch->segments[batch->numberOfSegments].buffer     = frame;
+    batch->segments[batch->numberOfSegments].len        = len + SPI_READ_EXTRA_BYTE;
+    batch->destinations[batch->numberOfSegments]        = &frame[SPI_READ_EXTRA_BYTE];
+    batch->commands[batch->numberOfSegments][0]         = frame[0];
+
+    batch->numberOfSegments++;
+
+    return true;
+}
+
+
+bool spi_batch_write(spi_batch_t *batch, kx132_reg_t reg, uint8_t data){
+
+    if( (batch->numberOfSegments >= SPI_BATCH_MAX_SEGMENTS) || ((batch->bytesUsed + 2) > SPI_BATCH_MAX_BYTES) ){
+        printf("[spi][error] SPI batch is full.\n");
+        return false;
+    }
+
+    uint8_t *frame = &batch->frames[batch->bytesUsed];
+    frame[0] = reg | WRITE_SPI;
+    frame[1] = data;
+
+    batch->segments[batch->numberOfSegments].buffer     = frame;
+    batch->segments[batch->numberOfSegments].len        = 2;
+    batch->destinations[batch->numberOfSegments]        = NULL;
+    batch->commands[batch->numberOfSegments][0]         = frame[0];
+    batch->commands[batch->numberOfSegments][1]         = frame[1];
+
+    batch->bytesUsed += 2;
+    batch->numberOfSegments++;
+
+    return true;
+}
+
+
+void spi_batch_execute(spi_device_t *device, spi_batch_t *batch){
+
+    pthread_mutex_lock      (&device->bus->lock);
+    device->backend->transfer_batch(device, batch->segments, batch->numberOfSegments);
+    pthread_mutex_unlock    (&device->bus->lock);
+
+    for(uint8_t i = 0; i < batch->numberOfSegments; i++){
+        spi_segment_t *segment = &batch->segments[i];
+
+        if(batch->destinations[i] == NULL){
+            segment->buffer[1] = batch->commands[i][1];
+        }
+        // frames were received in place
+        else if(batch->destinations[i] != &segment->buffer[SPI_READ_EXTRA_BYTE]){
+            memcpy(batch->destinations[i], &segment->buffer[SPI_READ_EXTRA_BYTE], segment->len - SPI_READ_EXTRA_BYTE);
+        }
+
+        // received bytes overwrote the sent bytes, restore them for executing the batch again
+        segment->buffer[0] = batch->commands[i][0];
+    }
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+/**
+ * @file spsc_queue.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Contains functions of the lock-free single-producer / single-consumer queue.
+ * 
+ *  head and tail run freely and are only masked for addressing a slot, so a full queue needs no extra slot.
+ *  Each side caches the index of the other side and only loads it again when the cached one says full / empty.
+ *  Slots are written and read in place, the release store of an index publishes the slot contents with it.
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+///\endcond
+
+#include <spsc_queue.h>
+
+
+bool spsc_init(spsc_queue_t *queue, uint32_t capacity, size_t slotSize){
+
+    if((capacity == 0) || ((capacity & (capacity - 1)) != 0)){
+        printf("[spsc][error] Capacity of queue is not power of two.\n");
+        return false;
+    }
+
+    // slots of neighbouring threads never share a cache line
+    queue->slotSize = (slotSize + SPSC_CACHE_LINE - 1) & ~((size_t) SPSC_CACHE_LINE - 1);
+    queue->capacity = capacity;
+    queue->modulo   = capacity - 1;
+    queue->slots    = aligned_alloc(SPSC_CACHE_LINE, queue->slotSize * capacity);
+
+    if(queue->slots == NULL){
+        printf("[spsc][error] Slots of queue could not be allocated.\n");
+        return false;
+    }
+
+    // no page fault may happen when the producer fills a slot for the first time
+    memset(queue->slots, 0, queue->slotSize * capacity);
+
+    atomic_init(&queue->head,   0);
+    atomic_init(&queue->tail,   0);
+    atomic_init(&queue->closed, false);
+    queue->headCache = 0;
+    queue->tailCache = 0;
+
+    return true;
+}
+
+
+void spsc_free(spsc_queue_t *queue){
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+
+void *spsc_slot(spsc_queue_t *queue, uint32_t index){
+    return &queue->slots[(index & queue->modulo) * queue->slotSize];
+}
+
+
+void *spsc_write_slot(spsc_queue_t *queue){
+
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    if(head - queue->tailCache == queue->capacity){
+        queue->tailCache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+        if(head - queue->tailCache == queue->capacity){
+            return NULL;
+        }
+    }
+
+    return spsc_slot(queue, head);
+}
+
+
+void spsc_commit_write(spsc_queue_t *queue){
+
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+
+void *spsc_read_slot(spsc_queue_t *queue){
+
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if(tail == queue->headCache){
+        queue->headCache = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+        if(tail == queue->headCache){
+            return NULL;
+        }
+    }
+
+    return spsc_slot(queue, tail);
+}
+
+
+void spsc_commit_read(spsc_queue_t *queue){
+
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+}
+
+
+void *spsc_wait_slot(spsc_queue_t *queue, uint64_t pollNs){
+
+    struct timespec poll    = {.tv_sec = pollNs / 1000000000, .tv_nsec = pollNs % 1000000000};
+    void*           slot    = NULL;
+    bool            closed  = false;
+
+    while(true){
+        // closed is loaded first, a slot committed before closing is still seen below
+        closed  = atomic_load_explicit(&queue->closed, memory_order_acquire);
+        slot    = spsc_read_slot(queue);
+
+        if((slot != NULL) || closed){
+            return slot;
+        }
+
+        nanosleep(&poll, NULL);
+    }
+}
+
+
+uint32_t spsc_count(spsc_queue_t *queue){
+    return atomic_load_explicit(&queue->head, memory_order_acquire) - atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
+
+
+void spsc_close(spsc_queue_t *queue){
+    atomic_store_explicit(&queue->closed, true, memory_order_release);
+}
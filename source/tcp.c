@@ -7,6 +7,8 @@
  * 
  */
 
+#define _GNU_SOURCE     ///< needed for IOV_MAX
+
 ///\cond
 #include <stdio.h>
 #include <stdint.h>
@@ -14,21 +16,107 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
+#include <errno.h>
+#include <limits.h>
 
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 ///\endcond
 
 #include <ringbuffer.h>
 #include <macros_kx132.h>
+#include <utility.h>
+#include <tcp.h>
 
 #define PORT    60000
 #define SA      struct sockaddr
 
+#define TCP_IOV_PER_SAMPLE  (2 + NUMBER_OF_AXES)                    ///< sensor id, every axis, timestamp
+#define TCP_IOV_SAMPLES     (IOV_MAX / TCP_IOV_PER_SAMPLE)          ///< samples gathered by one writev()
+
 static int sockfd, connfd;
 
+static pthread_mutex_t sendMutex = PTHREAD_MUTEX_INITIALIZER;  ///< threads of all sensors share one connection
+
+
+/**
+ * @brief Writes sensor id, axes-data and timestamp of one sample, caller holds sendMutex.
+ * 
+ * @param sensorId          id of sensor the sample was read from
+ * @param xyzFormatted      pointer to array holding signed 16-Bit axis values
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
+ */
+static void tcp_write_sample(uint8_t sensorId, int16_t* xyzFormatted, uint64_t timestamp);
+
+
+/**
+ * @brief Writes sensor id, 8-Bit axes-data and timestamp of one sample, caller holds sendMutex.
+ * 
+ * @param sensorId          id of sensor the sample was read from
+ * @param xyzCompact        pointer to array holding signed 8-Bit axis values
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
+ */
+static void tcp_write_sample_8(uint8_t sensorId, int8_t* xyzCompact, uint64_t timestamp);
+
+
+/**
+ * @brief Writes sensor id, axes-data in physical units and timestamp of one sample, caller holds sendMutex.
+ * 
+ * @param sensorId          id of sensor the sample was read from
+ * @param xyzUnit           pointer to array holding float axis values (g or m/s²)
+ * @param timestamp         timestamp of sample in nanoseconds (CLOCK_MONOTONIC)
+ */
+static void tcp_write_sample_float(uint8_t sensorId, float* xyzUnit, uint64_t timestamp);
+
+
+/**
+ * @brief Writes header of a trigger buffer, caller holds sendMutex.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param triggerInfo       pointer to struct holding info about number of samples, trigger index and output data rate
+ * @param normalizedData    pointer to array holding normalized axes data, already in scale and type of samples
+ * @param valueSize         size of one normalized value, int16_t or float
+ */
+static void tcp_write_trig_header(uint8_t sensorId, trigger_info_t *triggerInfo, const void *normalizedData, size_t valueSize);
+
+
+/**
+ * @brief Writes the samples of a trigger buffer straight from the arrays of the axes, caller holds sendMutex.
+ * 
+ *  Every value is gathered by writev() where it is, TCP_IOV_SAMPLES samples per call, same bytes as tcp_write_sample() per sample.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param xyzValues         pointer to 3 arrays of axis values
+ * @param timestamps        pointer to array holding timestamp of every sample in nanoseconds
+ * @param numberOfSamples   number of samples
+ * @param valueSize         size of one axis value, int16_t, int8_t or float
+ */
+static void tcp_write_trig_samples(uint8_t *sensorId, void **xyzValues, uint64_t *timestamps, uint32_t numberOfSamples, size_t valueSize);
+
+
+/**
+ * @brief Writes the samples of a view of a compressed ring, one block is decoded at a time, caller holds sendMutex.
+ * 
+ * @param sensorId          id of sensor the buffer was read from
+ * @param pack              pointer to compressed ring, 16-Bit or 8-Bit values
+ * @param packView          pointer to view
+ * @param scale             unit per count in 16-Bit scale, 0 writes the counts
+ */
+static void tcp_write_trig_packed(uint8_t *sensorId, rb_pack_t *pack, rb_pack_view_t *packView, float scale);
+
+
+/**
+ * @brief Writes all bytes of an io vector, continues after partial writes, caller holds sendMutex.
+ * 
+ * @param iov               pointer to io vector, modified
+ * @param iovcnt            number of entries
+ */
+static void tcp_writev_all(struct iovec *iov, int iovcnt);
+
 
 
 bool tcp_server_init(void){
@@ -103,30 +191,282 @@ void tcp_server_close(void){
 }
 
 
-void tcp_send(int16_t* xyzFormatted){
+void tcp_send(uint8_t sensorId, int16_t* xyzFormatted, uint64_t timestamp){
+    pthread_mutex_lock(&sendMutex);
+    tcp_write_sample(sensorId, xyzFormatted, timestamp);
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+static void tcp_write_sample(uint8_t sensorId, int16_t* xyzFormatted, uint64_t timestamp){
+    write(connfd, &sensorId,              sizeof(uint8_t));
     write(connfd, &xyzFormatted[X_INDEX], sizeof(int16_t));
     write(connfd, &xyzFormatted[Y_INDEX], sizeof(int16_t));
     write(connfd, &xyzFormatted[Z_INDEX], sizeof(int16_t));
+    write(connfd, &timestamp,             sizeof(uint64_t));
 }
 
 
-void tcp_send_trig_buffer(int16_t **xyzFormatted, trigger_info_t *triggerInfo, int16_t *normalizedData){
+void tcp_send_trig_buffer(uint8_t sensorId, int16_t **xyzFormatted, uint64_t *timestamps, trigger_info_t *triggerInfo, int16_t *normalizedData){
+
+    void*       xyzValues       [NUMBER_OF_AXES]    = {xyzFormatted[X_INDEX], xyzFormatted[Y_INDEX], xyzFormatted[Z_INDEX]};
+
+    pthread_mutex_lock(&sendMutex);
+
+    tcp_write_trig_header(sensorId, triggerInfo, normalizedData, sizeof(int16_t));
+    tcp_write_trig_samples(&sensorId, xyzValues, timestamps, triggerInfo->numberOfSamples, sizeof(int16_t));
+
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+void tcp_send_8(uint8_t sensorId, int8_t* xyzCompact, uint64_t timestamp){
+    pthread_mutex_lock(&sendMutex);
+    tcp_write_sample_8(sensorId, xyzCompact, timestamp);
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+static void tcp_write_sample_8(uint8_t sensorId, int8_t* xyzCompact, uint64_t timestamp){
+    write(connfd, &sensorId,            sizeof(uint8_t));
+    write(connfd, xyzCompact,           NUMBER_OF_AXES * sizeof(int8_t));
+    write(connfd, &timestamp,           sizeof(uint64_t));
+}
+
+
+static void tcp_write_trig_header(uint8_t sensorId, trigger_info_t *triggerInfo, const void *normalizedData, size_t valueSize){
 
-    int16_t     tcpData         [NUMBER_OF_AXES];
     uint32_t    size            = triggerInfo->numberOfSamples;
     uint32_t    triggerIndex    = triggerInfo->numberOfSamples - triggerInfo->samplesAfterTrig;
+    uint32_t    rateMilliHz     = (uint32_t) (triggerInfo->sampleRateHz * 1000);
+
+    write(connfd, &sensorId,                sizeof(uint8_t));
+    write(connfd, normalizedData,           NUMBER_OF_AXES * valueSize);
+    write(connfd, &size,                    sizeof(uint32_t));
+    write(connfd, &triggerIndex,            sizeof(uint32_t));
+    write(connfd, &rateMilliHz,             sizeof(uint32_t));
+}
+
+
+void tcp_send_trig_buffer_8(uint8_t sensorId, int8_t **xyzCompact, uint64_t *timestamps, trigger_info_t *triggerInfo, int16_t *normalizedData){
+
+    void*       xyzValues       [NUMBER_OF_AXES]    = {xyzCompact[X_INDEX], xyzCompact[Y_INDEX], xyzCompact[Z_INDEX]};
+    int16_t     normalized8     [NUMBER_OF_AXES];
+
+    // GUI compares normalized data with the samples, so it's sent in the same scale
+    normalized8[X_AXIS] = normalizedData[X_INDEX] >> 8;
+    normalized8[Y_AXIS] = normalizedData[Y_INDEX] >> 8;
+    normalized8[Z_AXIS] = normalizedData[Z_INDEX] >> 8;
+
+    pthread_mutex_lock(&sendMutex);
+
+    tcp_write_trig_header(sensorId, triggerInfo, normalized8, sizeof(int16_t));
+    tcp_write_trig_samples(&sensorId, xyzValues, timestamps, triggerInfo->numberOfSamples, sizeof(int8_t));
+
+    pthread_mutex_unlock(&sendMutex);
+}
+
 
-    tcp_send(normalizedData);
-    write(connfd, &size,         sizeof(uint32_t));
-    write(connfd, &triggerIndex, sizeof(uint32_t));
-    
-    for(uint32_t i = 0; i < triggerInfo->numberOfSamples; i++){
-        tcpData[X_AXIS] = xyzFormatted[X_INDEX][i];
-        tcpData[Y_AXIS] = xyzFormatted[Y_INDEX][i];
-        tcpData[Z_AXIS] = xyzFormatted[Z_INDEX][i];
+void tcp_send_float(uint8_t sensorId, float* xyzUnit, uint64_t timestamp){
+    pthread_mutex_lock(&sendMutex);
+    tcp_write_sample_float(sensorId, xyzUnit, timestamp);
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+static void tcp_write_sample_float(uint8_t sensorId, float* xyzUnit, uint64_t timestamp){
+    write(connfd, &sensorId,            sizeof(uint8_t));
+    write(connfd, xyzUnit,              NUMBER_OF_AXES * sizeof(float));
+    write(connfd, &timestamp,           sizeof(uint64_t));
+}
+
+
+void tcp_send_trig_buffer_float(uint8_t sensorId, float **xyzUnit, uint64_t *timestamps, trigger_info_t *triggerInfo, float *normalizedData){
+
+    void*       xyzValues       [NUMBER_OF_AXES]    = {xyzUnit[X_INDEX], xyzUnit[Y_INDEX], xyzUnit[Z_INDEX]};
+
+    pthread_mutex_lock(&sendMutex);
+
+    tcp_write_trig_header(sensorId, triggerInfo, normalizedData, sizeof(float));
+    tcp_write_trig_samples(&sensorId, xyzValues, timestamps, triggerInfo->numberOfSamples, sizeof(float));
+
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+void tcp_send_trig_view(uint8_t sensorId, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, rb_pack_t *pack, rb_pack_view_t *packView, trigger_info_t *triggerInfo, int16_t *normalizedData){
+
+    rb_span_t   span;
+    uint32_t    offset          = 0;
+    int16_t     normalized      [NUMBER_OF_AXES];
+
+    // GUI compares normalized data with the samples, so it's sent in the same scale
+    for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+        normalized[axis] = (rb->valueSize == sizeof(int8_t)) ? normalizedData[axis] >> 8 : normalizedData[axis];
+    }
+
+    pthread_mutex_lock(&sendMutex);
+
+    tcp_write_trig_header(sensorId, triggerInfo, normalized, sizeof(int16_t));
+
+    if(pack != NULL){
+        tcp_write_trig_packed(&sensorId, pack, packView, 0);
+    }
+
+    while(rb_view_span(rb, rbTs, view, offset, &span) > 0){
+        tcp_write_trig_samples(&sensorId, span.xyz, span.timestamps, span.numberOfSamples, rb->valueSize);
+        offset += span.numberOfSamples;
+    }
+
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+void tcp_send_trig_view_float(uint8_t sensorId, ringbuffer_xyz_t *rb, ringbuffer_ts_t *rbTs, rb_view_t *view, rb_pack_t *pack, rb_pack_view_t *packView, float scale, trigger_info_t *triggerInfo, float *normalizedData){
+
+    rb_span_t   span;
+    uint32_t    offset          = 0;
+    uint32_t    chunk           = 0;
+    float       xyzChunk        [NUMBER_OF_AXES][TCP_IOV_SAMPLES];
+    void*       xyzValues       [NUMBER_OF_AXES] = {xyzChunk[X_INDEX], xyzChunk[Y_INDEX], xyzChunk[Z_INDEX]};
+
+    pthread_mutex_lock(&sendMutex);
+
+    tcp_write_trig_header(sensorId, triggerInfo, normalizedData, sizeof(float));
+
+    if(pack != NULL){
+        tcp_write_trig_packed(&sensorId, pack, packView, scale);
+    }
+
+    // one writev() worth of samples is converted at a time, the window is never held as floats
+    while(rb_view_span(rb, rbTs, view, offset, &span) > 0){
+        chunk = (span.numberOfSamples < TCP_IOV_SAMPLES) ? span.numberOfSamples : TCP_IOV_SAMPLES;
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            if(rb->valueSize == sizeof(int8_t)){
+                convertCounts8ToUnit((const int8_t*) span.xyz[axis], chunk, scale * 256, xyzChunk[axis]);
+            }
+            else{
+                convertCountsToUnit((const int16_t*) span.xyz[axis], chunk, scale, xyzChunk[axis]);
+            }
+        }
 
-        tcp_send(tcpData);
+        tcp_write_trig_samples(&sensorId, xyzValues, span.timestamps, chunk, sizeof(float));
+        offset += chunk;
     }
+
+    pthread_mutex_unlock(&sendMutex);
+}
+
+
+static void tcp_write_trig_samples(uint8_t *sensorId, void **xyzValues, uint64_t *timestamps, uint32_t numberOfSamples, size_t valueSize){
+
+    struct iovec    iov     [TCP_IOV_SAMPLES * TCP_IOV_PER_SAMPLE];
+    int             iovcnt  = 0;
+
+    for(uint32_t i = 0; i < numberOfSamples; i++){
+
+        iov[iovcnt].iov_base    = sensorId;
+        iov[iovcnt].iov_len     = sizeof(uint8_t);
+        iovcnt++;
+
+        for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+            iov[iovcnt].iov_base    = (uint8_t*) xyzValues[axis] + i * valueSize;
+            iov[iovcnt].iov_len     = valueSize;
+            iovcnt++;
+        }
+
+        iov[iovcnt].iov_base    = &timestamps[i];
+        iov[iovcnt].iov_len     = sizeof(uint64_t);
+        iovcnt++;
+
+        if((iovcnt == TCP_IOV_SAMPLES * TCP_IOV_PER_SAMPLE) || (i == numberOfSamples - 1)){
+            tcp_writev_all(iov, iovcnt);
+            iovcnt = 0;
+        }
+    }
+}
+
+
+static void tcp_write_trig_packed(uint8_t *sensorId, rb_pack_t *pack, rb_pack_view_t *packView, float scale){
+
+    int16_t     xyzBlock        [NUMBER_OF_AXES][RB_PACK_BLOCK_SAMPLES];   ///< also holds 8-Bit values
+    float       xyzChunk        [NUMBER_OF_AXES][RB_PACK_BLOCK_SAMPLES];
+    uint64_t    timestamps      [RB_PACK_BLOCK_SAMPLES];
+    void*       xyzDecoded      [NUMBER_OF_AXES] = {xyzBlock[X_INDEX], xyzBlock[Y_INDEX], xyzBlock[Z_INDEX]};
+    void*       xyzValues       [NUMBER_OF_AXES] = {xyzChunk[X_INDEX], xyzChunk[Y_INDEX], xyzChunk[Z_INDEX]};
+    uint32_t    offset          = 0;
+    uint32_t    chunk           = 0;
+
+    // chunks end at block borders, so every block is decoded once
+    while(offset < packView->numberOfSamples){
+        chunk = rb_pack_read(pack, packView, offset, RB_PACK_BLOCK_SAMPLES - ((packView->firstSample + offset) & (RB_PACK_BLOCK_SAMPLES - 1)), xyzDecoded, timestamps);
+
+        if(scale == 0){
+            tcp_write_trig_samples(sensorId, xyzDecoded, timestamps, chunk, pack->valueSize);
+        }
+        else{
+            for(axis_t axis = 0; axis < NUMBER_OF_AXES; axis++){
+                if(pack->valueSize == sizeof(int8_t)){
+                    convertCounts8ToUnit((const int8_t*) xyzBlock[axis], chunk, scale * 256, xyzChunk[axis]);
+                }
+                else{
+                    convertCountsToUnit(xyzBlock[axis], chunk, scale, xyzChunk[axis]);
+                }
+            }
+            tcp_write_trig_samples(sensorId, xyzValues, timestamps, chunk, sizeof(float));
+        }
+
+        offset += chunk;
+    }
+}
+
+
+static void tcp_writev_all(struct iovec *iov, int iovcnt){
+
+    ssize_t written = 0;
+
+    while(iovcnt > 0){
+        written = writev(connfd, iov, iovcnt);
+
+        if(written < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return;
+        }
+
+        // skips the entries written completely, the first one left may be written partly
+        while((iovcnt > 0) && ((size_t) written >= iov->iov_len)){
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        if(iovcnt > 0){
+            iov->iov_base   = (uint8_t*) iov->iov_base + written;
+            iov->iov_len   -= written;
+        }
+    }
+}
+
+
+void tcp_send_envelopes(uint8_t sensorId, uint8_t level, rb_envelope_t *envelopes, uint32_t numberOfEntries, float scale){
+
+    uint8_t     id                  = sensorId | TCP_ENVELOPE_FLAG;
+    uint32_t    samplesPerEnvelope  = 1 << (RB_PYRAMID_SHIFT * (level + 1));
+    struct iovec iov[]              = {
+        {.iov_base = &id,                   .iov_len = sizeof(uint8_t)},
+        {.iov_base = &level,                .iov_len = sizeof(uint8_t)},
+        {.iov_base = &samplesPerEnvelope,   .iov_len = sizeof(uint32_t)},
+        {.iov_base = &numberOfEntries,      .iov_len = sizeof(uint32_t)},
+        {.iov_base = &scale,                .iov_len = sizeof(float)},
+        {.iov_base = envelopes,             .iov_len = numberOfEntries * sizeof(rb_envelope_t)},
+    };
+
+    pthread_mutex_lock(&sendMutex);
+    tcp_writev_all(iov, sizeof(iov) / sizeof(iov[0]));
+    pthread_mutex_unlock(&sendMutex);
 }
 
 
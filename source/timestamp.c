@@ -0,0 +1,140 @@
+/**
+ * @file timestamp.c
+ * @author awa
+ * @date 17-10-2026
+ * 
+ * @brief Contains functions for timestamping samples and estimating the real output data rate.
+ * 
+ *  The oscillator of the KX132 is not exact, the real output data rate differs from the configured
+ *  one by up to a few percent and drifts with temperature. Reads are timestamped with CLOCK_MONOTONIC,
+ *  a second order delay-locked loop tracks the time of the newest sample and the sample period.
+ *  Samples read in one block (sample buffer) get timestamps spaced by the estimated period.
+ * 
+ */
+
+///\cond
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+///\endcond
+
+#include <timestamp.h>
+
+
+#define NSEC_PER_SEC            1000000000
+#define TS_MAX_OMEGA            0.5         ///< keeps the loop stable for long blocks / low output data rates
+
+
+uint64_t ts_now_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+
+void ts_init(ts_estimator_t *estimator, double nominalRateHz, double bandwidthHz){
+    estimator->nominalPeriodNs  = NSEC_PER_SEC / nominalRateHz;
+    estimator->periodNs         = estimator->nominalPeriodNs;
+    estimator->lastSampleNs     = 0;
+    estimator->bandwidthHz      = bandwidthHz;
+    estimator->samples          = 0;
+    estimator->updates          = 0;
+    estimator->resyncs          = 0;
+    estimator->started          = false;
+}
+
+
+void ts_restart(ts_estimator_t *estimator){
+    estimator->started = false;
+}
+
+
+void ts_update(ts_estimator_t *estimator, uint64_t readTimeNs, uint16_t numberOfSamples, uint32_t missingSamples, uint64_t *timestamps){
+
+    double      predictedNs     = 0;
+    double      errorNs         = 0;
+    double      omega           = 0;
+    uint32_t    advancedSamples = numberOfSamples + missingSamples;
+
+    if(numberOfSamples == 0){
+        return;
+    }
+
+    predictedNs = estimator->lastSampleNs + advancedSamples * estimator->periodNs;
+    errorNs     = (double) readTimeNs - predictedNs;
+
+    if(!estimator->started){
+        estimator->lastSampleNs = readTimeNs;
+        estimator->started      = true;
+    }
+    // lost samples or a stalled loop, the old phase is useless
+    else if(fabs(errorNs) > TS_RESYNC_PERIODS * estimator->nominalPeriodNs){
+        estimator->lastSampleNs = readTimeNs;
+        estimator->updates      = 0;
+        estimator->resyncs++;
+    }
+    else{
+        // loop coefficients depend on time between updates, blocks may have different sizes
+        omega = 2 * M_PI * estimator->bandwidthHz * advancedSamples * estimator->nominalPeriodNs / NSEC_PER_SEC;
+        if(omega > TS_MAX_OMEGA){
+            omega = TS_MAX_OMEGA;
+        }
+
+        estimator->lastSampleNs = predictedNs + M_SQRT2 * omega * errorNs;
+        estimator->periodNs    += omega * omega * errorNs / advancedSamples;
+        estimator->updates++;
+    }
+
+    if(timestamps != NULL){
+        for(uint16_t i = 0; i < numberOfSamples; i++){
+            timestamps[i] = (uint64_t) (estimator->lastSampleNs - (numberOfSamples - 1 - i) * estimator->periodNs);
+        }
+    }
+
+    estimator->samples += numberOfSamples;
+}
+
+
+uint32_t ts_missing_samples(ts_estimator_t *estimator, uint64_t readTimeNs, uint16_t numberOfSamples){
+
+    double samplesSinceLast = 0;
+
+    if(!estimator->started){
+        return 0;
+    }
+
+    // the newest sample is read up to one period after it was produced, rounding would count a late read as a lost sample
+    samplesSinceLast = floor(((double) readTimeNs - estimator->lastSampleNs) / estimator->periodNs);
+
+    if(samplesSinceLast <= numberOfSamples){
+        return 0;
+    }
+
+    return (uint32_t) samplesSinceLast - numberOfSamples;
+}
+
+
+double ts_rate_hz(ts_estimator_t *estimator){
+    return NSEC_PER_SEC / estimator->periodNs;
+}
+
+
+bool ts_locked(ts_estimator_t *estimator){
+    return estimator->started && (estimator->updates >= TS_LOCK_UPDATES);
+}
+
+
+void ts_print(ts_estimator_t *estimator){
+
+    double nominalRateHz    = NSEC_PER_SEC / estimator->nominalPeriodNs;
+    double rateHz           = ts_rate_hz(estimator);
+
+    printf("[timestamp] Output data rate: %.3f Hz measured, %.3f Hz nominal (%+.0f ppm), %s, %u re-anchored\n",
+            rateHz,
+            nominalRateHz,
+            (rateHz / nominalRateHz - 1.0) * 1e6,
+            ts_locked(estimator) ? "locked" : "settling",
+            estimator->resyncs);
+}
\ No newline at end of file
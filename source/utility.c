@@ -5,17 +5,178 @@
  * 
  * @brief Contains function for converting raw data to signed 16-Bit
  * 
+ *  Blocks of samples are decoded and split into one array per axis by SIMD kernels, NEON on ARM,
+ *  SSSE3 / AVX2 on x86 (selected at runtime). Samples not filling a whole vector are decoded by the scalar loop.
+ *  Blocks of counts are scaled to physical units (float) by kernels of the same implementations.
+ * 
  */
 
 ///\cond
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DECODE_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define DECODE_NEON
+#include <arm_neon.h>
+#endif
 ///\endcond
 
 #include <utility.h>
 #include <macros_kx132.h>
 
 
+#define DECODE_VECTOR_BYTES     16      ///< one SSE / NEON register, AVX2 kernels use two lanes of it
+
+
+#ifdef DECODE_X86
+/// pshufb masks picking the bytes of one axis out of 3 consecutive vectors of 16-Bit samples (8 samples), -1 clears the byte
+static const int8_t deinterleaveMask16[NUMBER_OF_AXES][3][DECODE_VECTOR_BYTES] = {
+    {
+        {  0,   1,   6,   7,  12,  13,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,   2,   3,   8,   9,  14,  15,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   4,   5,  10,  11},
+    },
+    {
+        {  2,   3,   8,   9,  14,  15,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,   4,   5,  10,  11,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   0,   1,   6,   7,  12,  13},
+    },
+    {
+        {  4,   5,  10,  11,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,   0,   1,   6,   7,  12,  13,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   2,   3,   8,   9,  14,  15},
+    },
+};
+
+
+/// pshufb masks picking the bytes of one axis out of 3 consecutive vectors of 8-Bit samples (16 samples)
+static const int8_t deinterleaveMask8[NUMBER_OF_AXES][3][DECODE_VECTOR_BYTES] = {
+    {
+        {  0,   3,   6,   9,  12,  15,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,   2,   5,   8,  11,  14,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   1,   4,   7,  10,  13},
+    },
+    {
+        {  1,   4,   7,  10,  13,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,   0,   3,   6,   9,  12,  15,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   2,   5,   8,  11,  14},
+    },
+    {
+        {  2,   5,   8,  11,  14,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,   1,   4,   7,  10,  13,  -1,  -1,  -1,  -1,  -1,  -1},
+        { -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,   0,   3,   6,   9,  12,  15},
+    },
+};
+#endif //DECODE_X86
+
+
+static const char* decodeImplNames[NUMBER_OF_DECODE_IMPLS] = {"scalar", "neon", "ssse3", "avx2"};
+
+
+/**
+ * @brief Splits whole vectors of raw samples into one array per axis, all kernels share this signature.
+ * 
+ *  16-Bit samples are little endian in the raw data, so the low + high bytes of one axis are already an int16_t.
+ *  8-Bit kernels write int8_t arrays through the same pointers.
+ * 
+ * @param xyzRawData        pointer to raw samples
+ * @param numberOfSamples   number of samples in block
+ * @param xyzData           pointers to arrays of the axes
+ * @return uint32_t         number of samples decoded, the rest is left for the scalar loop
+ */
+typedef uint32_t (*decode_kernel_t)(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Decodes 16-Bit samples with NEON, vld3 splits 8 samples into the axes in one instruction.
+ */
+static uint32_t decodeNeon16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Splits 8-Bit samples with NEON, 16 samples per vld3.
+ */
+static uint32_t decodeNeon8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Decodes 16-Bit samples with SSSE3, 8 samples per 3 loads and 9 byte shuffles.
+ */
+static uint32_t decodeSsse3_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Splits 8-Bit samples with SSSE3, 16 samples per 3 loads.
+ */
+static uint32_t decodeSsse3_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Decodes 16-Bit samples with AVX2, the SSSE3 shuffles run on 8 samples in each 128-Bit lane.
+ */
+static uint32_t decodeAvx2_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Splits 8-Bit samples with AVX2, 16 samples in each 128-Bit lane.
+ */
+static uint32_t decodeAvx2_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData);
+
+
+/**
+ * @brief Scales whole vectors of counts to physical units, all kernels share this signature.
+ * 
+ * @param counts            pointer to int16_t or int8_t counts
+ * @param numberOfValues    number of counts
+ * @param scale             unit per count
+ * @param values            pointer to array where scaled values should be saved
+ * @return uint32_t         number of values scaled, the rest is left for the scalar loop
+ */
+typedef uint32_t (*scale_kernel_t)(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 16-Bit counts with NEON, 8 per loop (widened to int32 in two halves).
+ */
+static uint32_t scaleNeon16(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 8-Bit counts with NEON, 16 per loop.
+ */
+static uint32_t scaleNeon8(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 16-Bit counts with SSE2 (part of the SSSE3 implementation), sign extended by unpack + shift.
+ */
+static uint32_t scaleSsse3_16(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 8-Bit counts with SSE2 (part of the SSSE3 implementation), 16 per loop.
+ */
+static uint32_t scaleSsse3_8(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 16-Bit counts with AVX2, 16 per loop.
+ */
+static uint32_t scaleAvx2_16(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
+/**
+ * @brief Scales 8-Bit counts with AVX2, 32 per loop.
+ */
+static uint32_t scaleAvx2_8(const void* counts, uint32_t numberOfValues, float scale, float* values);
+
+
 
 int16_t convertRaw(uint8_t lowVal, uint8_t highVal){
     return ((highVal & 0xFF) << 8) | lowVal;	//! why ( & 0xFF ) ????
@@ -30,6 +191,536 @@ void convertRawArray(uint8_t* xyzRawData, int16_t* data){
 }
 
 
+void convertRawArray8(uint8_t* xyzRawData, int16_t* data){
+    data[X_INDEX] = convertRaw(0, xyzRawData[X_INDEX]);
+    data[Y_INDEX] = convertRaw(0, xyzRawData[Y_INDEX]);
+    data[Z_INDEX] = convertRaw(0, xyzRawData[Z_INDEX]);
+    return;
+}
+
+
+void convertRawBlock(const uint8_t* xyzRawData, uint32_t numberOfSamples, int16_t* xData, int16_t* yData, int16_t* zData){
+    convertRawBlockImpl(decodeImplBest(), xyzRawData, numberOfSamples, xData, yData, zData);
+}
+
+
+void convertRawBlock8(const uint8_t* xyzRawData, uint32_t numberOfSamples, int8_t* xData, int8_t* yData, int8_t* zData){
+    convertRawBlock8Impl(decodeImplBest(), xyzRawData, numberOfSamples, xData, yData, zData);
+}
+
+
+bool decodeImplSupported(decode_impl_t impl){
+    switch (impl)
+    {
+        case decode_scalar:
+            return true;
+
+        #ifdef DECODE_NEON
+        case decode_neon:
+            return true;
+        #endif //DECODE_NEON
+
+        #ifdef DECODE_X86
+        case decode_ssse3:
+            return __builtin_cpu_supports("ssse3");
+
+        case decode_avx2:
+            return __builtin_cpu_supports("avx2");
+        #endif //DECODE_X86
+
+        default:
+            return false;
+    }
+}
+
+
+const char* decodeImplName(decode_impl_t impl){
+    return (impl < NUMBER_OF_DECODE_IMPLS) ? decodeImplNames[impl] : "unknown";
+}
+
+
+decode_impl_t decodeImplBest(void){
+    for(decode_impl_t impl = NUMBER_OF_DECODE_IMPLS - 1; impl > decode_scalar; impl--){
+        if(decodeImplSupported(impl)){
+            return impl;
+        }
+    }
+    return decode_scalar;
+}
+
+
+void convertRawBlockImpl(decode_impl_t impl, const uint8_t* xyzRawData, uint32_t numberOfSamples, int16_t* xData, int16_t* yData, int16_t* zData){
+
+    void*           xyzData [NUMBER_OF_AXES]    = {xData, yData, zData};
+    decode_kernel_t kernel                      = NULL;
+    const uint8_t*  sample                      = NULL;
+    uint32_t        i                           = 0;
+
+    switch (impl)
+    {
+        case decode_neon:   kernel = decodeNeon16;      break;
+        case decode_ssse3:  kernel = decodeSsse3_16;    break;
+        case decode_avx2:   kernel = decodeAvx2_16;     break;
+        default:                                        break;
+    }
+
+    if((kernel != NULL) && decodeImplSupported(impl)){
+        i = kernel(xyzRawData, numberOfSamples, xyzData);
+    }
+
+    sample = &xyzRawData[i * NUMBER_OF_CHANNELS];
+
+    for(; i < numberOfSamples; i++){
+        xData[i] = (int16_t) (sample[X_LOW_CHANNEL] | (sample[X_HIGH_CHANNEL] << 8));
+        yData[i] = (int16_t) (sample[Y_LOW_CHANNEL] | (sample[Y_HIGH_CHANNEL] << 8));
+        zData[i] = (int16_t) (sample[Z_LOW_CHANNEL] | (sample[Z_HIGH_CHANNEL] << 8));
+
+        sample += NUMBER_OF_CHANNELS;
+    }
+}
+
+
+void convertRawBlock8Impl(decode_impl_t impl, const uint8_t* xyzRawData, uint32_t numberOfSamples, int8_t* xData, int8_t* yData, int8_t* zData){
+
+    void*           xyzData [NUMBER_OF_AXES]    = {xData, yData, zData};
+    decode_kernel_t kernel                      = NULL;
+    const uint8_t*  sample                      = NULL;
+    uint32_t        i                           = 0;
+
+    switch (impl)
+    {
+        case decode_neon:   kernel = decodeNeon8;       break;
+        case decode_ssse3:  kernel = decodeSsse3_8;     break;
+        case decode_avx2:   kernel = decodeAvx2_8;      break;
+        default:                                        break;
+    }
+
+    if((kernel != NULL) && decodeImplSupported(impl)){
+        i = kernel(xyzRawData, numberOfSamples, xyzData);
+    }
+
+    sample = &xyzRawData[i * NUMBER_OF_CHANNELS_8BIT];
+
+    for(; i < numberOfSamples; i++){
+        xData[i] = (int8_t) sample[X_INDEX];
+        yData[i] = (int8_t) sample[Y_INDEX];
+        zData[i] = (int8_t) sample[Z_INDEX];
+
+        sample += NUMBER_OF_CHANNELS_8BIT;
+    }
+}
+
+
+void convertCountsToUnit(const int16_t* counts, uint32_t numberOfValues, float scale, float* values){
+    convertCountsToUnitImpl(decodeImplBest(), counts, numberOfValues, scale, values);
+}
+
+
+void convertCounts8ToUnit(const int8_t* counts, uint32_t numberOfValues, float scale, float* values){
+    convertCounts8ToUnitImpl(decodeImplBest(), counts, numberOfValues, scale, values);
+}
+
+
+void convertCountsToUnitImpl(decode_impl_t impl, const int16_t* counts, uint32_t numberOfValues, float scale, float* values){
+
+    scale_kernel_t  kernel  = NULL;
+    uint32_t        i       = 0;
+
+    switch (impl)
+    {
+        case decode_neon:   kernel = scaleNeon16;       break;
+        case decode_ssse3:  kernel = scaleSsse3_16;     break;
+        case decode_avx2:   kernel = scaleAvx2_16;      break;
+        default:                                        break;
+    }
+
+    if((kernel != NULL) && decodeImplSupported(impl)){
+        i = kernel(counts, numberOfValues, scale, values);
+    }
+
+    for(; i < numberOfValues; i++){
+        values[i] = counts[i] * scale;
+    }
+}
+
+
+void convertCounts8ToUnitImpl(decode_impl_t impl, const int8_t* counts, uint32_t numberOfValues, float scale, float* values){
+
+    scale_kernel_t  kernel  = NULL;
+    uint32_t        i       = 0;
+
+    switch (impl)
+    {
+        case decode_neon:   kernel = scaleNeon8;        break;
+        case decode_ssse3:  kernel = scaleSsse3_8;      break;
+        case decode_avx2:   kernel = scaleAvx2_8;       break;
+        default:                                        break;
+    }
+
+    if((kernel != NULL) && decodeImplSupported(impl)){
+        i = kernel(counts, numberOfValues, scale, values);
+    }
+
+    for(; i < numberOfValues; i++){
+        values[i] = counts[i] * scale;
+    }
+}
+
+
+//-------------------------------------------------------------------
+//--- NEON Kernels  -------------------------------------------------
+//-------------------------------------------------------------------
+
+#ifdef DECODE_NEON
+static uint32_t decodeNeon16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    uint32_t i = 0;
+
+    for(; i + 8 <= numberOfSamples; i += 8){
+        int16x8x3_t xyz = vld3q_s16((const int16_t*) &xyzRawData[i * NUMBER_OF_CHANNELS]);
+
+        vst1q_s16(&((int16_t*) xyzData[X_INDEX])[i], xyz.val[X_INDEX]);
+        vst1q_s16(&((int16_t*) xyzData[Y_INDEX])[i], xyz.val[Y_INDEX]);
+        vst1q_s16(&((int16_t*) xyzData[Z_INDEX])[i], xyz.val[Z_INDEX]);
+    }
+
+    return i;
+}
+
+
+static uint32_t decodeNeon8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    uint32_t i = 0;
+
+    for(; i + 16 <= numberOfSamples; i += 16){
+        int8x16x3_t xyz = vld3q_s8((const int8_t*) &xyzRawData[i * NUMBER_OF_CHANNELS_8BIT]);
+
+        vst1q_s8(&((int8_t*) xyzData[X_INDEX])[i], xyz.val[X_INDEX]);
+        vst1q_s8(&((int8_t*) xyzData[Y_INDEX])[i], xyz.val[Y_INDEX]);
+        vst1q_s8(&((int8_t*) xyzData[Z_INDEX])[i], xyz.val[Z_INDEX]);
+    }
+
+    return i;
+}
+
+
+static uint32_t scaleNeon16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int16_t*  counts16    = (const int16_t*) counts;
+    int16x8_t       count       ;
+    uint32_t        i           = 0;
+
+    for(; i + 8 <= numberOfValues; i += 8){
+        count = vld1q_s16(&counts16[i]);
+
+        vst1q_f32(&values[i],     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(count))),  scale));
+        vst1q_f32(&values[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(count))), scale));
+    }
+
+    return i;
+}
+
+
+static uint32_t scaleNeon8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int8_t*   counts8     = (const int8_t*) counts;
+    int16x8_t       count       [2];
+    uint32_t        i           = 0;
+
+    for(; i + 16 <= numberOfValues; i += 16){
+        int8x16_t count8 = vld1q_s8(&counts8[i]);
+
+        count[0] = vmovl_s8(vget_low_s8(count8));
+        count[1] = vmovl_s8(vget_high_s8(count8));
+
+        for(uint8_t half = 0; half < 2; half++){
+            vst1q_f32(&values[i + 8 * half],     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(count[half]))),  scale));
+            vst1q_f32(&values[i + 8 * half + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(count[half]))), scale));
+        }
+    }
+
+    return i;
+}
+#else
+static uint32_t decodeNeon16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t decodeNeon8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t scaleNeon16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+
+
+static uint32_t scaleNeon8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+#endif //DECODE_NEON
+
+
+//-------------------------------------------------------------------
+//--- SSSE3 / AVX2 Kernels  -----------------------------------------
+//-------------------------------------------------------------------
+
+#ifdef DECODE_X86
+__attribute__((target("ssse3")))
+static uint32_t decodeSsse3_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    __m128i     mask    [NUMBER_OF_AXES][3];
+    __m128i     raw     [3];
+    __m128i     axis    ;
+    uint32_t    i       = 0;
+
+    for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+        for(uint8_t v = 0; v < 3; v++){
+            mask[a][v] = _mm_loadu_si128((const __m128i*) deinterleaveMask16[a][v]);
+        }
+    }
+
+    for(; i + 8 <= numberOfSamples; i += 8){
+        for(uint8_t v = 0; v < 3; v++){
+            raw[v] = _mm_loadu_si128((const __m128i*) &xyzRawData[i * NUMBER_OF_CHANNELS + v * DECODE_VECTOR_BYTES]);
+        }
+
+        for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+            axis = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(raw[0], mask[a][0]),
+                                             _mm_shuffle_epi8(raw[1], mask[a][1])),
+                                             _mm_shuffle_epi8(raw[2], mask[a][2]));
+            _mm_storeu_si128((__m128i*) &((int16_t*) xyzData[a])[i], axis);
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("ssse3")))
+static uint32_t decodeSsse3_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    __m128i     mask    [NUMBER_OF_AXES][3];
+    __m128i     raw     [3];
+    __m128i     axis    ;
+    uint32_t    i       = 0;
+
+    for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+        for(uint8_t v = 0; v < 3; v++){
+            mask[a][v] = _mm_loadu_si128((const __m128i*) deinterleaveMask8[a][v]);
+        }
+    }
+
+    for(; i + 16 <= numberOfSamples; i += 16){
+        for(uint8_t v = 0; v < 3; v++){
+            raw[v] = _mm_loadu_si128((const __m128i*) &xyzRawData[i * NUMBER_OF_CHANNELS_8BIT + v * DECODE_VECTOR_BYTES]);
+        }
+
+        for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+            axis = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(raw[0], mask[a][0]),
+                                             _mm_shuffle_epi8(raw[1], mask[a][1])),
+                                             _mm_shuffle_epi8(raw[2], mask[a][2]));
+            _mm_storeu_si128((__m128i*) &((int8_t*) xyzData[a])[i], axis);
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static uint32_t decodeAvx2_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    __m256i         mask    [NUMBER_OF_AXES][3];
+    __m256i         raw     [3];
+    __m256i         axis    ;
+    const uint8_t*  block   = NULL;
+    uint32_t        i       = 0;
+
+    for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+        for(uint8_t v = 0; v < 3; v++){
+            mask[a][v] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) deinterleaveMask16[a][v]));
+        }
+    }
+
+    // lane 0 holds samples i - i+7, lane 1 samples i+8 - i+15, so both halves are stored in order
+    for(; i + 16 <= numberOfSamples; i += 16){
+        block = &xyzRawData[i * NUMBER_OF_CHANNELS];
+
+        for(uint8_t v = 0; v < 3; v++){
+            raw[v] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) &block[v * DECODE_VECTOR_BYTES])),
+                                             _mm_loadu_si128((const __m128i*) &block[8 * NUMBER_OF_CHANNELS + v * DECODE_VECTOR_BYTES]), 1);
+        }
+
+        for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+            axis = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(raw[0], mask[a][0]),
+                                                   _mm256_shuffle_epi8(raw[1], mask[a][1])),
+                                                   _mm256_shuffle_epi8(raw[2], mask[a][2]));
+            _mm256_storeu_si256((__m256i*) &((int16_t*) xyzData[a])[i], axis);
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static uint32_t decodeAvx2_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+
+    __m256i         mask    [NUMBER_OF_AXES][3];
+    __m256i         raw     [3];
+    __m256i         axis    ;
+    const uint8_t*  block   = NULL;
+    uint32_t        i       = 0;
+
+    for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+        for(uint8_t v = 0; v < 3; v++){
+            mask[a][v] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) deinterleaveMask8[a][v]));
+        }
+    }
+
+    for(; i + 32 <= numberOfSamples; i += 32){
+        block = &xyzRawData[i * NUMBER_OF_CHANNELS_8BIT];
+
+        for(uint8_t v = 0; v < 3; v++){
+            raw[v] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) &block[v * DECODE_VECTOR_BYTES])),
+                                             _mm_loadu_si128((const __m128i*) &block[16 * NUMBER_OF_CHANNELS_8BIT + v * DECODE_VECTOR_BYTES]), 1);
+        }
+
+        for(uint8_t a = 0; a < NUMBER_OF_AXES; a++){
+            axis = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(raw[0], mask[a][0]),
+                                                   _mm256_shuffle_epi8(raw[1], mask[a][1])),
+                                                   _mm256_shuffle_epi8(raw[2], mask[a][2]));
+            _mm256_storeu_si256((__m256i*) &((int8_t*) xyzData[a])[i], axis);
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("ssse3")))
+static uint32_t scaleSsse3_16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int16_t*  counts16    = (const int16_t*) counts;
+    __m128          scaleVector = _mm_set1_ps(scale);
+    __m128i         count       ;
+    uint32_t        i           = 0;
+
+    // interleaving a count with itself puts it into the high half of an int32, the arithmetic shift extends the sign
+    for(; i + 8 <= numberOfValues; i += 8){
+        count = _mm_loadu_si128((const __m128i*) &counts16[i]);
+
+        _mm_storeu_ps(&values[i],     _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(count, count), 16)), scaleVector));
+        _mm_storeu_ps(&values[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(count, count), 16)), scaleVector));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("ssse3")))
+static uint32_t scaleSsse3_8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int8_t*   counts8     = (const int8_t*) counts;
+    __m128          scaleVector = _mm_set1_ps(scale);
+    __m128i         count8      ;
+    __m128i         count       [2];
+    uint32_t        i           = 0;
+
+    for(; i + 16 <= numberOfValues; i += 16){
+        count8      = _mm_loadu_si128((const __m128i*) &counts8[i]);
+        count[0]    = _mm_srai_epi16(_mm_unpacklo_epi8(count8, count8), 8);
+        count[1]    = _mm_srai_epi16(_mm_unpackhi_epi8(count8, count8), 8);
+
+        for(uint8_t half = 0; half < 2; half++){
+            _mm_storeu_ps(&values[i + 8 * half],     _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(count[half], count[half]), 16)), scaleVector));
+            _mm_storeu_ps(&values[i + 8 * half + 4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(count[half], count[half]), 16)), scaleVector));
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static uint32_t scaleAvx2_16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int16_t*  counts16    = (const int16_t*) counts;
+    __m256          scaleVector = _mm256_set1_ps(scale);
+    uint32_t        i           = 0;
+
+    for(; i + 16 <= numberOfValues; i += 16){
+        for(uint8_t half = 0; half < 2; half++){
+            __m256i count = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) &counts16[i + 8 * half]));
+            _mm256_storeu_ps(&values[i + 8 * half], _mm256_mul_ps(_mm256_cvtepi32_ps(count), scaleVector));
+        }
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static uint32_t scaleAvx2_8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+
+    const int8_t*   counts8     = (const int8_t*) counts;
+    __m256          scaleVector = _mm256_set1_ps(scale);
+    uint32_t        i           = 0;
+
+    for(; i + 32 <= numberOfValues; i += 32){
+        for(uint8_t quarter = 0; quarter < 4; quarter++){
+            __m256i count = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*) &counts8[i + 8 * quarter]));
+            _mm256_storeu_ps(&values[i + 8 * quarter], _mm256_mul_ps(_mm256_cvtepi32_ps(count), scaleVector));
+        }
+    }
+
+    return i;
+}
+#else
+static uint32_t decodeSsse3_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t decodeSsse3_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t decodeAvx2_16(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t decodeAvx2_8(const uint8_t* xyzRawData, uint32_t numberOfSamples, void** xyzData){
+    return 0;
+}
+
+
+static uint32_t scaleSsse3_16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+
+
+static uint32_t scaleSsse3_8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+
+
+static uint32_t scaleAvx2_16(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+
+
+static uint32_t scaleAvx2_8(const void* counts, uint32_t numberOfValues, float scale, float* values){
+    return 0;
+}
+#endif //DECODE_X86
+
+
 
 void timer(void){
     //! #include <sys/time.h>